@@ -0,0 +1,71 @@
+#ifndef GEOMETRY_DELAUNAY_HPP
+#define GEOMETRY_DELAUNAY_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Vector.hpp"
+
+using Vec2 = Engine::Math::Vector<2>;
+
+// Delaunay triangulation of a point set, kept as flat half-edge arrays
+//
+// "S-hull: a fast radial sweep-hull routine for Delaunay triangulation" by
+//  David Sinclair (2010)
+//
+// Points are added by distance from the circumcenter of a seed triangle, each
+// one outside the hull built so far: it is joined to the hull edges it sees
+// and the new triangles are flipped until every circumcircle is empty. The
+// hull edge to start from is found through a hash of the angle around the
+// center. O(N log(N)), with exact predicates.
+//
+// Equal points are triangulated once, the copies hang off the first one by a
+// zero length edge. Without three points off a line there are no triangles
+// and the edges join the points in order along it.
+class Delaunay {
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  struct Edge {
+    uint32_t a;
+    uint32_t b;
+  };
+
+  explicit Delaunay(const std::vector<Vec2> &points);
+
+  // Three points per triangle, clockwise
+  const std::vector<uint32_t> &triangles() const;
+  // Half-edge i runs from triangles[i] to the next point of its triangle,
+  // halfedges[i] is the same edge in the opposite direction, NONE on the hull
+  const std::vector<uint32_t> &halfedges() const;
+
+  // Every edge once, with the line and copy edges
+  std::vector<Edge> edges() const;
+
+private:
+  uint32_t addTriangle(uint32_t i0, uint32_t i1, uint32_t i2, uint32_t a,
+                       uint32_t b, uint32_t c);
+  uint32_t legalize(const std::vector<Vec2> &points, uint32_t a);
+  void link(uint32_t a, uint32_t b);
+  uint32_t hashKey(const Vec2 &p) const;
+
+  std::vector<uint32_t> m_triangles;
+  std::vector<uint32_t> m_halfedges;
+
+  // Points in order along the line when there are no triangles
+  std::vector<uint32_t> m_line;
+  // Copies of an earlier point, and which one
+  std::vector<Edge> m_copies;
+
+  // Sweep state
+  double m_centerX = 0;
+  double m_centerY = 0;
+  std::vector<uint32_t> m_hullPrev;
+  std::vector<uint32_t> m_hullNext;
+  std::vector<uint32_t> m_hullTri;
+  std::vector<uint32_t> m_hullHash;
+  uint32_t m_hullStart = NONE;
+  std::vector<uint32_t> m_edgeStack;
+};
+
+#endif // GEOMETRY_DELAUNAY_HPP
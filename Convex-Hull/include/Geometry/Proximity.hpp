@@ -0,0 +1,51 @@
+#ifndef GEOMETRY_PROXIMITY_HPP
+#define GEOMETRY_PROXIMITY_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Geometry/Delaunay.hpp"
+
+// Proximity graphs of a point set, read off its Delaunay triangulation
+//
+// "Simple algorithms for enumerating interpoint distances and finding k
+//  nearest neighbors" by Matthew T. Dickerson, R. L. Scot Drysdale and
+//  Jörg-Rüdiger Sack (1992)
+//
+// - The nearest neighbour of a point is one of its Delaunay neighbours.
+// - Its i-th nearest is a Delaunay neighbour of it or of one of the i - 1
+//   before, so a best first search over the edges finds the k nearest in
+//   O(k log(k)) for bounded degrees.
+// - The Euclidean minimum spanning tree is a subgraph, Kruskal over the
+//   O(N) edges finds it.
+//
+// Building takes O(N log(N)), the triangulation and the adjacency lists.
+class ProximityGraph {
+public:
+  static constexpr uint32_t NONE = Delaunay::NONE;
+
+  using Edge = Delaunay::Edge;
+
+  // Keeps a reference to `points`
+  explicit ProximityGraph(const std::vector<Vec2> &points);
+
+  // Nearest other point of every point, NONE when alone. O(N)
+  std::vector<uint32_t> nearest() const;
+  // The k nearest other points of every point, nearest first, k per point
+  // padded with NONE. O(N k log(k)), in parallel
+  std::vector<uint32_t> nearest(uint32_t k) const;
+  // Edges of the Euclidean minimum spanning tree, N - 1 of them. O(N log(N))
+  std::vector<Edge> spanningTree() const;
+
+  double distance(uint32_t a, uint32_t b) const;
+
+private:
+  const std::vector<Vec2> &m_points;
+
+  // Delaunay neighbours of i, m_adjacency[m_offsets[i], m_offsets[i + 1])
+  std::vector<uint32_t> m_offsets;
+  std::vector<uint32_t> m_adjacency;
+  std::vector<Edge> m_edges;
+};
+
+#endif // GEOMETRY_PROXIMITY_HPP
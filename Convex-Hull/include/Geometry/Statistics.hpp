@@ -0,0 +1,60 @@
+#ifndef GEOMETRY_STATISTICS_HPP
+#define GEOMETRY_STATISTICS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Mean and variance of a stream in one pass, without the cancellation of
+// summing squares
+//
+// "Note on a method for calculating corrected sums of squares and products"
+//  by B. P. Welford (1962), merged as in "Updating formulae and a pairwise
+//  algorithm for computing sample variances" by Chan, Golub and LeVeque (1979)
+struct RunningStats {
+  uint64_t count = 0;
+  double mean = 0;
+  // Sum of squared differences from the mean
+  double m2 = 0;
+
+  void add(double x) {
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+  }
+
+  void merge(const RunningStats &other) {
+    if (other.count == 0)
+      return;
+
+    uint64_t total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+    count = total;
+  }
+
+  // Sample variance
+  double variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+  double deviation() const { return std::sqrt(variance()); }
+};
+
+// Median in O(N) with nth_element, reorders the values
+inline double Median(std::vector<double> &values) {
+  if (values.empty())
+    return 0;
+
+  size_t half = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + half, values.end());
+  double median = values[half];
+  if (values.size() % 2 == 0) {
+    median = (median + *std::max_element(values.begin(),
+                                         values.begin() + half)) /
+             2;
+  }
+  return median;
+}
+
+#endif // GEOMETRY_STATISTICS_HPP
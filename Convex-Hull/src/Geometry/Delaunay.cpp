@@ -0,0 +1,355 @@
+#include "Geometry/Delaunay.hpp"
+
+#include "Math/Predicates.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// Sign flipped from orient2d, positive when a, b, c turn clockwise
+double Orient(const Vec2 &a, const Vec2 &b, const Vec2 &c) {
+  return -Engine::Math::orient2d(a, b, c);
+}
+
+// Offset of the circumcenter of a, b, c from a
+void CircumOffset(const Vec2 &a, const Vec2 &b, const Vec2 &c, double &x,
+                  double &y) {
+  double dx = (double)b[0] - a[0];
+  double dy = (double)b[1] - a[1];
+  double ex = (double)c[0] - a[0];
+  double ey = (double)c[1] - a[1];
+  double bl = dx * dx + dy * dy;
+  double cl = ex * ex + ey * ey;
+  double d = 0.5 / (dx * ey - dy * ex);
+  x = (ey * bl - dy * cl) * d;
+  y = (dx * cl - ex * bl) * d;
+}
+
+double Distance2(const Vec2 &a, double x, double y) {
+  double dx = a[0] - x;
+  double dy = a[1] - y;
+  return dx * dx + dy * dy;
+}
+
+// Monotone in the angle of (dx, dy), in [0, 1)
+double PseudoAngle(double dx, double dy) {
+  double p = dx / (std::abs(dx) + std::abs(dy));
+  return (dy > 0 ? 3 - p : 1 + p) / 4;
+}
+
+} // namespace
+
+Delaunay::Delaunay(const std::vector<Vec2> &points) {
+  uint32_t n = (uint32_t)points.size();
+
+  // Copies first, the rest only sees distinct points
+  std::vector<uint32_t> ids(n);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+    const Vec2 &p = points[a], &q = points[b];
+    if (p[0] != q[0])
+      return p[0] < q[0];
+    if (p[1] != q[1])
+      return p[1] < q[1];
+    return a < b;
+  });
+
+  std::vector<uint32_t> unique;
+  unique.reserve(n);
+  for (uint32_t k = 0; k < n; k++) {
+    uint32_t i = ids[k];
+    if (!unique.empty() && points[unique.back()] == points[i]) {
+      m_copies.push_back({i, unique.back()});
+    } else {
+      unique.push_back(i);
+    }
+  }
+
+  if (unique.empty()) {
+    return;
+  }
+
+  double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+  for (uint32_t i : unique) {
+    minX = std::min(minX, (double)points[i][0]);
+    minY = std::min(minY, (double)points[i][1]);
+    maxX = std::max(maxX, (double)points[i][0]);
+    maxY = std::max(maxY, (double)points[i][1]);
+  }
+  double cx = (minX + maxX) / 2;
+  double cy = (minY + maxY) / 2;
+
+  // Seed triangle: the point nearest the center, its nearest point and the
+  // third one making the smallest circumcircle
+  uint32_t i0 = NONE, i1 = NONE, i2 = NONE;
+  double minDist = INFINITY;
+  for (uint32_t i : unique) {
+    double d = Distance2(points[i], cx, cy);
+    if (d < minDist) {
+      i0 = i;
+      minDist = d;
+    }
+  }
+
+  const Vec2 &p0 = points[i0];
+  minDist = INFINITY;
+  for (uint32_t i : unique) {
+    if (i == i0)
+      continue;
+    double d = Distance2(points[i], p0[0], p0[1]);
+    if (d < minDist) {
+      i1 = i;
+      minDist = d;
+    }
+  }
+
+  double minRadius = INFINITY;
+  if (i1 != NONE) {
+    const Vec2 &p1 = points[i1];
+    for (uint32_t i : unique) {
+      if (i == i0 || i == i1 || Orient(p0, p1, points[i]) == 0)
+        continue;
+      double x, y;
+      CircumOffset(p0, p1, points[i], x, y);
+      double r = x * x + y * y;
+      if (r < minRadius) {
+        i2 = i;
+        minRadius = r;
+      }
+    }
+  }
+
+  if (i2 == NONE) {
+    // On a line, ordered along it
+    double dx = i1 == NONE ? 1 : (double)points[i1][0] - p0[0];
+    double dy = i1 == NONE ? 0 : (double)points[i1][1] - p0[1];
+    std::vector<double> along(n);
+    for (uint32_t i : unique) {
+      along[i] = ((double)points[i][0] - p0[0]) * dx +
+                 ((double)points[i][1] - p0[1]) * dy;
+    }
+    m_line = unique;
+    std::sort(m_line.begin(), m_line.end(),
+              [&](uint32_t a, uint32_t b) { return along[a] < along[b]; });
+    return;
+  }
+
+  if (Orient(p0, points[i1], points[i2]) < 0) {
+    std::swap(i1, i2);
+  }
+
+  double ox, oy;
+  CircumOffset(p0, points[i1], points[i2], ox, oy);
+  m_centerX = p0[0] + ox;
+  m_centerY = p0[1] + oy;
+
+  std::vector<double> dists(n);
+  for (uint32_t i : unique) {
+    dists[i] = Distance2(points[i], m_centerX, m_centerY);
+  }
+  std::sort(unique.begin(), unique.end(),
+            [&](uint32_t a, uint32_t b) { return dists[a] < dists[b]; });
+
+  uint32_t hashSize = (uint32_t)std::ceil(std::sqrt((double)unique.size()));
+  m_hullPrev.assign(n, NONE);
+  m_hullNext.assign(n, NONE);
+  m_hullTri.assign(n, NONE);
+  m_hullHash.assign(hashSize, NONE);
+
+  size_t maxTriangles = 2 * unique.size() - 5;
+  m_triangles.reserve(maxTriangles * 3);
+  m_halfedges.reserve(maxTriangles * 3);
+
+  m_hullStart = i0;
+  m_hullNext[i0] = m_hullPrev[i2] = i1;
+  m_hullNext[i1] = m_hullPrev[i0] = i2;
+  m_hullNext[i2] = m_hullPrev[i1] = i0;
+  m_hullTri[i0] = 0;
+  m_hullTri[i1] = 1;
+  m_hullTri[i2] = 2;
+  m_hullHash[hashKey(points[i0])] = i0;
+  m_hullHash[hashKey(points[i1])] = i1;
+  m_hullHash[hashKey(points[i2])] = i2;
+
+  addTriangle(i0, i1, i2, NONE, NONE, NONE);
+
+  for (uint32_t i : unique) {
+    if (i == i0 || i == i1 || i == i2)
+      continue;
+
+    const Vec2 &p = points[i];
+
+    // A hull point near the angle of p, removed ones point to themselves
+    uint32_t start = 0;
+    for (uint32_t j = 0, key = hashKey(p); j < hashSize; j++) {
+      start = m_hullHash[(key + j) % hashSize];
+      if (start != NONE && start != m_hullNext[start])
+        break;
+    }
+
+    // First hull edge p sees
+    start = m_hullPrev[start];
+    uint32_t e = start;
+    uint32_t q;
+    while (q = m_hullNext[e], Orient(p, points[e], points[q]) >= 0) {
+      e = q;
+      if (e == start) {
+        e = NONE;
+        break;
+      }
+    }
+    // Only on the hull, which distinct points further out cannot be
+    if (e == NONE)
+      continue;
+
+    uint32_t t = addTriangle(e, i, m_hullNext[e], NONE, NONE, m_hullTri[e]);
+    m_hullTri[i] = legalize(points, t + 2);
+    m_hullTri[e] = t;
+
+    // Forward over the other visible edges
+    uint32_t next = m_hullNext[e];
+    while (q = m_hullNext[next], Orient(p, points[next], points[q]) < 0) {
+      t = addTriangle(next, i, q, m_hullTri[i], NONE, m_hullTri[next]);
+      m_hullTri[i] = legalize(points, t + 2);
+      m_hullNext[next] = next;
+      next = q;
+    }
+
+    // And backward when the first one may not be the first
+    if (e == start) {
+      while (q = m_hullPrev[e], Orient(p, points[q], points[e]) < 0) {
+        t = addTriangle(q, i, e, NONE, m_hullTri[e], m_hullTri[q]);
+        legalize(points, t + 2);
+        m_hullTri[q] = t;
+        m_hullNext[e] = e;
+        e = q;
+      }
+    }
+
+    m_hullStart = m_hullPrev[i] = e;
+    m_hullNext[e] = m_hullPrev[next] = i;
+    m_hullNext[i] = next;
+
+    m_hullHash[hashKey(p)] = i;
+    m_hullHash[hashKey(points[e])] = e;
+  }
+
+  m_hullPrev.clear();
+  m_hullNext.clear();
+  m_hullTri.clear();
+  m_hullHash.clear();
+  m_edgeStack.clear();
+}
+
+const std::vector<uint32_t> &Delaunay::triangles() const { return m_triangles; }
+
+const std::vector<uint32_t> &Delaunay::halfedges() const { return m_halfedges; }
+
+std::vector<Delaunay::Edge> Delaunay::edges() const {
+  std::vector<Edge> edges = m_copies;
+
+  for (uint32_t i = 0; i < m_halfedges.size(); i++) {
+    if (m_halfedges[i] == NONE || i < m_halfedges[i]) {
+      uint32_t next = i % 3 == 2 ? i - 2 : i + 1;
+      edges.push_back({m_triangles[i], m_triangles[next]});
+    }
+  }
+
+  for (size_t i = 1; i < m_line.size(); i++) {
+    edges.push_back({m_line[i - 1], m_line[i]});
+  }
+
+  return edges;
+}
+
+uint32_t Delaunay::addTriangle(uint32_t i0, uint32_t i1, uint32_t i2,
+                               uint32_t a, uint32_t b, uint32_t c) {
+  uint32_t t = (uint32_t)m_triangles.size();
+  m_triangles.insert(m_triangles.end(), {i0, i1, i2});
+  m_halfedges.insert(m_halfedges.end(), {NONE, NONE, NONE});
+  link(t, a);
+  link(t + 1, b);
+  link(t + 2, c);
+  return t;
+}
+
+// Flips a and the edges it uncovers until their triangles are Delaunay,
+// returns the half-edge now in the place of the one before a
+uint32_t Delaunay::legalize(const std::vector<Vec2> &points, uint32_t a) {
+  uint32_t ar = 0;
+
+  while (true) {
+    uint32_t b = m_halfedges[a];
+    uint32_t a0 = a - a % 3;
+    ar = a0 + (a + 2) % 3;
+
+    if (b == NONE) {
+      if (m_edgeStack.empty())
+        break;
+      a = m_edgeStack.back();
+      m_edgeStack.pop_back();
+      continue;
+    }
+
+    uint32_t b0 = b - b % 3;
+    uint32_t al = a0 + (a + 1) % 3;
+    uint32_t bl = b0 + (b + 2) % 3;
+
+    uint32_t p0 = m_triangles[ar];
+    uint32_t pr = m_triangles[a];
+    uint32_t pl = m_triangles[al];
+    uint32_t p1 = m_triangles[bl];
+
+    // Clockwise triangles, so inside is negative
+    bool illegal =
+        Engine::Math::incircle(points[p0], points[pr], points[pl],
+                               points[p1]) < 0;
+
+    if (!illegal) {
+      if (m_edgeStack.empty())
+        break;
+      a = m_edgeStack.back();
+      m_edgeStack.pop_back();
+      continue;
+    }
+
+    m_triangles[a] = p1;
+    m_triangles[b] = p0;
+
+    uint32_t hbl = m_halfedges[bl];
+
+    // The flip moved a hull edge, its hull point has to follow
+    if (hbl == NONE) {
+      uint32_t e = m_hullStart;
+      do {
+        if (m_hullTri[e] == bl) {
+          m_hullTri[e] = a;
+          break;
+        }
+        e = m_hullPrev[e];
+      } while (e != m_hullStart);
+    }
+
+    link(a, hbl);
+    link(b, m_halfedges[ar]);
+    link(ar, bl);
+
+    m_edgeStack.push_back(b0 + (b + 1) % 3);
+  }
+
+  return ar;
+}
+
+void Delaunay::link(uint32_t a, uint32_t b) {
+  m_halfedges[a] = b;
+  if (b != NONE)
+    m_halfedges[b] = a;
+}
+
+uint32_t Delaunay::hashKey(const Vec2 &p) const {
+  double angle = PseudoAngle(p[0] - m_centerX, p[1] - m_centerY);
+  return (uint32_t)std::floor(angle * m_hullHash.size()) % m_hullHash.size();
+}
@@ -0,0 +1,138 @@
+#include "Geometry/Proximity.hpp"
+
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <functional>
+
+ProximityGraph::ProximityGraph(const std::vector<Vec2> &points)
+    : m_points(points) {
+  m_edges = Delaunay(points).edges();
+
+  m_offsets.assign(points.size() + 1, 0);
+  for (const Edge &e : m_edges) {
+    m_offsets[e.a + 1]++;
+    m_offsets[e.b + 1]++;
+  }
+  std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+  std::vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+  m_adjacency.resize(m_offsets.back());
+  for (const Edge &e : m_edges) {
+    m_adjacency[fill[e.a]++] = e.b;
+    m_adjacency[fill[e.b]++] = e.a;
+  }
+}
+
+std::vector<uint32_t> ProximityGraph::nearest() const {
+  std::vector<uint32_t> nearest(m_points.size(), NONE);
+  std::vector<double> best(m_points.size(), INFINITY);
+
+  for (const Edge &e : m_edges) {
+    double d = distance(e.a, e.b);
+    if (d < best[e.a]) {
+      best[e.a] = d;
+      nearest[e.a] = e.b;
+    }
+    if (d < best[e.b]) {
+      best[e.b] = d;
+      nearest[e.b] = e.a;
+    }
+  }
+
+  return nearest;
+}
+
+std::vector<uint32_t> ProximityGraph::nearest(uint32_t k) const {
+  std::vector<uint32_t> nearest(m_points.size() * k, NONE);
+
+  JobSystem::get().parallelFor(0, m_points.size(), 1024, [&](size_t begin,
+                                                             size_t end) {
+    struct Candidate {
+      double distance;
+      uint32_t point;
+
+      bool operator>(const Candidate &other) const {
+        return distance > other.distance;
+      }
+    };
+
+    // Kept across points, a min-heap and the points already queued
+    std::vector<Candidate> heap;
+    std::vector<uint32_t> seen;
+
+    for (size_t i = begin; i < end; i++) {
+      uint32_t p = (uint32_t)i;
+      heap.clear();
+      seen.assign(1, p);
+
+      auto expand = [&](uint32_t from) {
+        for (uint32_t o = m_offsets[from]; o < m_offsets[from + 1]; o++) {
+          uint32_t q = m_adjacency[o];
+          if (std::find(seen.begin(), seen.end(), q) == seen.end()) {
+            seen.push_back(q);
+            heap.push_back({distance(p, q), q});
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+          }
+        }
+      };
+
+      expand(p);
+      for (uint32_t found = 0; found < k && !heap.empty(); found++) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        uint32_t q = heap.back().point;
+        heap.pop_back();
+        nearest[i * k + found] = q;
+        // The last one found needs no more candidates
+        if (found + 1 < k)
+          expand(q);
+      }
+    }
+  });
+
+  return nearest;
+}
+
+std::vector<ProximityGraph::Edge> ProximityGraph::spanningTree() const {
+  std::vector<double> lengths(m_edges.size());
+  for (size_t i = 0; i < m_edges.size(); i++) {
+    lengths[i] = distance(m_edges[i].a, m_edges[i].b);
+  }
+
+  std::vector<uint32_t> order(m_edges.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return lengths[a] < lengths[b]; });
+
+  // Union-find with path halving
+  std::vector<uint32_t> parent(m_points.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto root = [&](uint32_t v) {
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+    return v;
+  };
+
+  std::vector<Edge> tree;
+  tree.reserve(m_points.size());
+  for (uint32_t i : order) {
+    uint32_t a = root(m_edges[i].a);
+    uint32_t b = root(m_edges[i].b);
+    if (a != b) {
+      parent[a] = b;
+      tree.push_back(m_edges[i]);
+    }
+  }
+
+  return tree;
+}
+
+double ProximityGraph::distance(uint32_t a, uint32_t b) const {
+  double dx = (double)m_points[a][0] - m_points[b][0];
+  double dy = (double)m_points[a][1] - m_points[b][1];
+  return std::sqrt(dx * dx + dy * dy);
+}
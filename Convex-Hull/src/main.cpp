@@ -1,4 +1,11 @@
 #include "GLFW/glfw3.h"
+#include "Geometry/Proximity.hpp"
+#include "Geometry/Statistics.hpp"
+#include "Math/DynamicHull.hpp"
+#include "Math/Hull.hpp"
+#include "Math/Predicates.hpp"
+#include "Math/StreamingHull.hpp"
+#include "Utils/Pipeline.hpp"
 #include "Wrappers/Line.hpp"
 #include "Wrappers/Point.hpp"
 #include "Wrappers/Poly.hpp"
@@ -11,131 +18,54 @@
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <random>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 using Vec2 = Engine::Math::Vector<2>;
 using Line = Engine::Math::Vector<3>;
 using Cell = std::vector<Vec2>;
 
-float pointSide(Vec2 P, Vec2 A, Vec2 B) {
-  Vec2 AB = B - A;
-  Vec2 AP = P - A;
-
-  return (AB[0] * AP[1]) - (AB[1] * AP[0]);
-}
-
-void FindHull(std::vector<Vec2> &hull, std::vector<Vec2> &points, Vec2 P,
-              Vec2 Q, uint32_t &recur) {
-
-  recur += 1;
-  if (points.empty()) {
-    return;
-  }
-
-  struct {
-    float dist = 0;
-    size_t i = 0;
-  } max;
-
-  Vec2 delta = Q - P;
-  Vec2 dir = delta;
-  dir.norm();
-  for (size_t i = 0; i < points.size(); i++) {
-    float dist = std::abs(pointSide(points[i], P, Q));
-    if (max.dist < dist) {
-      max.dist = dist;
-      max.i = i;
-    }
-  }
-
-  Vec2 C = points[max.i];
-  auto it = std::find(hull.begin(), hull.end(), P);
-  if (it == hull.end()) {
-    throw std::runtime_error("P not find in hull");
-  }
-  hull.emplace(++it, C);
-
-  std::vector<Vec2> S[2];
-
-  for (size_t i = 0; i < points.size(); i++) {
-    if (i == max.i)
-      continue;
-
-    float sidePC = pointSide(points[i], P, C);
-    float sideCQ = pointSide(points[i], C, Q);
-
-    if (sidePC > 0) {
-      S[0].push_back(points[i]);
-    }
-
-    if (sideCQ > 0) {
-      S[1].push_back(points[i]);
-    }
-  }
-
-  FindHull(hull, S[0], P, C, recur);
-  FindHull(hull, S[1], C, Q, recur);
-}
-
-std::vector<Vec2> ConvexHull(std::vector<Vec2> points, uint32_t &recursions) {
-  std::vector<Vec2> hull;
-
-  std::sort(points.begin(), points.end(),
-            [](Vec2 a, Vec2 b) { return a[0] < b[0]; });
-
-  size_t left = 0;
-  size_t right = points.size();
-
-  hull.push_back(points.front());
-  hull.push_back(points.back());
-
-  std::vector<Vec2> S[2];
-
-  float midx = (points.front()[0] + points.back()[0]) / 2;
-  size_t mid = 0;
-
-  for (size_t i = 1; i < points.size() - 1 && mid == 0; i++) {
-    float side = pointSide(points[i], points.front(), points.back());
-    S[side < 0].push_back(points[i]);
-  }
-
-  FindHull(hull, S[0], points.front(), points.back(), recursions);
-  FindHull(hull, S[1], points.back(), points.front(), recursions);
-
-  Vec2 centroid = {0.0f, 0.0f};
-  for (const auto &p : hull) {
-    centroid[0] += p[0];
-    centroid[1] += p[1];
-  }
-  centroid[0] /= hull.size();
-  centroid[1] /= hull.size();
-
-  std::sort(hull.begin(), hull.end(), [&](const Vec2 &a, const Vec2 &b) {
-    float angleA = atan2(a[1] - centroid[1], a[0] - centroid[0]);
-    float angleB = atan2(b[1] - centroid[1], b[0] - centroid[0]);
-    return angleA < angleB;
-  });
-
-  return hull;
-}
-
 struct MyWindow : public Engine::Window {
   MyWindow() {
     m_state.addHeader("pointsAmount");
+    m_state.addHeader("hullAlgorithm");
     m_state.addHeader("hullTime");
     m_state.addHeader("recursions");
     m_state.addHeader("hullAmount");
     m_state.addHeader("pointsMeanDist");
     m_state.addHeader("pointsMedianDist");
     m_state.addHeader("pointsStdDist");
+    m_state.addHeader("nearestMeanDist");
+    m_state.addHeader("nearestStdDist");
+    m_state.addHeader("treeLength");
+    m_state.addHeader("proximityTime");
+    m_state.addHeader("exactRate");
+    m_state.addHeader("rejectedRate");
+    m_state.addHeader("dynamicTime");
+    m_state.addHeader("changedEdges");
+    m_state.addHeader("latency");
 
     m_state.get("pointsAmount") = 0u;
     m_state.get("hullAmount") = 0u;
     m_state.get("recursions") = 0u;
+    m_state.get("hullAlgorithm") =
+        std::string(Engine::Math::HullAlgorithmName(m_algorithm));
     m_state.get("hullTime") = (double)0;
     m_state.get("pointsMeanDist") = (double)0;
+    m_state.get("pointsMedianDist") = (double)0;
     m_state.get("pointsStdDist") = (double)0;
+    m_state.get("nearestMeanDist") = (double)0;
+    m_state.get("nearestStdDist") = (double)0;
+    m_state.get("treeLength") = (double)0;
+    m_state.get("proximityTime") = (double)0;
+    m_state.get("exactRate") = (double)0;
+    m_state.get("rejectedRate") = (double)0;
+    m_state.get("dynamicTime") = (double)0;
+    m_state.get("changedEdges") = 0u;
+    m_state.get("latency") = (double)0;
   }
 
   const float POINT_RADIUS = 12;
@@ -163,70 +93,293 @@ struct MyWindow : public Engine::Window {
 
     if (refresh) {
       m_engine->clear();
+      m_points.clear();
+      m_lines.clear();
+      m_edges.clear();
+      m_tracking = false;
 
-      std::vector<float> dists;
       for (size_t i = 0; i < points.size(); i++) {
-        Vec2 p = points[i];
+        m_points.emplace_back(std::move(
+            m_engine->createPoint(points[i], POINT_COLOR, POINT_RADIUS)));
+      }
 
-        for (size_t j = i + 1; j < points.size(); j++) {
-          Vec2 b = points[j];
+      analyse();
+      refresh = false;
+    }
 
-          dists.push_back((b - p).mag());
-        }
+    std::optional<Pipeline<Analysis>::Output> output = m_pipeline.poll();
+    if (!output)
+      return;
+
+    const Analysis &analysis = output->result;
 
-        m_points.emplace_back(
-            std::move(m_engine->createPoint(p, POINT_COLOR, POINT_RADIUS)));
+    // The partial result already drew the hull
+    if (output->generation != m_hullGeneration) {
+      const std::vector<Vec2> &hull = analysis.hull;
+      for (size_t i = 0; i < hull.size(); i++) {
+        size_t ni = (i + 1) % hull.size();
+        m_lines.emplace_back(std::move(m_engine->createLine(
+            hull[i], hull[ni], DELAUNAY_COLOR, LINE_STOKE)));
       }
+      m_hullGeneration = output->generation;
+    }
 
-      if (points.size() > 2) {
-        float var = 0;
-        float mean = 0;
-        for (auto dist : dists) {
-          mean += dist;
-          var += dist * dist;
+    if (!output->complete)
+      return;
+
+    m_state.get("hullTime") = analysis.hullSeconds;
+    m_state.get("exactRate") = analysis.exactRate;
+    m_state.get("rejectedRate") = analysis.rejectedRate;
+    m_state.get("recursions") = analysis.recursions;
+    m_state.get("hullAlgorithm") =
+        std::string(Engine::Math::HullAlgorithmName(analysis.algorithm));
+    m_state.get("hullAmount") = (uint32_t)analysis.hull.size();
+    m_state.get("pointsMeanDist") = analysis.pairs.mean;
+    m_state.get("pointsStdDist") = analysis.pairs.deviation();
+    m_state.get("pointsMedianDist") = analysis.pairsMedian;
+    m_state.get("nearestMeanDist") = analysis.nearest.mean;
+    m_state.get("nearestStdDist") = analysis.nearest.deviation();
+    m_state.get("treeLength") = analysis.treeLength;
+    m_state.get("proximityTime") = analysis.proximitySeconds;
+    m_state.get("latency") = output->latency;
+  }
+
+private:
+  // Everything measured on a copy of the points in the background. The hull
+  // is published as soon as it is done, the statistics complete it
+  struct Analysis {
+    std::vector<Vec2> hull;
+    Engine::Math::HullAlgorithm algorithm;
+    uint32_t recursions = 0;
+    double hullSeconds = 0;
+    double exactRate = 0;
+    // Share of the points the octagon prefilter removed
+    double rejectedRate = 0;
+
+    RunningStats pairs;
+    double pairsMedian = 0;
+    RunningStats nearest;
+    double treeLength = 0;
+    double proximitySeconds = 0;
+  };
+
+  // Every pair while there are at most this many, as many random pairs past
+  // that
+  static constexpr size_t PAIR_SAMPLES = 1 << 20;
+
+  static Analysis Analyse(const std::vector<Vec2> &points,
+                          Engine::Math::HullAlgorithm algorithm,
+                          bool prefilter, Pipeline<Analysis>::Task &task) {
+    Analysis analysis;
+    analysis.algorithm = algorithm;
+    size_t n = points.size();
+    if (n <= 2)
+      return analysis;
+
+    Engine::Math::PredicateStats before = Engine::Math::predicateStats();
+    auto start = Clock::now();
+    Engine::Math::HullStats stats;
+    std::vector<Vec2> candidates = points;
+    if (prefilter) {
+      analysis.rejectedRate =
+          (double)Engine::Math::DiscardInterior(candidates) / n;
+    }
+    analysis.hull =
+        Engine::Math::ConvexHull(std::move(candidates), algorithm, &stats);
+    analysis.recursions = stats.recursions;
+    std::chrono::duration<double> seconds = Clock::now() - start;
+    Engine::Math::PredicateStats after = Engine::Math::predicateStats();
+    analysis.hullSeconds = seconds.count();
+    analysis.exactRate = Engine::Math::PredicateStats{
+        after.calls - before.calls, after.exact - before.exact}
+                             .fallbackRate();
+
+    task.publish(analysis);
+    task.checkpoint();
+
+    auto distance = [&](size_t i, size_t j) {
+      double dx = (double)points[i][0] - points[j][0];
+      double dy = (double)points[i][1] - points[j][1];
+      return std::sqrt(dx * dx + dy * dy);
+    };
+
+    std::vector<double> dists;
+    if (n * (n - 1) / 2 <= PAIR_SAMPLES) {
+      dists.reserve(n * (n - 1) / 2);
+      for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+          dists.push_back(distance(i, j));
         }
-        mean /= dists.size();
-        var /= (dists.size() - 1);
-        var = sqrt(var - (mean * mean));
-
-		std::sort(dists.begin(), dists.end());
-
-		size_t medianI = dists.size() / 2;
-		double median = dists[medianI];
-		if(dists.size() % 2 == 0){
-			median += dists[medianI + 1];
-			median /= 2;
-		}
-
-        m_state.get("pointsMeanDist") = (double)mean;
-        m_state.get("pointsMedianDist") = (double)median;
-        m_state.get("pointsStdDist") = (double)var;
       }
+    } else {
+      std::mt19937 gen(task.generation());
+      std::uniform_int_distribution<size_t> pick(0, n - 1);
+      dists.reserve(PAIR_SAMPLES);
+      while (dists.size() < PAIR_SAMPLES) {
+        size_t i = pick(gen), j = pick(gen);
+        if (i != j) {
+          dists.push_back(distance(i, j));
+        }
+      }
+    }
 
-      if (points.size() > 2) {
+    for (double d : dists) {
+      analysis.pairs.add(d);
+    }
+    analysis.pairsMedian = Median(dists);
 
-        uint32_t recursion = 0;
-        auto start = Clock::now();
-        auto hull = ConvexHull(points, recursion);
-        std::chrono::duration<double> seconds = Clock::now() - start;
-        m_state.get("hullTime") = seconds.count();
-        m_state.get("recursions") = recursion;
-        m_state.get("hullAmount") = (uint32_t)hull.size();
+    task.checkpoint();
 
-        for (size_t i = 0; i < hull.size(); i++) {
-          size_t ni = (i + 1) % hull.size();
-          m_lines.emplace_back(std::move(m_engine->createLine(
-              hull[i], hull[ni], DELAUNAY_COLOR, LINE_STOKE)));
-        }
+    start = Clock::now();
+    ProximityGraph graph(points);
+
+    std::vector<uint32_t> neighbours = graph.nearest();
+    for (uint32_t i = 0; i < n; i++) {
+      if (neighbours[i] != ProximityGraph::NONE) {
+        analysis.nearest.add(graph.distance(i, neighbours[i]));
       }
+    }
 
-      std::get<2>(m_state.get("pointsAmount")) = points.size();
+    task.checkpoint();
 
-      refresh = false;
+    for (const ProximityGraph::Edge &e : graph.spanningTree()) {
+      analysis.treeLength += graph.distance(e.a, e.b);
     }
+    seconds = Clock::now() - start;
+    analysis.proximitySeconds = seconds.count();
+
+    return analysis;
   }
 
-private:
+  // Returns the generation of the analysis
+  uint64_t analyse() {
+    std::get<2>(m_state.get("pointsAmount")) = points.size();
+    return m_pipeline.submit([points = points, algorithm = m_algorithm,
+                              prefilter = m_prefilter](
+                                 Pipeline<Analysis>::Task &task) {
+      return Analyse(points, algorithm, prefilter, task);
+    });
+  }
+
+  static uint64_t EdgeKey(Engine::Math::DynamicHull::Edge edge) {
+    return (uint64_t)edge.from << 32 | edge.to;
+  }
+
+  // Mouse edits go through the dynamic hull, seeded with the points on the
+  // first one after a refresh. From then on it draws the hull
+  void track() {
+    if (m_tracking)
+      return;
+
+    for (Engine::Line &line : m_lines) {
+      m_engine->remove(line.getID());
+    }
+    m_lines.clear();
+
+    m_dynamic.assign(points);
+    for (Engine::Math::DynamicHull::Edge edge : m_dynamic.edges()) {
+      m_edges.emplace(EdgeKey(edge),
+                      m_engine->createLine(m_dynamic.point(edge.from),
+                                           m_dynamic.point(edge.to),
+                                           DELAUNAY_COLOR, LINE_STOKE));
+    }
+    m_tracking = true;
+  }
+
+  // Lines of removed edges are moved onto the added ones, only the rest are
+  // created or removed
+  void redraw(const Engine::Math::DynamicHull::Changes &changes) {
+    std::vector<decltype(m_edges)::node_type> spare;
+    for (Engine::Math::DynamicHull::Edge edge : changes.removed) {
+      auto line = m_edges.extract(EdgeKey(edge));
+      if (line)
+        spare.push_back(std::move(line));
+    }
+
+    for (Engine::Math::DynamicHull::Edge edge : changes.added) {
+      Vec2 from = m_dynamic.point(edge.from), to = m_dynamic.point(edge.to);
+      if (spare.empty()) {
+        m_edges.emplace(EdgeKey(edge),
+                        m_engine->createLine(from, to, DELAUNAY_COLOR,
+                                             LINE_STOKE));
+        continue;
+      }
+
+      auto line = std::move(spare.back());
+      spare.pop_back();
+      line.key() = EdgeKey(edge);
+      line.mapped().setVerts(from, to);
+      m_edges.insert(std::move(line));
+    }
+
+    for (auto &line : spare) {
+      m_engine->remove(line.mapped().getID());
+    }
+    m_changedEdges += changes.removed.size() + changes.added.size();
+  }
+
+  void addPoint(Vec2 point) {
+    track();
+    points.push_back(point);
+    m_points.emplace_back(
+        std::move(m_engine->createPoint(point, POINT_COLOR, POINT_RADIUS)));
+
+    Engine::Math::DynamicHull::Changes changes;
+    m_changedEdges = 0;
+    auto start = Clock::now();
+    m_dynamic.insert(point, &changes);
+    std::chrono::duration<double> seconds = Clock::now() - start;
+    redraw(changes);
+
+    m_state.get("dynamicTime") = seconds.count();
+    m_state.get("changedEdges") = m_changedEdges;
+    // The dynamic hull is already drawn, the analysis only logs
+    m_hullGeneration = analyse();
+  }
+
+  void removePoints(float glx, float gly) {
+    track();
+    std::vector<Vec2> keptPoints;
+    std::vector<Engine::Point> kept;
+    Engine::Math::DynamicHull::Changes changes;
+    std::chrono::duration<double> seconds{0};
+    m_changedEdges = 0;
+
+    for (size_t i = 0; i < points.size(); i++) {
+      const Vec2 &p = points[i];
+      float mag = (p[0] - glx) * (p[0] - glx) + (p[1] - gly) * (p[1] - gly);
+      if (mag > POINT_RADIUS) {
+        keptPoints.push_back(p);
+        kept.emplace_back(std::move(m_points[i]));
+        continue;
+      }
+
+      m_engine->remove(m_points[i].getID());
+      auto start = Clock::now();
+      m_dynamic.erase(m_dynamic.find(p), &changes);
+      seconds += Clock::now() - start;
+      redraw(changes);
+    }
+    points.swap(keptPoints);
+    m_points.swap(kept);
+
+    m_state.get("dynamicTime") = seconds.count();
+    m_state.get("changedEdges") = m_changedEdges;
+    m_hullGeneration = analyse();
+  }
+
+  uint64_t m_hullGeneration = 0;
+  Engine::Math::HullAlgorithm m_algorithm =
+      Engine::Math::HullAlgorithm::QuickHull;
+  bool m_prefilter = true;
+  Pipeline<Analysis> m_pipeline;
+
+  Engine::Math::DynamicHull m_dynamic;
+  // Whether m_dynamic holds the points and m_edges draws their hull
+  bool m_tracking = false;
+  std::unordered_map<uint64_t, Engine::Line> m_edges;
+  uint32_t m_changedEdges = 0;
+
   void mouseButtonCallback(int button, int action, int mods) override {
     if (action == GLFW_PRESS) {
       float glx = m_mouse[0];
@@ -240,21 +393,28 @@ private:
         if (uid != 0 && m_engine->getType(uid) == 0) {
           return;
         }
-        points.push_back({glx, gly});
-        refresh = true;
+        if (refresh) {
+          points.push_back({glx, gly});
+          return;
+        }
+        addPoint({glx, gly});
       } else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
         if (uid == 0) {
           return;
         }
 
-        if (m_engine->getType(uid) == 0) {
+        if (m_engine->getType(uid) != 0) {
+          return;
+        }
+        if (refresh) {
           std::erase_if(points, [=, this](Vec2 &p) {
             float mag =
                 (p[0] - glx) * (p[0] - glx) + (p[1] - gly) * (p[1] - gly);
             return mag <= POINT_RADIUS;
           });
-          refresh = true;
+          return;
         }
+        removePoints(glx, gly);
       }
     }
   }
@@ -365,6 +525,30 @@ private:
     refresh = true;
   }
 
+public:
+  // The hull of a streamed file, scaled into the window, as the points
+  void show(const std::vector<Vec2> &hull) {
+    points.clear();
+    refresh = true;
+    if (hull.empty())
+      return;
+
+    Vec2 lo = hull[0], hi = hull[0];
+    for (const Vec2 &p : hull) {
+      lo = {std::min(lo[0], p[0]), std::min(lo[1], p[1])};
+      hi = {std::max(hi[0], p[0]), std::max(hi[1], p[1])};
+    }
+    float margin = 0.05f * m_windowSize.min();
+    float extent = std::max(hi[0] - lo[0], hi[1] - lo[1]);
+    float scale = extent > 0 ? (m_windowSize.min() - 2 * margin) / extent : 1;
+    for (const Vec2 &p : hull) {
+      points.push_back(
+          {margin + (p[0] - lo[0]) * scale, margin + (p[1] - lo[1]) * scale});
+    }
+  }
+
+private:
+
   double timer = 0;
 
   void keyCallback(int key, int scancode, int action, int mode) override {
@@ -391,6 +575,20 @@ private:
         createCircle();
         break;
 
+      case GLFW_KEY_H:
+        m_algorithm = (Engine::Math::HullAlgorithm)(
+            ((int)m_algorithm + 1) % Engine::Math::HULL_ALGORITHMS);
+        std::cout << "hull: " << Engine::Math::HullAlgorithmName(m_algorithm)
+                  << '\n';
+        refresh = true;
+        break;
+
+      case GLFW_KEY_P:
+        m_prefilter = !m_prefilter;
+        std::cout << "prefilter: " << (m_prefilter ? "on" : "off") << '\n';
+        refresh = true;
+        break;
+
       case GLFW_KEY_0:
       case GLFW_KEY_1:
       case GLFW_KEY_2:
@@ -420,8 +618,26 @@ private:
   }
 };
 
-int main() {
+int main(int argc, char **argv) {
+  std::optional<std::vector<Vec2>> streamed;
+  if (argc > 2 && std::string(argv[1]) == "--stream") {
+    Engine::Math::StreamingHull hull;
+    try {
+      Engine::Math::StreamStats stats = Engine::Math::StreamHull(argv[2], hull);
+      std::cout << stats.points << " points "
+                << (stats.mapped ? "mapped" : "read") << " in "
+                << stats.seconds << "s, " << stats.pointsPerSecond()
+                << " points/s, " << hull.hull().size() << " on the hull\n";
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+    streamed = hull.hull();
+  }
+
   MyWindow win;
+  if (streamed)
+    win.show(*streamed);
   while (win.isActivate()) {
     win.gameloop();
   }
@@ -0,0 +1,12 @@
+#version 430 core
+
+flat in vec3 color;
+
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint outUUID;
+
+void main(){
+	FragColor = vec4(color, 1.0);
+	// Not an object, picks go through to what is under it
+	outUUID = 0u;
+}
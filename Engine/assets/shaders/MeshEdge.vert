@@ -0,0 +1,34 @@
+#version 430 core
+
+layout(std140, binding = 0) uniform Matrices { mat4 mProj; };
+
+layout(std430, binding = 0) readonly buffer Vertices { vec2 vertices[]; };
+// origin, twin, next, face
+layout(std430, binding = 1) readonly buffer HalfEdges { uvec4 halfEdges[]; };
+
+uniform vec3 edgeColor;
+uniform float stroke;
+
+flat out vec3 color;
+
+void main() {
+  uint e = uint(gl_InstanceID);
+  uvec4 edge = halfEdges[e];
+
+  // Each edge once, from its first half. Holes are their own twin
+  if (edge.y <= e) {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    return;
+  }
+
+  vec2 a = vertices[edge.x];
+  vec2 b = vertices[halfEdges[edge.z].x];
+  vec2 along = b - a;
+  vec2 side = vec2(0.0);
+  if (dot(along, along) > 0.0)
+    side = normalize(vec2(-along.y, along.x)) * stroke * 0.5;
+
+  vec2 corner = (gl_VertexID < 2 ? a : b) + (gl_VertexID % 2 == 0 ? -side : side);
+  gl_Position = mProj * vec4(corner, 1.0, 1.0);
+  color = edgeColor;
+}
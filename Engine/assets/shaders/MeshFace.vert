@@ -0,0 +1,30 @@
+#version 430 core
+
+layout(std140, binding = 0) uniform Matrices { mat4 mProj; };
+
+layout(std430, binding = 0) readonly buffer Vertices { vec2 vertices[]; };
+// origin, twin, next, face
+layout(std430, binding = 1) readonly buffer HalfEdges { uvec4 halfEdges[]; };
+layout(std430, binding = 2) readonly buffer Faces { uint faces[]; };
+layout(std430, binding = 3) readonly buffer FaceColors { float faceColors[]; };
+
+flat out vec3 color;
+
+// Triangle e of the fan of its face from the first half-edge's origin. The
+// two touching that origin are empty, as are those outside the mesh
+void main() {
+  uvec4 edge = halfEdges[gl_VertexID / 3];
+  if (edge.w == 0xFFFFFFFFu) {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    return;
+  }
+
+  int corner = gl_VertexID % 3;
+  uint vertex = corner == 0   ? halfEdges[faces[edge.w]].x
+                : corner == 1 ? edge.x
+                              : halfEdges[edge.z].x;
+  gl_Position = mProj * vec4(vertices[vertex], 0.0, 1.0);
+
+  uint f = 3u * edge.w;
+  color = vec3(faceColors[f], faceColors[f + 1u], faceColors[f + 2u]);
+}
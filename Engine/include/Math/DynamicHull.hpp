@@ -0,0 +1,139 @@
+#ifndef DYNAMIC_HULL_HPP
+#define DYNAMIC_HULL_HPP
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Math {
+
+// Convex hull of a point set under insertions and deletions
+//
+// "Maintenance of configurations in the plane" by Mark H. Overmars and Jan
+//  van Leeuwen (1981)
+//
+// The points are the leaves of an AVL tree, in lexicographic order. Every
+// inner node keeps the bridges of its subtree: the edges joining the upper
+// hull of its left leaves to the one of its right leaves, and the same for
+// the lower hulls. A subtree's hull is then its left child's up to the bridge
+// and its right child's from it, nothing else is stored. An update recomputes
+// the bridges on its path, each by one walk down both children. O(log²(N))
+// per update, O(log(N)) per query
+//
+// Points are referred to by ids, which stay valid while they are in the set.
+// The hull has no collinear vertices, as ConvexHull.
+class ENGINE_API DynamicHull {
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // Between two hull vertices, counter-clockwise
+  struct Edge {
+    uint32_t from;
+    uint32_t to;
+  };
+
+  // Hull edges an update removed and added
+  struct Changes {
+    std::vector<Edge> removed;
+    std::vector<Edge> added;
+  };
+
+  // Replaces the set, built bottom up in O(N log(N)). Duplicates are dropped
+  void assign(std::vector<Vector<2>> points);
+  void clear();
+
+  // Id of the new point, NONE when it is already in the set. `changes` is
+  // overwritten with the edges of this call
+  uint32_t insert(const Vector<2> &point, Changes *changes = nullptr);
+  // False when `id` is not in the set
+  bool erase(uint32_t id, Changes *changes = nullptr);
+
+  // Id of `point`, NONE when it is not in the set
+  uint32_t find(const Vector<2> &point) const;
+  const Vector<2> &point(uint32_t id) const;
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  // Vertices counter-clockwise from the lowest x, then lowest y
+  std::vector<uint32_t> hull() const;
+  // (v, next(v)) for every vertex v, both ways around two vertices and none
+  // around one
+  std::vector<Edge> edges() const;
+
+  bool onHull(uint32_t id) const;
+  // Neighbours of a hull vertex counter-clockwise, NONE off the hull
+  uint32_t next(uint32_t id) const;
+  uint32_t prev(uint32_t id) const;
+
+  // Hull vertex farthest along `direction`, NONE when empty
+  uint32_t extreme(const Vector<2> &direction) const;
+  // The vertices the tangents from `point` touch, `point` would be between
+  // them counter-clockwise if it was inserted. None when it is inside the
+  // hull, on its boundary or in the set
+  std::optional<std::pair<uint32_t, uint32_t>>
+  tangents(const Vector<2> &point) const;
+
+private:
+  struct Node {
+    Vector<2> point;
+    uint32_t child[2] = {NONE, NONE};
+    uint32_t parent = NONE;
+    // First and last leaf below
+    uint32_t end[2];
+    // Left and right end of the upper bridge, then of the lower one. The
+    // lower hull is kept as the upper hull of the points turned upside down,
+    // where left and right swap
+    uint32_t bridge[2][2];
+    // NONE once freed
+    uint32_t height = 0;
+    // Counter-clockwise hull neighbours of a leaf, NONE off the hull
+    uint32_t prev = NONE;
+    uint32_t next = NONE;
+  };
+
+  // Hull vertex with its neighbours along one of the two chains
+  struct Vertex {
+    uint32_t id = NONE;
+    uint32_t left = NONE;
+    uint32_t right = NONE;
+  };
+
+  bool leaf(uint32_t v) const { return m_nodes[v].child[0] == NONE; }
+  // Seen from the upper or the upside down lower chain
+  uint32_t child(uint32_t v, int side, int lower) const;
+  Vector<2> at(uint32_t id, int lower) const;
+
+  uint32_t allocate();
+  uint32_t build(const std::vector<Vector<2>> &points, size_t begin,
+                 size_t end);
+  void pull(uint32_t v);
+  void bridge(uint32_t v, int lower);
+  uint32_t rotate(uint32_t v, int side);
+  // Rebalances and pulls every node from `v` up
+  void retrace(uint32_t v);
+
+  // Walks the chain down to the first vertex whose right edge is not
+  // `forward`, or the last one
+  template <typename Forward>
+  Vertex search(int lower, Forward forward) const;
+  // `id` along the chain, with an other id when it is not on it
+  Vertex locate(uint32_t id, int lower) const;
+  // Neighbours in the current tree, false off the hull
+  bool neighbours(uint32_t id, uint32_t &prev, uint32_t &next) const;
+  void link(uint32_t from, uint32_t to);
+
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_free;
+  uint32_t m_root = NONE;
+  size_t m_size = 0;
+};
+
+} // namespace Math
+} // namespace Engine
+
+#endif // DYNAMIC_HULL_HPP
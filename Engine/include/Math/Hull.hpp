@@ -0,0 +1,91 @@
+#ifndef HULL_HPP
+#define HULL_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Math {
+
+// Planar convex hulls on the exact orient2d
+//
+// Every algorithm returns the hull counter-clockwise from its lowest x (then
+// lowest y) point, without duplicated or collinear points: one point when
+// they all coincide, two when they are all on a line.
+enum class HullAlgorithm : uint8_t {
+  MonotoneChain,
+  Chan,
+  QuickHull,
+  ParallelQuickHull
+};
+const uint8_t HULL_ALGORITHMS = 4;
+
+ENGINE_API const char *HullAlgorithmName(HullAlgorithm algorithm);
+
+struct HullStats {
+  // QuickHull subproblems, Chan rounds, none for the monotone chain
+  uint32_t recursions = 0;
+};
+
+// "Another efficient algorithm for convex hulls in two dimensions" by
+//  A. M. Andrew (1979)
+//
+// Sorts the points, then one pass builds the lower chain and one the upper.
+// O(N log(N))
+ENGINE_API std::vector<Vector<2>> MonotoneChain(std::vector<Vector<2>> points);
+
+// "Optimal output-sensitive convex hull algorithms in two and three
+//  dimensions" by Timothy M. Chan (1996)
+//
+// Guesses m for h, hulls groups of m points and gift wraps the groups for at
+// most m steps, squaring m until the wrap closes. Wrapping points on the hull
+// of a group only move forward around it, so a round costs O(N log(m)).
+// O(N log(h))
+ENGINE_API std::vector<Vector<2>> ChanHull(const std::vector<Vector<2>> &points,
+                                           HullStats *stats = nullptr);
+
+// "The quickhull algorithm for convex hulls" by C. Bradford Barber, David P.
+//  Dobkin and Hannu Huhdanpaa (1996)
+//
+// Each subproblem is an index range of `points`, partitioned in place around
+// its farthest point. O(N log(N)) expected, O(N²) worst case
+ENGINE_API std::vector<Vector<2>> QuickHull(std::vector<Vector<2>> points,
+                                            HullStats *stats = nullptr);
+
+// QuickHull on the JobSystem. The top subproblems find their farthest point
+// and partition their range in chunks, through scratch arrays allocated once,
+// and run their two sides as jobs; below 2^16 points they run serially.
+// Nothing is allocated per subproblem, a side leaves its chain at the front of
+// its own range. Without workers it is QuickHull
+ENGINE_API std::vector<Vector<2>>
+ParallelQuickHull(std::vector<Vector<2>> points, HullStats *stats = nullptr);
+
+// "A fast convex hull algorithm" by Selim G. Akl and Godfried T. Toussaint
+//  (1978)
+//
+// Removes the points strictly inside the octagon of the extreme points along
+// x, y, x + y and x - y, none of them is a hull vertex, and keeps the order of
+// the rest. Most of a random cloud goes before any hull algorithm sees it.
+// One SSE2 pass finds the extremes, one tests four points at a time with AVX2
+// (two with SSE2 where the CPU lacks it) against every edge and compacts the
+// rest without branches. Points the double filter cannot place are kept.
+// Returns how many were removed
+ENGINE_API size_t DiscardInterior(std::vector<Vector<2>> &points);
+
+// Hull of the points of two hulls in O(h₁ + h₂): the lower chains of both,
+// already sorted, are merged and swept once as in the monotone chain, and
+// the upper ones the same way back
+ENGINE_API std::vector<Vector<2>> MergeHulls(const std::vector<Vector<2>> &a,
+                                             const std::vector<Vector<2>> &b);
+
+ENGINE_API std::vector<Vector<2>> ConvexHull(std::vector<Vector<2>> points,
+                                             HullAlgorithm algorithm,
+                                             HullStats *stats = nullptr);
+
+} // namespace Math
+} // namespace Engine
+
+#endif // HULL_HPP
@@ -0,0 +1,62 @@
+#ifndef HULL_3D_HPP
+#define HULL_3D_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Math {
+
+// Convex hull in space as a closed triangle mesh
+//
+// Faces are counter-clockwise seen from outside. Half-edge 3f + k of face f
+// leaves its k-th vertex, next goes around the face and twin is the same
+// edge the other way on the neighbouring face. Coplanar faces are not merged
+struct Hull3D {
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  struct HalfEdge {
+    // Index of the input point it leaves
+    uint32_t origin;
+    uint32_t twin;
+  };
+
+  std::vector<HalfEdge> edges;
+  // Input points that are vertices, increasing
+  std::vector<uint32_t> vertices;
+
+  size_t faces() const { return edges.size() / 3; }
+  static uint32_t face(uint32_t e) { return e / 3; }
+  static uint32_t next(uint32_t e) { return e - e % 3 + (e + 1) % 3; }
+  uint32_t origin(uint32_t e) const { return edges[e].origin; }
+  uint32_t target(uint32_t e) const { return edges[next(e)].origin; }
+  uint32_t twin(uint32_t e) const { return edges[e].twin; }
+};
+
+// "The quickhull algorithm for convex hulls" by C. Bradford Barber, David P.
+//  Dobkin and Hannu Huhdanpaa (1996)
+//
+// Starts from a tetrahedron, every other point in the conflict list of one
+// face it is outside of. The farthest point of a face is added next: the
+// faces it sees are flooded from there, the horizon edges around them are
+// joined to it with new faces and the conflicts of the removed faces move to
+// the new ones they see, or are dropped inside. Sides are decided by the
+// exact orient3d, a point on the plane of a face does not see it.
+// O(N log(N)) expected. Empty when every point is on one plane
+ENGINE_API Hull3D QuickHull3D(const std::vector<Vector<3>> &points);
+
+// "Voronoi diagrams from convex hulls" by Kevin Q. Brown (1979)
+//
+// QuickHull3D of the sites lifted onto z = x² + y², with the exact incircle
+// as orientation so the lifting loses nothing. The faces below, those whose
+// sites turn clockwise, are the Delaunay triangles. Empty when every site is
+// on one line or one circle
+ENGINE_API Hull3D LiftedHull(const std::vector<Vector<2>> &sites);
+
+} // namespace Math
+} // namespace Engine
+
+#endif // HULL_3D_HPP
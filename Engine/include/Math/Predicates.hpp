@@ -0,0 +1,72 @@
+#ifndef PREDICATES_HPP
+#define PREDICATES_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Math/Vector.hpp"
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Math {
+
+// Adaptive exact predicates on float points
+//
+// "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric
+//  Predicates" by Jonathan Richard Shewchuk (1997)
+//
+// Every call is first evaluated in double with a forward error bound, which
+// settles almost all of them. Results inside the bound are recomputed exactly
+// with floating-point expansions. The sign is always exact, the magnitude an
+// approximation of the determinant.
+
+// Positive when a, b, c turn counter-clockwise, zero when collinear
+ENGINE_API double orient2d(const Vector<2> &a, const Vector<2> &b,
+                           const Vector<2> &c);
+
+// Positive when d is below the plane through a, b, c, below being where they
+// turn clockwise, zero when the four are coplanar. On points lifted to
+// x² + y² it has the sign of incircle
+ENGINE_API double orient3d(const Vector<3> &a, const Vector<3> &b,
+                           const Vector<3> &c, const Vector<3> &d);
+
+// Positive when d is inside the circle through the counter-clockwise a, b, c,
+// zero when the four are cocircular
+ENGINE_API double incircle(const Vector<2> &a, const Vector<2> &b,
+                           const Vector<2> &c, const Vector<2> &d);
+
+// incircle of the points lifted by their weights to x² + y² - w: positive
+// when d is below the plane through the lifted a, b, c, so it has negative
+// power to their orthogonal circle. With zero weights it is incircle
+ENGINE_API double powertest(const Vector<2> &a, float aw, const Vector<2> &b,
+                            float bw, const Vector<2> &c, float cw,
+                            const Vector<2> &d, float dw);
+
+// Where the lines ab and cd cross, compared with s in lexicographic order:
+// positive past s, or above it when on its vertical, zero on it. The lines
+// must not be parallel
+ENGINE_API double crossingOrder(const Vector<2> &a, const Vector<2> &b,
+                                const Vector<2> &c, const Vector<2> &d,
+                                const Vector<2> &s);
+
+// sides[i] = orient2d(a, b, points[i]), the filter runs two points per SSE2
+// instruction and only the uncertain ones fall back one by one
+ENGINE_API void orient2d(const Vector<2> &a, const Vector<2> &b,
+                         const Vector<2> *points, size_t count, double *sides);
+
+struct PredicateStats {
+  uint64_t calls = 0;
+  // Calls the filter could not settle
+  uint64_t exact = 0;
+
+  double fallbackRate() const { return calls ? (double)exact / calls : 0; }
+};
+
+// Summed over every thread since start, the difference of two snapshots
+// covers the work between them
+ENGINE_API PredicateStats predicateStats();
+
+} // namespace Math
+} // namespace Engine
+
+#endif // PREDICATES_HPP
@@ -0,0 +1,61 @@
+#ifndef STREAMING_HULL_HPP
+#define STREAMING_HULL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Math {
+
+// Convex hull of more points than fit in memory, fed a chunk at a time
+//
+// A chunk is cut into slices hulled in parallel on the JobSystem, each
+// through DiscardInterior and QuickHull, and their hulls are merged into the
+// running one with MergeHulls. Only the chunk being hulled and the hulls are
+// ever held, so memory is bounded by the chunk and hull sizes.
+class ENGINE_API StreamingHull {
+public:
+  void add(const Vector<2> *points, size_t count);
+  void clear();
+
+  // Counter-clockwise from the lowest x, then lowest y, as ConvexHull
+  const std::vector<Vector<2>> &hull() const { return m_hull; }
+  // Points added since the last clear
+  uint64_t count() const { return m_count; }
+
+private:
+  std::vector<Vector<2>> m_hull;
+  uint64_t m_count = 0;
+};
+
+struct StreamStats {
+  uint64_t points = 0;
+  double seconds = 0;
+  // Whether the file was memory mapped rather than read
+  bool mapped = false;
+
+  double pointsPerSecond() const { return seconds > 0 ? points / seconds : 0; }
+};
+
+// Points per chunk, 32MB
+const size_t STREAM_CHUNK = 1 << 22;
+
+// Feeds `hull` the points of a binary file of float x, y pairs in native
+// byte order, "-" for the standard input. Files are memory mapped where the
+// platform has mmap, the pages behind the current chunk dropped and the next
+// one prefetched. Otherwise they are read one chunk while the last is hulled.
+// Trailing bytes short of a point are ignored. Throws std::runtime_error when
+// the file cannot be read
+ENGINE_API StreamStats StreamHull(const std::string &path,
+                                  StreamingHull &hull,
+                                  size_t chunk = STREAM_CHUNK);
+
+} // namespace Math
+} // namespace Engine
+
+#endif // STREAMING_HULL_HPP
@@ -0,0 +1,80 @@
+#ifndef LAYER_HPP
+#define LAYER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Objects/ObjectData.hpp"
+#include "Objects/ObjectUUID.hpp"
+
+namespace Engine {
+namespace Objects {
+
+// Half open range of instances that changed since the last upload
+struct Range {
+  size_t begin = std::numeric_limits<size_t>::max();
+  size_t end = 0;
+
+  bool empty() const { return begin >= end; }
+
+  void mark(size_t from, size_t to) {
+    begin = std::min(begin, from);
+    end = std::max(end, to);
+  }
+
+  void reset() {
+    begin = std::numeric_limits<size_t>::max();
+    end = 0;
+  }
+};
+
+// A named group of objects with its own storage, upload policy and place in
+// the draw order. Inside a layer polys are drawn first, then lines, then
+// points, each in insertion order.
+struct Layer {
+  enum class Policy {
+    // Uploaded once, then sealed: changes throw until the layer is cleared
+    STATIC,
+    // Kept on the GPU, only the dirty range is re-uploaded
+    DYNAMIC,
+    // Rebuilt most frames, the whole buffer is orphaned and re-uploaded
+    STREAM,
+  };
+
+  enum Type : uint32_t {
+    POINTS = 0,
+    LINES = 1,
+    POLYS = 2,
+  };
+
+  std::string name;
+  Policy policy = Policy::DYNAMIC;
+  int32_t order = 0;
+  bool visible = true;
+  bool sealed = false;
+
+  std::vector<ObjectData> points;
+  std::vector<ObjectData> lines;
+  std::vector<PolyData> polys;
+
+  // Index -> UUID for each type, kept parallel to the storage above
+  std::vector<ObjectUUID::UUID> uuids[3];
+  Range dirty[3];
+
+  std::vector<ObjectData> &instances(uint32_t type) {
+    return type == POINTS ? points : lines;
+  }
+
+  bool empty() const {
+    return points.empty() && lines.empty() && polys.empty();
+  }
+};
+
+} // namespace Objects
+} // namespace Engine
+
+#endif // LAYER_HPP
@@ -1,7 +1,9 @@
 #ifndef OBJECTDATA_HPP
 #define OBJECTDATA_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "Math/Matrix.hpp"
 #include "Math/Vector.hpp"
@@ -42,6 +44,49 @@ struct PolyData {
   Shader *shader;
 };
 
+// A half-edge mesh as the caller holds it, uploaded without repacking
+struct MeshView {
+  const Math::Vector<2> *vertices = nullptr;
+  uint32_t vertexCount = 0;
+  // Origin, twin, next and face of every half-edge, 0xFFFFFFFF for the
+  // face outside the mesh
+  const uint32_t *halfEdges = nullptr;
+  uint32_t halfEdgeCount = 0;
+  // First half-edge of every face and its fill, faces are not filled
+  // without colors
+  const uint32_t *faces = nullptr;
+  const Math::Vector<3> *faceColors = nullptr;
+  uint32_t faceCount = 0;
+
+  Math::Vector<3> edgeColor;
+  float stroke = 1;
+};
+
+// Entries [begin, end) of one array of a MeshView
+struct MeshRange {
+  uint32_t begin;
+  uint32_t end;
+};
+
+// What changed in a MeshView since it was last uploaded, face colors follow
+// the faces
+struct MeshPatch {
+  std::vector<MeshRange> vertices;
+  std::vector<MeshRange> halfEdges;
+  std::vector<MeshRange> faces;
+};
+
+struct MeshData {
+  // Vertices, half-edges, faces and face colors, read by the shaders
+  uint32_t buffers[4];
+  // Bytes allocated for each, patches grow them twice what they need
+  size_t capacities[4];
+  uint32_t halfEdgeCount;
+  bool fill;
+  Math::Vector<3> edgeColor;
+  float stroke;
+};
+
 } // namespace Objects
 
 } // namespace Engine
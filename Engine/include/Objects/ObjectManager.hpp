@@ -1,14 +1,18 @@
 #ifndef OBJECTMANAGER_HPP
 #define OBJECTMANAGER_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <exception>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "Objects/Layer.hpp"
 #include "Objects/ObjectData.hpp"
 #include "Objects/ObjectUUID.hpp"
 
@@ -17,10 +21,14 @@ namespace Objects {
 
 class ObjectManager {
 public:
+  using LayerID = uint32_t;
+
   struct Solver {
-    virtual void operator()(size_t i, std::vector<ObjectData> &data,
-                            bool update) = 0;
-    virtual void operator()(std::vector<PolyData> &data, bool update) = 0;
+    virtual ~Solver() = default;
+
+    // Uploads the dirty ranges of the layer, following its policy, and draws
+    // it. `id` is stable for the lifetime of the layer.
+    virtual void operator()(LayerID id, Layer &layer) = 0;
 
     virtual uint32_t getDrawCalls() = 0;
   };
@@ -37,142 +45,181 @@ public:
     POLY,
   };
 
+  inline static const LayerID DEFAULT_LAYER = 0;
+
+  ObjectManager() { createLayer("default", Layer::Policy::DYNAMIC, 0); }
+
   void draw() {
-    (*solver)(0, data.points, data.update[0]);
-    data.update[0] = false;
-    (*solver)(1, data.lines, data.update[1]);
-    data.update[1] = false;
-    (*solver)(data.polys, data.update[2]);
-    data.update[2] = false;
+    for (LayerID id : m_drawOrder) {
+      Layer &layer = m_layers[id];
+      if (!layer.visible)
+        continue;
+
+      (*solver)(id, layer);
+
+      for (auto &range : layer.dirty)
+        range.reset();
+      if (layer.policy == Layer::Policy::STATIC && !layer.empty())
+        layer.sealed = true;
+    }
+
     m_drawCalls = solver->getDrawCalls();
   }
 
   void deleteBuffers(int n, uint32_t *buffs) { glDeleteBuffers(n, buffs); }
   void deleteVAO(int n, uint32_t *buffs) { glDeleteVertexArrays(n, buffs); }
 
-  void clear() {
-    data.points.clear();
-    data.lines.clear();
-    data.polys.clear();
+  LayerID createLayer(const std::string &name, Layer::Policy policy,
+                      int32_t order) {
+    if (findLayer(name))
+      throw std::runtime_error("Layer \"" + name + "\" already exists");
+
+    LayerID id = m_layers.size();
+    Layer &layer = m_layers.emplace_back();
+    layer.name = name;
+    layer.policy = policy;
+    layer.order = order;
 
-    data.uuid2ii.clear();
-    data.ii2uuid.clear();
+    m_drawOrder.push_back(id);
+    sortLayers();
+    return id;
+  }
+
+  std::optional<LayerID> findLayer(const std::string &name) const {
+    for (LayerID id = 0; id < m_layers.size(); id++) {
+      if (m_layers[id].name == name)
+        return id;
+    }
+
+    return std::nullopt;
+  }
+
+  const Layer &layer(LayerID id) const { return m_layers.at(id); }
 
-    data.update[0] = true;
-    data.update[1] = true;
-    data.update[2] = true;
+  // New objects are added to the active layer
+  void setActiveLayer(LayerID id) {
+    m_layers.at(id);
+    m_active = id;
+  }
+  LayerID activeLayer() const { return m_active; }
+
+  void setLayerVisible(LayerID id, bool visible) {
+    Layer &layer = m_layers.at(id);
+    if (layer.visible == visible)
+      return;
+
+    layer.visible = visible;
+    m_generation++;
+  }
+
+  void setLayerOrder(LayerID id, int32_t order) {
+    Layer &layer = m_layers.at(id);
+    if (layer.order == order)
+      return;
+
+    layer.order = order;
+    sortLayers();
+    m_generation++;
+  }
+
+  // Drops every object of the layer, unsealing it if it was static
+  void clearLayer(LayerID id) {
+    Layer &layer = m_layers.at(id);
+
+    for (uint32_t type = 0; type < 3; type++) {
+      for (auto uuid : layer.uuids[type]) {
+        m_locations.erase(uuid);
+        this->uuid.remove(uuid);
+      }
+      layer.uuids[type].clear();
+      layer.dirty[type].reset();
+    }
+
+    m_count.points -= layer.points.size();
+    m_count.lines -= layer.lines.size();
+    m_count.polys -= layer.polys.size();
+
+    layer.points.clear();
+    layer.lines.clear();
+    layer.polys.clear();
+    layer.sealed = false;
+    m_generation++;
+  }
+
+  void clear() {
+    for (auto &layer : m_layers) {
+      layer.points.clear();
+      layer.lines.clear();
+      layer.polys.clear();
+      layer.sealed = false;
+
+      for (uint32_t type = 0; type < 3; type++) {
+        layer.uuids[type].clear();
+        layer.dirty[type].reset();
+      }
+    }
+
+    m_locations.clear();
 
     uuid.reset();
+    m_generation++;
     m_count.points = 0;
     m_count.lines = 0;
     m_count.polys = 0;
   }
 
   uint32_t drawCalls() { return m_drawCalls; }
-  uint32_t entities() { return data.uuid2ii.size(); }
+  uint32_t entities() { return m_locations.size(); }
+  // Bumped on every change that can alter what is drawn
+  uint64_t generation() { return m_generation; }
   ObjectCount count() { return m_count; }
 
-  int type(ObjectUUID::UUID id) { return data.uuid2ii[id].first; }
+  int type(ObjectUUID::UUID id) { return m_locations[id].type; }
 
   void remove(ObjectUUID::UUID id) {
-    std::pair<uint32_t, uint32_t> ii = data.uuid2ii.at(id);
+    Location loc = m_locations.at(id);
+    Layer &layer = mutableLayer(loc.layer);
 
-    std::pair<uint32_t, uint32_t> iiTemp[2];
-    switch (ii.first) {
-    case 0:
+    switch (loc.type) {
+    case Layer::POINTS:
       m_count.points -= 1;
-      iiTemp[0].first = 0;
-      iiTemp[1].first = 0;
-      for (size_t i = ii.second + 1; i < data.points.size(); i++) {
-        iiTemp[0].second = i;
-        iiTemp[1].second = i - 1;
-
-        uint32_t uuidOld = data.ii2uuid.at(iiTemp[0]);
-        data.ii2uuid.erase(iiTemp[0]);
-
-        data.uuid2ii[uuidOld] = iiTemp[1];
-        data.ii2uuid.emplace(iiTemp[1], uuidOld);
-      }
-
-      data.points.erase(std::next(data.points.begin(), ii.second));
+      layer.points.erase(std::next(layer.points.begin(), loc.index));
       break;
-
-    case 1:
+    case Layer::LINES:
       m_count.lines -= 1;
-      iiTemp[0].first = 1;
-      iiTemp[1].first = 1;
-      for (size_t i = ii.second + 1; i < data.lines.size(); i++) {
-        iiTemp[0].second = i;
-        iiTemp[1].second = i - 1;
-
-        uint32_t uuidOld = data.ii2uuid.at(iiTemp[0]);
-        data.ii2uuid.erase(iiTemp[0]);
-
-        data.uuid2ii[uuidOld] = iiTemp[1];
-        data.ii2uuid.emplace(iiTemp[1], uuidOld);
-      }
-
-      data.lines.erase(std::next(data.lines.begin(), ii.second));
+      layer.lines.erase(std::next(layer.lines.begin(), loc.index));
       break;
-    case 2:
+    case Layer::POLYS:
       m_count.polys -= 1;
-      iiTemp[0].first = 2;
-      iiTemp[1].first = 2;
-      for (size_t i = ii.second + 1; i < data.polys.size(); i++) {
-        iiTemp[0].second = i;
-        iiTemp[1].second = i - 1;
-
-        uint32_t uuidOld = data.ii2uuid.at(iiTemp[0]);
-        data.ii2uuid.erase(iiTemp[0]);
-
-        data.uuid2ii[uuidOld] = iiTemp[1];
-        data.ii2uuid.emplace(iiTemp[1], uuidOld);
-      }
-
-      data.polys.erase(std::next(data.polys.begin(), ii.second));
+      layer.polys.erase(std::next(layer.polys.begin(), loc.index));
       break;
     }
 
-    data.ii2uuid.erase(ii);
-    data.uuid2ii.erase(id);
+    // Everything after the removed object slides down one slot
+    std::vector<ObjectUUID::UUID> &uuids = layer.uuids[loc.type];
+    uuids.erase(std::next(uuids.begin(), loc.index));
+    for (size_t i = loc.index; i < uuids.size(); i++) {
+      m_locations[uuids[i]].index = i;
+    }
+    layer.dirty[loc.type].mark(loc.index, uuids.size());
+
+    m_locations.erase(id);
     uuid.remove(id);
+    m_generation++;
   }
 
   ObjectUUID::UUID add(Types type, ObjectData &&data) {
+    ObjectUUID::UUID id;
     switch (type) {
-    case Types::POINT: {
+    case Types::POINT:
+      id = insert(Layer::POINTS, std::move(data));
       m_count.points += 1;
-      ObjectUUID::UUID id = this->uuid.get();
-      data.uuid = id;
-
-      size_t type = 0;
-      size_t i = this->data.points.size();
-      this->data.points.push_back(data);
-      this->data.update[type] = true;
-
-      std::pair<uint32_t, uint32_t> ii = std::make_pair(type, i);
-      this->data.uuid2ii.emplace(id, ii);
-      this->data.ii2uuid.emplace(ii, id);
-
       return id;
-    } break;
 
-    case Types::LINE: {
+    case Types::LINE:
+      id = insert(Layer::LINES, std::move(data));
       m_count.lines += 1;
-      ObjectUUID::UUID id = this->uuid.get();
-      data.uuid = id;
-
-      size_t type = 1;
-      size_t i = this->data.lines.size();
-      this->data.lines.push_back(data);
-      this->data.update[type] = true;
-
-      std::pair<uint32_t, uint32_t> ii = std::make_pair(type, i);
-      this->data.uuid2ii.emplace(id, ii);
-      this->data.ii2uuid.emplace(ii, id);
-
       return id;
-    } break;
 
     default:
       break;
@@ -182,51 +229,54 @@ public:
   }
 
   ObjectUUID::UUID add(PolyData &&data) {
+    Layer &layer = mutableLayer(m_active);
     m_count.polys += 1;
+
     ObjectUUID::UUID id = this->uuid.get();
     data.uuid = id;
 
-    size_t type = 2;
-    size_t i = this->data.polys.size();
-    this->data.polys.push_back(data);
-    this->data.update[type] = true;
-
-    std::pair<uint32_t, uint32_t> ii = std::make_pair(type, i);
-    this->data.uuid2ii.emplace(id, ii);
-    this->data.ii2uuid.emplace(ii, id);
+    uint32_t i = layer.polys.size();
+    layer.polys.push_back(data);
+    layer.uuids[Layer::POLYS].push_back(id);
+    layer.dirty[Layer::POLYS].mark(i, i + 1);
+    m_locations.emplace(id, Location{m_active, Layer::POLYS, i});
+    m_generation++;
 
     return id;
   }
 
   std::variant<const PolyData *, const ObjectData *>
   cget(ObjectUUID::UUID &id) {
-    if (data.uuid2ii.contains(id)) {
-      auto &ii = data.uuid2ii.at(id);
-
-      switch (ii.first) {
-      case 0:
-        return &data.points.at(ii.second);
-      case 1:
-        return &data.lines.at(ii.second);
-      case 2:
-        return &data.polys.at(ii.second);
+    if (m_locations.contains(id)) {
+      Location &loc = m_locations.at(id);
+      Layer &layer = m_layers[loc.layer];
+
+      switch (loc.type) {
+      case Layer::POINTS:
+        return &layer.points.at(loc.index);
+      case Layer::LINES:
+        return &layer.lines.at(loc.index);
+      case Layer::POLYS:
+        return &layer.polys.at(loc.index);
       }
     }
     return (ObjectData *)nullptr;
   }
 
   std::variant<PolyData *, ObjectData *> get(ObjectUUID::UUID &id) {
-    if (data.uuid2ii.contains(id)) {
-      auto &ii = data.uuid2ii.at(id);
-      data.update[ii.first] = true;
-
-      switch (ii.first) {
-      case 0:
-        return &data.points.at(ii.second);
-      case 1:
-        return &data.lines.at(ii.second);
-      case 2:
-        return &data.polys.at(ii.second);
+    if (m_locations.contains(id)) {
+      Location &loc = m_locations.at(id);
+      Layer &layer = mutableLayer(loc.layer);
+      layer.dirty[loc.type].mark(loc.index, loc.index + 1);
+      m_generation++;
+
+      switch (loc.type) {
+      case Layer::POINTS:
+        return &layer.points.at(loc.index);
+      case Layer::LINES:
+        return &layer.lines.at(loc.index);
+      case Layer::POLYS:
+        return &layer.polys.at(loc.index);
       }
     }
     return (ObjectData *)nullptr;
@@ -235,32 +285,56 @@ public:
   void setSolver(Solver *solver) { this->solver.reset(solver); }
 
 private:
-  std::unique_ptr<Solver> solver = nullptr;
-  ObjectUUID uuid;
-
-  struct IIHash {
-    std::size_t operator()(const std::pair<uint32_t, uint32_t> &id) const {
-      // A common way to combine two hashes
-      std::size_t hash1 = std::hash<uint32_t>{}(id.first);
-      std::size_t hash2 = std::hash<uint32_t>{}(id.second);
-      // Combine them using a bit shift and XOR
-      return hash1 ^ (hash2 << 1);
-    }
+  struct Location {
+    LayerID layer;
+    uint32_t type;
+    uint32_t index;
   };
 
-  struct __Data {
-    std::vector<ObjectData> points;
-    std::vector<ObjectData> lines;
-    std::vector<PolyData> polys;
+  // Static layers are immutable once uploaded
+  Layer &mutableLayer(LayerID id) {
+    Layer &layer = m_layers.at(id);
+    if (layer.sealed)
+      throw std::runtime_error("Layer \"" + layer.name +
+                               "\" is static and already uploaded");
 
-    std::unordered_map<ObjectUUID::UUID, std::pair<uint32_t, uint32_t>> uuid2ii;
-    std::unordered_map<std::pair<uint32_t, uint32_t>, ObjectUUID::UUID, IIHash>
-        ii2uuid;
+    return layer;
+  }
+
+  ObjectUUID::UUID insert(uint32_t type, ObjectData &&data) {
+    Layer &layer = mutableLayer(m_active);
+
+    ObjectUUID::UUID id = this->uuid.get();
+    data.uuid = id;
+
+    std::vector<ObjectData> &instances = layer.instances(type);
+    uint32_t i = instances.size();
+    instances.push_back(data);
+    layer.uuids[type].push_back(id);
+    layer.dirty[type].mark(i, i + 1);
+    m_locations.emplace(id, Location{m_active, type, i});
+    m_generation++;
+
+    return id;
+  }
+
+  void sortLayers() {
+    std::stable_sort(m_drawOrder.begin(), m_drawOrder.end(),
+                     [this](LayerID a, LayerID b) {
+                       return m_layers[a].order < m_layers[b].order;
+                     });
+  }
+
+  std::unique_ptr<Solver> solver = nullptr;
+  ObjectUUID uuid;
 
-    bool update[3] = {true, true, true};
-  } data;
+  std::vector<Layer> m_layers;
+  std::vector<LayerID> m_drawOrder;
+  LayerID m_active = DEFAULT_LAYER;
+  std::unordered_map<ObjectUUID::UUID, Location> m_locations;
 
   uint32_t m_drawCalls;
+  uint64_t m_generation = 0;
   ObjectCount m_count;
 };
 } // namespace Objects
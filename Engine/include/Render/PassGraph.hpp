@@ -0,0 +1,90 @@
+#ifndef RENDER_PASSGRAPH_HPP
+#define RENDER_PASSGRAPH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "engine_api.hpp"
+
+namespace Engine {
+namespace Render {
+
+// Resources a pass can read from or write to. BACKBUFFER is the default
+// framebuffer, the others live in the engine's offscreen FBO.
+enum Resource : uint32_t {
+  NONE = 0,
+  BACKBUFFER = 1 << 0,
+  SCENE_COLOR = 1 << 1,
+  OBJECT_ID = 1 << 2,
+};
+
+class ENGINE_API PassGraph {
+public:
+  struct Frame {
+    // Maps the resources a pass writes to the ones that really back them
+    // this frame, e.g. SCENE_COLOR -> BACKBUFFER when the copy was elided.
+    uint32_t resolve(uint32_t resources) const;
+
+    uint32_t aliased = NONE;
+  };
+
+  struct Pass {
+    std::string name;
+    uint32_t reads = NONE;
+    uint32_t writes = NONE;
+
+    // A copy pass only moves its reads into its writes, so it is dropped
+    // whenever nothing else consumes the source and the source can be
+    // rendered directly into the destination instead.
+    bool copy = false;
+
+    std::function<bool()> enabled = nullptr;
+    std::function<void(const Frame &)> execute;
+  };
+
+  struct Timing {
+    std::string name;
+    double cpuMs = 0;
+    double gpuMs = 0;
+    bool ran = false;
+  };
+
+  PassGraph() = default;
+  ~PassGraph();
+
+  PassGraph(const PassGraph &) = delete;
+  PassGraph &operator=(const PassGraph &) = delete;
+
+  void addPass(Pass pass);
+  bool removePass(const std::string &name);
+  Pass *find(const std::string &name);
+
+  // Runs every pass needed to produce `sinks`, in registration order.
+  void execute(uint32_t sinks);
+
+  const std::vector<Timing> &timings() const { return m_timings; }
+
+private:
+  using Clock = std::chrono::high_resolution_clock;
+
+  struct Query {
+    uint32_t id[2] = {0, 0};
+    bool pending[2] = {false, false};
+  };
+
+  std::vector<bool> cull(uint32_t sinks, Frame &frame) const;
+  void collectGpuTime(size_t i);
+
+  std::vector<Pass> m_passes;
+  std::vector<Timing> m_timings;
+  std::vector<Query> m_queries;
+  uint32_t m_parity = 0;
+};
+
+} // namespace Render
+} // namespace Engine
+
+#endif // RENDER_PASSGRAPH_HPP
@@ -1,11 +1,13 @@
 #ifndef INSTANCED_HPP
 #define INSTANCED_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
 
+#include "Objects/Layer.hpp"
 #include "Objects/ObjectData.hpp"
 #include "Objects/ObjectManager.hpp"
 #include "Objects/ObjectVAO.hpp"
@@ -14,7 +16,13 @@ namespace Engine {
 namespace Solver {
 class Instanced : public Objects::ObjectManager::Solver {
 public:
-  Instanced() { glGenBuffers(3, VBO); }
+  Instanced() = default;
+
+  ~Instanced() {
+    for (auto &buffers : m_buffers) {
+      glDeleteBuffers(2, buffers.VBO);
+    }
+  }
 
   uint32_t getDrawCalls() override {
     uint32_t d = m_drawCalls;
@@ -22,25 +30,87 @@ public:
     return d;
   }
 
-  void operator()(size_t type, std::vector<Objects::ObjectData> &data,
-                  bool update) override {
-    const uint32_t amount = data.size();
+  void operator()(Objects::ObjectManager::LayerID id,
+                  Objects::Layer &layer) override {
+    if (id >= m_buffers.size()) {
+      m_buffers.resize(id + 1);
+    }
 
-    if (amount == 0) {
-      return;
+    Buffers &buffers = m_buffers[id];
+
+    // Painter's order: later draws end up on top
+    draw(layer.polys);
+    for (uint32_t type : {Objects::Layer::LINES, Objects::Layer::POINTS}) {
+      upload(buffers, type, layer);
+      draw(buffers.VBO[type], layer.instances(type));
     }
+  }
 
-    glBindVertexArray(Objects::ObjectVAO::get());
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[type]);
+private:
+  struct Buffers {
+    uint32_t VBO[2] = {0, 0};
+    size_t capacity[2] = {0, 0};
+  };
+
+  void upload(Buffers &buffers, uint32_t type, Objects::Layer &layer) {
+    std::vector<Objects::ObjectData> &data = layer.instances(type);
+    Objects::Range &dirty = layer.dirty[type];
+    const size_t stride = sizeof(Objects::ObjectData);
+    const size_t size = data.size() * stride;
+
+    if (!buffers.VBO[type]) {
+      glGenBuffers(1, &buffers.VBO[type]);
+    }
 
-    if (update) {
-      const uint32_t size = amount * sizeof(data[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO[type]);
 
-      if (this->size < size) {
+    switch (layer.policy) {
+    case Objects::Layer::Policy::STATIC:
+      // Uploaded exactly once, the layer is sealed right after
+      if (!layer.sealed && size) {
         glBufferData(GL_ARRAY_BUFFER, size, data.data(), GL_STATIC_DRAW);
+        buffers.capacity[type] = size;
+      }
+      break;
+
+    case Objects::Layer::Policy::DYNAMIC:
+      if (buffers.capacity[type] < size) {
+        buffers.capacity[type] = std::max(size, buffers.capacity[type] * 2);
+        glBufferData(GL_ARRAY_BUFFER, buffers.capacity[type], nullptr,
+                     GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data.data());
+      } else if (!dirty.empty()) {
+        size_t end = std::min(dirty.end, data.size());
+        if (dirty.begin < end) {
+          glBufferSubData(GL_ARRAY_BUFFER, dirty.begin * stride,
+                          (end - dirty.begin) * stride, &data[dirty.begin]);
+        }
+      }
+      break;
+
+    case Objects::Layer::Policy::STREAM:
+      // Orphan the old storage so the driver does not wait on it
+      if (!dirty.empty() || buffers.capacity[type] < size) {
+        buffers.capacity[type] = std::max(size, buffers.capacity[type]);
+        glBufferData(GL_ARRAY_BUFFER, buffers.capacity[type], nullptr,
+                     GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data.data());
       }
+      break;
     }
 
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  void draw(uint32_t VBO, std::vector<Objects::ObjectData> &data) {
+    const uint32_t amount = data.size();
+
+    if (amount == 0) {
+      return;
+    }
+
+    glBindVertexArray(Objects::ObjectVAO::get());
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
     size_t stride = sizeof(data[0]);
     size_t offset = 0;
     size_t loc = 1;
@@ -87,18 +157,13 @@ public:
     glBindVertexArray(0);
   }
 
-  void operator()(std::vector<Objects::PolyData> &polys, bool update) override {
-    if (polys.empty()) {
-      return;
-    }
-
+  void draw(std::vector<Objects::PolyData> &polys) {
     for (size_t i = 0; i < polys.size(); i++) {
       Objects::PolyData &poly = polys[i];
 
       glBindVertexArray(poly.VAO);
       poly.shader->bind();
 
-      poly.shader->set("Z", static_cast<float>(i) / polys.size());
       poly.shader->set("UUID", poly.uuid);
       poly.shader->set("fillColor", poly.color);
       poly.shader->set("borderColor", poly.borderColor);
@@ -111,9 +176,7 @@ public:
     }
   }
 
-private:
-  uint32_t VBO[3];
-  uint32_t size = 0;
+  std::vector<Buffers> m_buffers;
   uint32_t m_drawCalls = 0;
 };
 
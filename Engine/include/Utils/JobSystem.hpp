@@ -0,0 +1,148 @@
+#ifndef UTILS_JOBSYSTEM_HPP
+#define UTILS_JOBSYSTEM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engine_api.hpp"
+
+// Fixed pool of workers, each owning a Chase-Lev deque. Owners push and pop
+// at the bottom, idle workers steal from the top of the others. Threads
+// waiting on a counter keep running jobs instead of blocking, so jobs may
+// submit and wait on more jobs.
+class ENGINE_API JobSystem {
+public:
+  using Job = std::function<void()>;
+
+  // Number of jobs still running, shared by the jobs submitted with it
+  class Counter {
+  public:
+    bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+  private:
+    friend class JobSystem;
+    std::atomic<size_t> m_pending = 0;
+
+    // First exception thrown by one of the jobs, rethrown by wait()
+    std::atomic<bool> m_failed = false;
+    std::exception_ptr m_error = nullptr;
+  };
+
+  struct Stats {
+    // Busy fraction of each worker since the previous call, main thread first
+    std::vector<double> utilisation;
+    uint64_t executed = 0;
+    uint64_t stolen = 0;
+  };
+
+  static JobSystem &get();
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // Background workers, the main thread also runs jobs while it waits
+  size_t workers() const;
+
+  void submit(Job job, Counter *counter = nullptr);
+  void wait(Counter &counter);
+
+  // Splits [begin, end) in chunks of at least `grain` indices and waits for
+  // all of them
+  void parallelFor(size_t begin, size_t end, size_t grain,
+                   const std::function<void(size_t, size_t)> &body);
+
+  // GL and other main-thread-only work, executed by pumpMainThread()
+  void runOnMainThread(Job job);
+  void pumpMainThread();
+  bool hasMainThreadWork();
+  bool isMainThread() const;
+  // Makes the calling thread the main one and gives it slot 0. Done by the
+  // Window on construction, throws when another thread was bound before
+  void bindMainThread();
+  // Called after queueing main-thread work, e.g. to wake an event loop
+  void setMainThreadWake(std::function<void()> wake);
+
+  Stats stats();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Task {
+    Job job;
+    Counter *counter;
+  };
+
+  class Deque;
+
+  struct Worker {
+    std::unique_ptr<Deque> deque;
+    std::thread thread;
+    std::atomic<uint64_t> busyNs = 0;
+  };
+
+  JobSystem();
+  ~JobSystem();
+
+  void loop(size_t index);
+  bool runOne(size_t index);
+  Task *find(size_t index);
+  void execute(size_t index, Task *task);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<std::thread::id> m_mainThread;
+  std::atomic<bool> m_running = true;
+
+  // Submissions from threads that are not part of the pool
+  std::mutex m_injectMutex;
+  std::deque<Task *> m_inject;
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleep;
+  std::atomic<int64_t> m_queued = 0;
+  std::atomic<size_t> m_sleeping = 0;
+
+  std::mutex m_mainMutex;
+  std::vector<Job> m_mainJobs;
+  std::function<void()> m_mainWake;
+
+  std::atomic<uint64_t> m_executed = 0;
+  std::atomic<uint64_t> m_stolen = 0;
+  Clock::time_point m_statsStart;
+};
+
+// Jobs with dependencies, run on the JobSystem. A task starts once every
+// task preceding it has finished.
+class ENGINE_API TaskGraph {
+public:
+  using TaskID = size_t;
+
+  TaskID add(JobSystem::Job job);
+  void precede(TaskID before, TaskID after);
+
+  // Blocks, running jobs, until every task finished. Throws on cycles.
+  void run();
+
+private:
+  struct Node {
+    JobSystem::Job job;
+    std::vector<TaskID> successors;
+    size_t dependencies = 0;
+    std::atomic<size_t> remaining = 0;
+  };
+
+  void schedule(TaskID id, JobSystem::Counter &counter);
+
+  std::deque<Node> m_nodes;
+};
+
+#endif // UTILS_JOBSYSTEM_HPP
@@ -0,0 +1,186 @@
+#ifndef UTILS_PIPELINE_HPP
+#define UTILS_PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// Latest-wins background computation for work too slow for a frame. Every
+// submit() starts a new generation and cancels the one before: the running
+// job notices at its next checkpoint and unwinds. Results, partial or
+// complete, wait for poll() on the main thread; those of an old generation
+// are dropped.
+//
+// One dedicated thread, so the job may still use the JobSystem without
+// taking one of its workers for the whole computation.
+template <typename Result> class Pipeline {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Thrown by checkpoint() once a newer submit() superseded the job
+  struct Cancelled {};
+
+  class Task {
+  public:
+    uint64_t generation() const { return m_generation; }
+    bool cancelled() const {
+      return m_pipeline.m_generation.load(std::memory_order_acquire) !=
+             m_generation;
+    }
+    void checkpoint() const {
+      if (cancelled())
+        throw Cancelled{};
+    }
+    // Shown until a newer partial or the complete result replaces it
+    void publish(Result partial) {
+      m_pipeline.deliver(m_generation, m_submitted, std::move(partial), false);
+    }
+
+  private:
+    friend class Pipeline;
+    Task(Pipeline &pipeline, uint64_t generation, Clock::time_point submitted)
+        : m_pipeline(pipeline), m_generation(generation),
+          m_submitted(submitted) {}
+
+    Pipeline &m_pipeline;
+    uint64_t m_generation;
+    Clock::time_point m_submitted;
+  };
+
+  using Job = std::function<Result(Task &)>;
+
+  struct Output {
+    Result result;
+    uint64_t generation = 0;
+    bool complete = false;
+    // Seconds from submit() to the poll() that returned it
+    double latency = 0;
+  };
+
+  Pipeline() : m_thread([this]() { loop(); }) {}
+
+  ~Pipeline() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_running = false;
+      m_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    m_wake.notify_one();
+    m_thread.join();
+  }
+
+  Pipeline(const Pipeline &) = delete;
+  Pipeline &operator=(const Pipeline &) = delete;
+
+  // Returns the generation of `job`
+  uint64_t submit(Job job) {
+    uint64_t generation;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      generation = m_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+      m_pending = std::move(job);
+      m_pendingSubmitted = Clock::now();
+      m_output.reset();
+      // Thrown by a job this one supersedes
+      m_error = nullptr;
+    }
+    m_wake.notify_one();
+    return generation;
+  }
+
+  // The newest output since the last call, if any. Rethrows what the job of
+  // the current generation threw
+  std::optional<Output> poll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error) {
+      std::exception_ptr error = m_error;
+      m_error = nullptr;
+      std::rethrow_exception(error);
+    }
+
+    std::optional<Output> output = std::move(m_output);
+    m_output.reset();
+    if (output) {
+      output->latency =
+          std::chrono::duration<double>(Clock::now() - m_outputSubmitted)
+              .count();
+    }
+    return output;
+  }
+
+  // A job is queued or running
+  bool busy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending || m_active;
+  }
+
+private:
+  void loop() {
+    while (true) {
+      Job job;
+      uint64_t generation;
+      Clock::time_point submitted;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this]() { return !m_running || m_pending; });
+        if (!m_running)
+          return;
+
+        job = std::move(m_pending);
+        m_pending = nullptr;
+        generation = m_generation.load(std::memory_order_acquire);
+        submitted = m_pendingSubmitted;
+        m_active = true;
+      }
+
+      Task task(*this, generation, submitted);
+      try {
+        Result result = job(task);
+        deliver(generation, submitted, std::move(result), true);
+      } catch (const Cancelled &) {
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation == m_generation.load(std::memory_order_acquire))
+          m_error = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_active = false;
+    }
+  }
+
+  void deliver(uint64_t generation, Clock::time_point submitted,
+               Result result, bool complete) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation != m_generation.load(std::memory_order_acquire))
+      return;
+
+    m_output = Output{std::move(result), generation, complete, 0};
+    m_outputSubmitted = submitted;
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_running = true;
+  bool m_active = false;
+
+  // Generation of the newest submit(), older jobs are cancelled
+  std::atomic<uint64_t> m_generation = 0;
+  Job m_pending;
+  Clock::time_point m_pendingSubmitted;
+
+  std::optional<Output> m_output;
+  Clock::time_point m_outputSubmitted;
+  std::exception_ptr m_error = nullptr;
+
+  // Last, it starts running in the constructor
+  std::thread m_thread;
+};
+
+#endif // UTILS_PIPELINE_HPP
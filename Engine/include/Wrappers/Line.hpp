@@ -41,6 +41,8 @@ public:
       updateColor(*data);
   }
 
+  Objects::ObjectUUID::UUID getID() { return m_id; }
+
   void setVerts(Math::Vector<2> pos0, Math::Vector<2> pos1) {
     if (pos0 == std::get<0>(m_verts) && pos1 == std::get<1>(m_verts))
       return;
@@ -94,6 +94,7 @@ public:
   }
 
   const std::vector<Math::Vector<2>> &getVerts() { return m_verts; }
+  Objects::ObjectUUID::UUID getID() { return m_id; }
   const std::vector<uint32_t> &getIndices() { return m_indices; }
 
   void removeVert(size_t i) {
@@ -4,11 +4,16 @@
 #include <cstdint>
 #include <glad/glad.h>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 #include "Math/Vector.hpp"
+#include "Objects/Layer.hpp"
 #include "Objects/ObjectManager.hpp"
 
 #include "Objects/ObjectUUID.hpp"
+#include "Render/PassGraph.hpp"
 #include "Wrappers/Line.hpp"
 #include "Wrappers/Point.hpp"
 #include "Wrappers/Poly.hpp"
@@ -19,6 +24,8 @@ namespace Engine {
 // Singleton
 class ENGINE_API Engine {
 public:
+  using LayerID = Objects::ObjectManager::LayerID;
+
   static Engine *init(GLADloadproc proc, Math::Vector<2, uint32_t> &windowSize);
   static Engine *get();
 
@@ -27,7 +34,10 @@ public:
   void update(double dt);
   void draw();
 
+  // Renders the ID pass on demand when the ID buffer is older than the scene
   Objects::ObjectUUID::UUID lookupObjectUUID(int x, int y);
+  // Also refresh the ID buffer every `frames` draws (0 = only on lookup)
+  void setPickInterval(uint32_t frames);
   int getType(Objects::ObjectUUID::UUID id);
 
   std::variant<Objects::PolyData *, Objects::ObjectData *>
@@ -45,6 +55,31 @@ public:
   void remove(Objects::ObjectUUID::UUID id);
   void clear();
 
+  // Layers are drawn by ascending order, new objects go to the active one
+  LayerID createLayer(const std::string &name, Objects::Layer::Policy policy,
+                      int32_t order);
+  std::optional<LayerID> findLayer(const std::string &name);
+  void useLayer(LayerID layer);
+  void clearLayer(LayerID layer);
+  void setLayerVisible(LayerID layer, bool visible);
+  void setLayerOrder(LayerID layer, int32_t order);
+
+  // RGBA8 image stretched over the window under every object, rows bottom
+  // to top. Uploaded once, drawn with a blit each frame
+  void setBackground(const uint8_t *rgba, uint32_t width, uint32_t height);
+  void clearBackground();
+
+  // Half-edge mesh drawn under the objects in one call for all its faces and
+  // one for all its edges. The arrays are uploaded as they are and the
+  // shaders walk them, nothing is built per face or per edge
+  uint32_t createMesh(const Objects::MeshView &view);
+  void updateMesh(uint32_t id, const Objects::MeshView &view);
+  // Uploads only the ranges of the arrays in `patch`, the view holds every
+  // entry. Arrays may grow, a buffer they outgrow is uploaded whole
+  void patchMesh(uint32_t id, const Objects::MeshView &view,
+                 const Objects::MeshPatch &patch);
+  void removeMesh(uint32_t id);
+
   void setWinSize(Math::Vector<2, float> m_windowSize);
 
   Math::Vector<2, uint32_t> winSize();
@@ -56,9 +91,21 @@ public:
   uint32_t entities();
   Objects::ObjectManager::ObjectCount count();
 
+  // CPU and GPU time of every pass in timings()
+  Render::PassGraph &passGraph();
+  uint32_t sceneColorTexture();
+
 private:
   Engine() = default;
 
+  void setupPasses();
+  void bindTarget(uint32_t resources);
+  void drawBackground();
+  void drawScene();
+  void drawMeshes();
+  // Changes with anything the ID pass draws
+  uint64_t sceneGeneration();
+
   // Variables
 
 public:
@@ -74,6 +121,22 @@ private:
   uint32_t m_colorTextureID = 0;
   uint32_t m_idTextureID = 0;
   uint32_t m_rboDepthStencil = 0;
+
+  uint32_t m_backgroundFboID = 0;
+  uint32_t m_backgroundTextureID = 0;
+  uint32_t m_backgroundWidth = 0;
+  uint32_t m_backgroundHeight = 0;
+
+  std::unordered_map<uint32_t, Objects::MeshData> m_meshes;
+  uint32_t m_nextMeshID = 1;
+  uint32_t m_meshDrawCalls = 0;
+  // Bumped by every mesh change, the objects count their own
+  uint64_t m_meshGeneration = 0;
+
+  Render::PassGraph m_passGraph;
+  std::optional<uint64_t> m_idGeneration = std::nullopt;
+  uint32_t m_pickInterval = 0;
+  uint64_t m_frame = 0;
 };
 
 } // namespace Engine
@@ -0,0 +1,485 @@
+#include "Math/DynamicHull.hpp"
+
+#include "Math/Predicates.hpp"
+
+#include <algorithm>
+
+namespace Engine {
+namespace Math {
+
+namespace {
+
+using Vec2 = Vector<2>;
+
+bool Less(const Vec2 &a, const Vec2 &b) {
+  return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+
+// direction . (to - from)
+double Along(const Vec2 &direction, const Vec2 &from, const Vec2 &to) {
+  return (double)direction[0] * ((double)to[0] - from[0]) +
+         (double)direction[1] * ((double)to[1] - from[1]);
+}
+
+} // namespace
+
+void DynamicHull::assign(std::vector<Vec2> points) {
+  clear();
+  std::sort(points.begin(), points.end(), Less);
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  if (points.empty())
+    return;
+
+  m_nodes.reserve(2 * points.size() - 1);
+  m_root = build(points, 0, points.size());
+  m_size = points.size();
+
+  // Around the hull from its lowest leaf, always a vertex
+  uint32_t first = m_nodes[m_root].end[0], v = first;
+  do {
+    uint32_t prev, next;
+    neighbours(v, prev, next);
+    link(v, next);
+    v = next;
+  } while (v != first);
+}
+
+void DynamicHull::clear() {
+  m_nodes.clear();
+  m_free.clear();
+  m_root = NONE;
+  m_size = 0;
+}
+
+uint32_t DynamicHull::insert(const Vec2 &point, Changes *changes) {
+  if (changes) {
+    changes->removed.clear();
+    changes->added.clear();
+  }
+
+  uint32_t id;
+  if (m_root == NONE) {
+    id = allocate();
+    m_nodes[id].point = point;
+    m_nodes[id].end[0] = m_nodes[id].end[1] = id;
+    m_root = id;
+  } else {
+    uint32_t v = m_root;
+    while (!leaf(v)) {
+      uint32_t right = m_nodes[v].child[1];
+      v = m_nodes[v].child[!Less(point, m_nodes[m_nodes[right].end[0]].point)];
+    }
+    if (m_nodes[v].point == point)
+      return NONE;
+
+    id = allocate();
+    uint32_t inner = allocate();
+    m_nodes[id].point = point;
+    m_nodes[id].end[0] = m_nodes[id].end[1] = id;
+
+    // The new inner node takes the place of the leaf it was found at
+    uint32_t parent = m_nodes[v].parent;
+    bool after = Less(m_nodes[v].point, point);
+    m_nodes[inner].child[0] = after ? v : id;
+    m_nodes[inner].child[1] = after ? id : v;
+    m_nodes[inner].parent = parent;
+    m_nodes[v].parent = m_nodes[id].parent = inner;
+    if (parent == NONE)
+      m_root = inner;
+    else
+      m_nodes[parent].child[m_nodes[parent].child[1] == v] = inner;
+
+    retrace(inner);
+  }
+  m_size++;
+
+  uint32_t prev, next;
+  if (!neighbours(id, prev, next))
+    return id;
+  if (prev == id) {
+    link(id, id);
+    return id;
+  }
+
+  // The old vertices between its neighbours leave the hull, all of them
+  // when it has the same neighbour on both sides
+  uint32_t v = prev;
+  do {
+    uint32_t w = m_nodes[v].next;
+    if (changes && w != v)
+      changes->removed.push_back({v, w});
+    if (v != prev)
+      m_nodes[v].prev = m_nodes[v].next = NONE;
+    v = w;
+  } while (v != next);
+
+  link(prev, id);
+  link(id, next);
+  if (changes) {
+    changes->added.push_back({prev, id});
+    changes->added.push_back({id, next});
+  }
+  return id;
+}
+
+bool DynamicHull::erase(uint32_t id, Changes *changes) {
+  if (changes) {
+    changes->removed.clear();
+    changes->added.clear();
+  }
+  if (id >= m_nodes.size() || m_nodes[id].height != 0)
+    return false;
+
+  uint32_t prev = m_nodes[id].prev, next = m_nodes[id].next;
+  uint32_t parent = m_nodes[id].parent;
+  if (parent == NONE) {
+    m_root = NONE;
+  } else {
+    // Its sibling takes the place of their parent
+    uint32_t sibling = m_nodes[parent].child[m_nodes[parent].child[0] == id];
+    uint32_t grandparent = m_nodes[parent].parent;
+    m_nodes[sibling].parent = grandparent;
+    if (grandparent == NONE)
+      m_root = sibling;
+    else
+      m_nodes[grandparent].child[m_nodes[grandparent].child[1] == parent] =
+          sibling;
+
+    m_nodes[parent].height = NONE;
+    m_free.push_back(parent);
+    retrace(grandparent);
+  }
+  m_nodes[id].height = NONE;
+  m_nodes[id].prev = m_nodes[id].next = NONE;
+  m_free.push_back(id);
+  m_size--;
+
+  if (prev == NONE || prev == id)
+    return true;
+
+  if (changes) {
+    changes->removed.push_back({prev, id});
+    changes->removed.push_back({id, next});
+  }
+
+  // The hull closes between the old neighbours, over the points the erased
+  // one hid
+  uint32_t v = prev;
+  do {
+    uint32_t before, after;
+    neighbours(v, before, after);
+    if (changes && after != v)
+      changes->added.push_back({v, after});
+    link(v, after);
+    v = after;
+  } while (v != next);
+  return true;
+}
+
+uint32_t DynamicHull::find(const Vec2 &point) const {
+  if (m_root == NONE)
+    return NONE;
+
+  uint32_t v = m_root;
+  while (!leaf(v)) {
+    uint32_t right = m_nodes[v].child[1];
+    v = m_nodes[v].child[!Less(point, m_nodes[m_nodes[right].end[0]].point)];
+  }
+  return m_nodes[v].point == point ? v : NONE;
+}
+
+const Vec2 &DynamicHull::point(uint32_t id) const { return m_nodes[id].point; }
+
+std::vector<uint32_t> DynamicHull::hull() const {
+  std::vector<uint32_t> hull;
+  if (m_root == NONE)
+    return hull;
+
+  uint32_t first = m_nodes[m_root].end[0], v = first;
+  do {
+    hull.push_back(v);
+    v = m_nodes[v].next;
+  } while (v != first);
+  return hull;
+}
+
+std::vector<DynamicHull::Edge> DynamicHull::edges() const {
+  std::vector<Edge> edges;
+  for (uint32_t v : hull()) {
+    if (m_nodes[v].next != v)
+      edges.push_back({v, m_nodes[v].next});
+  }
+  return edges;
+}
+
+bool DynamicHull::onHull(uint32_t id) const {
+  return id < m_nodes.size() && m_nodes[id].height == 0 &&
+         m_nodes[id].next != NONE;
+}
+
+uint32_t DynamicHull::next(uint32_t id) const { return m_nodes[id].next; }
+
+uint32_t DynamicHull::prev(uint32_t id) const { return m_nodes[id].prev; }
+
+uint32_t DynamicHull::extreme(const Vec2 &direction) const {
+  uint32_t best = NONE;
+  double farthest = 0;
+  // Each chain is concave, so the walk finds its farthest vertex for
+  // directions pointing its way. The other chain's vertex is then no further
+  for (int lower = 0; lower < 2; lower++) {
+    Vec2 d = lower ? Vec2{-direction[0], -direction[1]} : direction;
+    Vertex vertex = search(lower, [&](const Vec2 &from, const Vec2 &to) {
+      return Along(d, from, to) > 0;
+    });
+    if (vertex.id == NONE)
+      return NONE;
+
+    const Vec2 &p = m_nodes[vertex.id].point;
+    double along = (double)direction[0] * p[0] + (double)direction[1] * p[1];
+    if (best == NONE || along > farthest) {
+      best = vertex.id;
+      farthest = along;
+    }
+  }
+  return best;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>>
+DynamicHull::tangents(const Vec2 &point) const {
+  if (m_root == NONE || find(point) != NONE)
+    return std::nullopt;
+
+  uint32_t prev = NONE, next = NONE;
+  for (int lower = 0; lower < 2; lower++) {
+    Vec2 p = lower ? Vec2{-point[0], -point[1]} : point;
+
+    // Tangent from p to the chain before it, then to the one after it. The
+    // edges p is below lead to the first, those it is above to the second
+    Vertex left = search(lower, [&](const Vec2 &from, const Vec2 &to) {
+      return Less(to, p) && orient2d(from, to, p) < 0;
+    });
+    Vertex right = search(lower, [&](const Vec2 &from, const Vec2 &to) {
+      return Less(from, p) || orient2d(from, to, p) >= 0;
+    });
+    uint32_t l = Less(at(left.id, lower), p) ? left.id : NONE;
+    uint32_t r = Less(p, at(right.id, lower)) ? right.id : NONE;
+
+    // Under the chain, or collinear with the two tangent points
+    if (l != NONE && r != NONE &&
+        orient2d(at(l, lower), at(r, lower), p) <= 0)
+      continue;
+
+    // Both chains run clockwise from their left end
+    if (l != NONE)
+      next = l;
+    if (r != NONE)
+      prev = r;
+  }
+
+  if (prev == NONE || next == NONE)
+    return std::nullopt;
+  return std::make_pair(prev, next);
+}
+
+uint32_t DynamicHull::child(uint32_t v, int side, int lower) const {
+  return m_nodes[v].child[side ^ lower];
+}
+
+Vec2 DynamicHull::at(uint32_t id, int lower) const {
+  const Vec2 &p = m_nodes[id].point;
+  return lower ? Vec2{-p[0], -p[1]} : p;
+}
+
+uint32_t DynamicHull::allocate() {
+  if (m_free.empty()) {
+    m_nodes.emplace_back();
+    return (uint32_t)m_nodes.size() - 1;
+  }
+
+  uint32_t id = m_free.back();
+  m_free.pop_back();
+  m_nodes[id] = Node();
+  return id;
+}
+
+uint32_t DynamicHull::build(const std::vector<Vec2> &points, size_t begin,
+                            size_t end) {
+  if (end - begin == 1) {
+    uint32_t id = allocate();
+    m_nodes[id].point = points[begin];
+    m_nodes[id].end[0] = m_nodes[id].end[1] = id;
+    return id;
+  }
+
+  size_t middle = begin + (end - begin) / 2;
+  uint32_t left = build(points, begin, middle);
+  uint32_t right = build(points, middle, end);
+
+  uint32_t v = allocate();
+  m_nodes[v].child[0] = left;
+  m_nodes[v].child[1] = right;
+  m_nodes[left].parent = m_nodes[right].parent = v;
+  pull(v);
+  return v;
+}
+
+void DynamicHull::pull(uint32_t v) {
+  Node &node = m_nodes[v];
+  const Node &left = m_nodes[node.child[0]], &right = m_nodes[node.child[1]];
+  node.height = 1 + std::max(left.height, right.height);
+  node.end[0] = left.end[0];
+  node.end[1] = right.end[1];
+
+  bridge(v, 0);
+  bridge(v, 1);
+}
+
+// Walks down the hulls of both children at once, keeping the bridge ends p*
+// and q* below u and w. (a, b) is the bridge of u, an edge of its hull, and
+// (c, d) the one of w:
+// - p* is left of b exactly when q* is on or above line ab, and then any
+//   point of the right child is: c or d above it sends u left;
+// - likewise a or b on or above line cd sends w right;
+// - otherwise each line passes above the other's edge and they cross between
+//   b and c. Only the points of the right child past the crossing can be
+//   above ab, only those of the left child before it above cd, so whichever
+//   side of the children's boundary the crossing is settles u or w.
+void DynamicHull::bridge(uint32_t v, int lower) {
+  uint32_t u = child(v, 0, lower), w = child(v, 1, lower);
+  Vec2 boundary = at(m_nodes[w].end[lower], lower);
+
+  while (!leaf(u) || !leaf(w)) {
+    Vec2 a = at(leaf(u) ? u : m_nodes[u].bridge[lower][0], lower);
+    Vec2 b = at(leaf(u) ? u : m_nodes[u].bridge[lower][1], lower);
+    Vec2 c = at(leaf(w) ? w : m_nodes[w].bridge[lower][0], lower);
+    Vec2 d = at(leaf(w) ? w : m_nodes[w].bridge[lower][1], lower);
+
+    if (leaf(u)) {
+      w = child(w, orient2d(c, d, a) >= 0, lower);
+    } else if (leaf(w)) {
+      u = child(u, orient2d(a, b, c) < 0, lower);
+    } else {
+      bool left = orient2d(a, b, c) >= 0 || orient2d(a, b, d) >= 0;
+      bool right = orient2d(c, d, a) >= 0 || orient2d(c, d, b) >= 0;
+      if (left || right) {
+        if (left)
+          u = child(u, 0, lower);
+        if (right)
+          w = child(w, 1, lower);
+      } else if (crossingOrder(a, b, c, d, boundary) < 0) {
+        u = child(u, 1, lower);
+      } else {
+        w = child(w, 0, lower);
+      }
+    }
+  }
+
+  m_nodes[v].bridge[lower][0] = u;
+  m_nodes[v].bridge[lower][1] = w;
+}
+
+uint32_t DynamicHull::rotate(uint32_t v, int side) {
+  uint32_t u = m_nodes[v].child[side];
+  uint32_t middle = m_nodes[u].child[side ^ 1];
+  uint32_t parent = m_nodes[v].parent;
+
+  m_nodes[v].child[side] = middle;
+  m_nodes[middle].parent = v;
+  m_nodes[u].child[side ^ 1] = v;
+  m_nodes[v].parent = u;
+  m_nodes[u].parent = parent;
+  if (parent == NONE)
+    m_root = u;
+  else
+    m_nodes[parent].child[m_nodes[parent].child[1] == v] = u;
+
+  pull(v);
+  pull(u);
+  return u;
+}
+
+void DynamicHull::retrace(uint32_t v) {
+  while (v != NONE) {
+    const Node &node = m_nodes[v];
+    int64_t balance = (int64_t)m_nodes[node.child[0]].height -
+                      m_nodes[node.child[1]].height;
+
+    if (balance > 1 || balance < -1) {
+      int side = balance < 0;
+      const Node &high = m_nodes[node.child[side]];
+      if (m_nodes[high.child[side ^ 1]].height >
+          m_nodes[high.child[side]].height)
+        rotate(node.child[side], side ^ 1);
+      v = rotate(v, side);
+    } else {
+      pull(v);
+    }
+    v = m_nodes[v].parent;
+  }
+}
+
+template <typename Forward>
+DynamicHull::Vertex DynamicHull::search(int lower, Forward forward) const {
+  Vertex vertex;
+  if (m_root == NONE)
+    return vertex;
+
+  // The chain's vertices below v are those of v's hull between lo and hi,
+  // NONE for no bound. A bridge outside them is no edge of the chain
+  uint32_t lo = NONE, hi = NONE;
+  uint32_t v = m_root;
+  while (!leaf(v)) {
+    uint32_t l = m_nodes[v].bridge[lower][0];
+    uint32_t r = m_nodes[v].bridge[lower][1];
+
+    if (hi != NONE && Less(at(hi, lower), at(r, lower))) {
+      v = child(v, 0, lower);
+    } else if (lo != NONE && Less(at(l, lower), at(lo, lower))) {
+      v = child(v, 1, lower);
+    } else if (forward(at(l, lower), at(r, lower))) {
+      lo = r;
+      vertex.left = l;
+      v = child(v, 1, lower);
+    } else {
+      hi = l;
+      vertex.right = r;
+      v = child(v, 0, lower);
+    }
+  }
+
+  vertex.id = v;
+  return vertex;
+}
+
+DynamicHull::Vertex DynamicHull::locate(uint32_t id, int lower) const {
+  Vec2 p = at(id, lower);
+  return search(lower,
+                [&](const Vec2 &, const Vec2 &to) { return !Less(p, to); });
+}
+
+bool DynamicHull::neighbours(uint32_t id, uint32_t &prev,
+                             uint32_t &next) const {
+  bool on = false;
+  prev = next = id;
+  // Both chains run clockwise from their left end
+  for (int lower = 0; lower < 2; lower++) {
+    Vertex vertex = locate(id, lower);
+    if (vertex.id != id)
+      continue;
+
+    on = true;
+    if (vertex.left != NONE)
+      next = vertex.left;
+    if (vertex.right != NONE)
+      prev = vertex.right;
+  }
+  return on;
+}
+
+void DynamicHull::link(uint32_t from, uint32_t to) {
+  m_nodes[from].next = to;
+  m_nodes[to].prev = from;
+}
+
+} // namespace Math
+} // namespace Engine
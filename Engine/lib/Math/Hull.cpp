@@ -0,0 +1,790 @@
+#include "Math/Hull.hpp"
+
+#include "Math/Predicates.hpp"
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HULL_SSE2
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HULL_AVX2
+#endif
+
+namespace Engine {
+namespace Math {
+
+namespace {
+
+using Vec2 = Vector<2>;
+
+bool Less(const Vec2 &a, const Vec2 &b) {
+  return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+
+double Distance2(const Vec2 &a, const Vec2 &b) {
+  double dx = (double)b[0] - a[0];
+  double dy = (double)b[1] - a[1];
+  return dx * dx + dy * dy;
+}
+
+// Whether the wrap from p should turn to c rather than to best: c is right
+// of p -> best, or on it and further
+bool Turns(const Vec2 &p, const Vec2 &c, const Vec2 &best) {
+  double side = orient2d(p, best, c);
+  return side < 0 || (side == 0 && Distance2(p, c) > Distance2(p, best));
+}
+
+// Moves the points whose side passes `keep` to the front of [first, last),
+// their sides along with them
+template <typename Keep>
+Vec2 *Partition(Vec2 *first, Vec2 *last, double *sides, Keep keep) {
+  Vec2 *out = first;
+  double *outSide = sides;
+  for (; first != last; first++, sides++) {
+    if (keep(*sides)) {
+      std::swap(*out++, *first);
+      std::swap(*outSide++, *sides);
+    }
+  }
+  return out;
+}
+
+// [first, first + 1 + left) holds C then the chain before it, right the
+// chain after it. Joins them at first, returns the length
+size_t Join(Vec2 *first, size_t left, Vec2 *right, size_t rightCount) {
+  std::rotate(first, first + 1, first + 1 + left);
+  std::move(right, right + rightCount, first + left + 1);
+  return left + 1 + rightCount;
+}
+
+// Leaves the hull vertices strictly between P and Q, in order, at the front
+// of [first, last) and returns how many. The points are right of P -> Q,
+// sides[i] holding orient2d(P, Q, first[i])
+size_t FindHull(Vec2 *first, Vec2 *last, double *sides, Vec2 P, Vec2 Q,
+                uint32_t &recursions) {
+  recursions++;
+  if (first == last)
+    return 0;
+
+  size_t count = last - first;
+  size_t far = std::min_element(sides, sides + count) - sides;
+  std::swap(first[0], first[far]);
+  Vec2 C = first[0];
+
+  // The triangle P, C, Q takes the rest, none can be right of both edges
+  orient2d(P, C, first + 1, count - 1, sides + 1);
+  Vec2 *mid = Partition(first + 1, last, sides + 1,
+                        [](double side) { return side < 0; });
+
+  double *midSides = sides + (mid - first);
+  orient2d(C, Q, mid, last - mid, midSides);
+  Vec2 *end =
+      Partition(mid, last, midSides, [](double side) { return side < 0; });
+
+  size_t left = FindHull(first + 1, mid, sides + 1, P, C, recursions);
+  size_t right = FindHull(mid, end, midSides, C, Q, recursions);
+  return Join(first, left, mid, right);
+}
+
+// Below this many points a subproblem runs serially
+const size_t PARALLEL_HULL = 1 << 16;
+const size_t MAX_CHUNKS = 64;
+
+// Point arrays of the parallel QuickHull, all indexed alike. Allocated once,
+// subproblems only touch their own index range
+struct Buffers {
+  Vec2 *points;
+  double *sides;
+  Vec2 *scratch;
+  double *scratchSides;
+  // 1 and 2 for the two sides a point goes to, 0 once inside
+  uint8_t *classes;
+
+  // The subproblems of a partition work in the scratch arrays
+  Buffers swapped() const {
+    return {scratch, scratchSides, points, sides, classes};
+  }
+};
+
+// body(chunk, begin, end) over at most MAX_CHUNKS chunks of [begin, end),
+// the same ones for the same range
+template <typename Body> void ForChunks(size_t begin, size_t end, Body body) {
+  size_t count = end - begin;
+  size_t chunks = std::clamp<size_t>(count / (PARALLEL_HULL / 4), 1,
+                                     MAX_CHUNKS);
+  size_t size = (count + chunks - 1) / chunks;
+  JobSystem::get().parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      size_t from = begin + std::min(c * size, count);
+      body(c, from, std::min(from + size, end));
+    }
+  });
+}
+
+// Copies the points of [begin, end) in class 1 to the front of the same range
+// of the scratch arrays, then those in class 2, sides along. Returns both
+// counts
+std::pair<size_t, size_t> Scatter(const Buffers &b, size_t begin,
+                                  size_t end) {
+  std::array<size_t, MAX_CHUNKS> ones{}, twos{};
+  ForChunks(begin, end, [&](size_t c, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) {
+      ones[c] += b.classes[i] == 1;
+      twos[c] += b.classes[i] == 2;
+    }
+  });
+
+  size_t totalOnes = 0, totalTwos = 0;
+  for (size_t c = 0; c < MAX_CHUNKS; c++) {
+    size_t one = ones[c], two = twos[c];
+    ones[c] = totalOnes;
+    twos[c] = totalTwos;
+    totalOnes += one;
+    totalTwos += two;
+  }
+
+  ForChunks(begin, end, [&](size_t c, size_t from, size_t to) {
+    size_t one = begin + ones[c];
+    size_t two = begin + totalOnes + twos[c];
+    for (size_t i = from; i < to; i++) {
+      if (b.classes[i] == 0)
+        continue;
+      size_t &at = b.classes[i] == 1 ? one : two;
+      b.scratch[at] = b.points[i];
+      b.scratchSides[at] = b.sides[i];
+      at++;
+    }
+  });
+
+  return {totalOnes, totalTwos};
+}
+
+// FindHull over [begin, end) of the buffers, the farthest point search and
+// the partition spread over chunks and the two sides run as jobs. The sides
+// leave their chains in the scratch arrays, only those are copied back
+size_t ParallelFindHull(const Buffers &b, size_t begin, size_t end, Vec2 P,
+                        Vec2 Q, std::atomic<uint32_t> &recursions) {
+  if (end - begin < PARALLEL_HULL) {
+    uint32_t serial = 0;
+    size_t count = FindHull(b.points + begin, b.points + end, b.sides + begin,
+                            P, Q, serial);
+    recursions += serial;
+    return count;
+  }
+  recursions++;
+
+  std::array<size_t, MAX_CHUNKS> far;
+  far.fill(begin);
+  ForChunks(begin, end, [&](size_t c, size_t from, size_t to) {
+    far[c] = std::min_element(b.sides + from, b.sides + to) - b.sides;
+  });
+  size_t f = begin;
+  for (size_t i : far) {
+    if (b.sides[i] < b.sides[f])
+      f = i;
+  }
+  std::swap(b.points[begin], b.points[f]);
+  Vec2 C = b.points[begin];
+
+  ForChunks(begin + 1, end, [&](size_t, size_t from, size_t to) {
+    orient2d(P, C, b.points + from, to - from, b.scratchSides + from);
+    orient2d(C, Q, b.points + from, to - from, b.sides + from);
+    for (size_t i = from; i < to; i++) {
+      if (b.scratchSides[i] < 0) {
+        b.classes[i] = 1;
+        b.sides[i] = b.scratchSides[i];
+      } else {
+        b.classes[i] = b.sides[i] < 0 ? 2 : 0;
+      }
+    }
+  });
+
+  auto [ones, twos] = Scatter(b, begin + 1, end);
+  size_t mid = begin + 1 + ones;
+
+  Buffers next = b.swapped();
+  size_t left = 0;
+  JobSystem::Counter counter;
+  JobSystem::get().submit(
+      [&]() {
+        left = ParallelFindHull(next, begin + 1, mid, P, C, recursions);
+      },
+      &counter);
+  size_t right = ParallelFindHull(next, mid, mid + twos, C, Q, recursions);
+  JobSystem::get().wait(counter);
+
+  Vec2 *out = std::copy(b.scratch + begin + 1, b.scratch + begin + 1 + left,
+                        b.points + begin);
+  *out++ = C;
+  std::copy(b.scratch + mid, b.scratch + mid + right, out);
+  return left + 1 + right;
+}
+
+// The farthest point is picked on approximate distances, so one of several
+// about as far as it may be collinear with or slightly inside the hull. They
+// all lie between their neighbouring vertices, one pass like the monotone
+// chain drops them
+void DropInner(std::vector<Vec2> &hull) {
+  size_t k = 0;
+  for (size_t i = 0; i < hull.size(); i++) {
+    while (k >= 2 && orient2d(hull[k - 2], hull[k - 1], hull[i]) <= 0)
+      k--;
+    hull[k++] = hull[i];
+  }
+  // The first point is a vertex, it closes the chain
+  while (k >= 3 && orient2d(hull[k - 2], hull[k - 1], hull[0]) <= 0)
+    k--;
+  hull.resize(k);
+}
+
+// The forward error bound of the double orientation, as in the predicates
+const double EPSILON = std::numeric_limits<double>::epsilon() / 2;
+const double ORIENT_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+
+// Along x, y, x + y and x - y, rounded as floats. Only to pick extremes, which
+// stay points of the set whatever the rounding
+struct Keys {
+  float key[4];
+
+  explicit Keys(const Vec2 &p) : key{p[0], p[1], p[0] + p[1], p[0] - p[1]} {}
+};
+
+// Indices of the lowest and highest point along each key
+struct Extremes {
+  size_t low[4];
+  size_t high[4];
+};
+
+Extremes FindExtremes(const std::vector<Vec2> &points) {
+  size_t n = points.size();
+  Extremes at;
+  float low[4], high[4];
+  for (int k = 0; k < 4; k++) {
+    at.low[k] = at.high[k] = 0;
+    low[k] = high[k] = Keys(points[0]).key[k];
+  }
+
+  size_t i = 0;
+#ifdef HULL_SSE2
+  if (n <= (size_t)INT32_MAX) {
+    const float *coords = reinterpret_cast<const float *>(points.data());
+    __m128 lows[4], highs[4];
+    __m128i lowAt[4], highAt[4];
+    for (int k = 0; k < 4; k++) {
+      lows[k] = _mm_set1_ps(low[k]);
+      highs[k] = _mm_set1_ps(high[k]);
+      lowAt[k] = highAt[k] = _mm_setzero_si128();
+    }
+
+    // Four points a step, each lane keeps its own extremes
+    __m128i index = _mm_set_epi32(3, 2, 1, 0);
+    const __m128i step = _mm_set1_epi32(4);
+    for (; i + 4 <= n; i += 4) {
+      __m128 a = _mm_loadu_ps(coords + 2 * i);
+      __m128 b = _mm_loadu_ps(coords + 2 * i + 4);
+      __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      __m128 keys[4] = {x, y, _mm_add_ps(x, y), _mm_sub_ps(x, y)};
+
+      for (int k = 0; k < 4; k++) {
+        __m128i lower = _mm_castps_si128(_mm_cmplt_ps(keys[k], lows[k]));
+        __m128i higher = _mm_castps_si128(_mm_cmpgt_ps(keys[k], highs[k]));
+        lows[k] = _mm_min_ps(keys[k], lows[k]);
+        highs[k] = _mm_max_ps(keys[k], highs[k]);
+        lowAt[k] = _mm_or_si128(_mm_and_si128(lower, index),
+                                _mm_andnot_si128(lower, lowAt[k]));
+        highAt[k] = _mm_or_si128(_mm_and_si128(higher, index),
+                                 _mm_andnot_si128(higher, highAt[k]));
+      }
+      index = _mm_add_epi32(index, step);
+    }
+
+    for (int k = 0; k < 4; k++) {
+      alignas(16) float lowLanes[4], highLanes[4];
+      alignas(16) int32_t lowLaneAt[4], highLaneAt[4];
+      _mm_store_ps(lowLanes, lows[k]);
+      _mm_store_ps(highLanes, highs[k]);
+      _mm_store_si128((__m128i *)lowLaneAt, lowAt[k]);
+      _mm_store_si128((__m128i *)highLaneAt, highAt[k]);
+      for (int lane = 0; lane < 4; lane++) {
+        if (lowLanes[lane] < low[k]) {
+          low[k] = lowLanes[lane];
+          at.low[k] = lowLaneAt[lane];
+        }
+        if (highLanes[lane] > high[k]) {
+          high[k] = highLanes[lane];
+          at.high[k] = highLaneAt[lane];
+        }
+      }
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    Keys keys(points[i]);
+    for (int k = 0; k < 4; k++) {
+      if (keys.key[k] < low[k]) {
+        low[k] = keys.key[k];
+        at.low[k] = i;
+      }
+      if (keys.key[k] > high[k]) {
+        high[k] = keys.key[k];
+        at.high[k] = i;
+      }
+    }
+  }
+
+  return at;
+}
+
+#ifdef HULL_AVX2
+// For each mask of four points, the 32 bit lanes of those set moved to the
+// front
+constexpr std::array<std::array<int32_t, 8>, 16> CompactLanes() {
+  std::array<std::array<int32_t, 8>, 16> lanes{};
+  for (int mask = 0; mask < 16; mask++) {
+    int to = 0;
+    for (int p = 0; p < 4; p++) {
+      if (mask & (1 << p)) {
+        lanes[mask][to++] = 2 * p;
+        lanes[mask][to++] = 2 * p + 1;
+      }
+    }
+  }
+  return lanes;
+}
+
+constexpr std::array<std::array<int32_t, 8>, 16> COMPACT = CompactLanes();
+
+// Four points at a time from i against the octagon edges, the points kept
+// permuted to the front of one store at kept. Returns where it stopped
+__attribute__((target("avx2"))) size_t
+DiscardAVX2(std::vector<Vec2> &points, size_t i, size_t &kept, size_t corners,
+            const double *ax, const double *ay, const double *dx,
+            const double *dy) {
+  float *coords = reinterpret_cast<float *>(points.data());
+  const size_t n = points.size();
+  // x0 y0 x1 y1 x2 y2 x3 y3 -> x0 x1 x2 x3 y0 y1 y2 y3
+  const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256d error = _mm256_set1_pd(ORIENT_BOUND);
+  const __m256d sign = _mm256_set1_pd(-0.0);
+
+  for (; i + 4 <= n; i += 4) {
+    __m256 xy = _mm256_loadu_ps(coords + 2 * i);
+    __m256 split_xy = _mm256_permutevar8x32_ps(xy, split);
+    __m256d px = _mm256_cvtps_pd(_mm256_castps256_ps128(split_xy));
+    __m256d py = _mm256_cvtps_pd(_mm256_extractf128_ps(split_xy, 1));
+
+    __m256d inside = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+    for (size_t e = 0; e < corners; e++) {
+      __m256d left = _mm256_mul_pd(_mm256_set1_pd(dx[e]),
+                                   _mm256_sub_pd(py, _mm256_set1_pd(ay[e])));
+      __m256d right = _mm256_mul_pd(_mm256_set1_pd(dy[e]),
+                                    _mm256_sub_pd(px, _mm256_set1_pd(ax[e])));
+      __m256d det = _mm256_sub_pd(left, right);
+      __m256d bound = _mm256_mul_pd(
+          error, _mm256_add_pd(_mm256_andnot_pd(sign, left),
+                               _mm256_andnot_pd(sign, right)));
+      inside = _mm256_and_pd(inside, _mm256_cmp_pd(det, bound, _CMP_GT_OS));
+    }
+
+    // kept <= i, the store only overwrites points already loaded
+    int keep = ~_mm256_movemask_pd(inside) & 15;
+    __m256i lanes =
+        _mm256_loadu_si256((const __m256i *)COMPACT[keep].data());
+    _mm256_storeu_ps(coords + 2 * kept, _mm256_permutevar8x32_ps(xy, lanes));
+    kept += __builtin_popcount(keep);
+  }
+
+  return i;
+}
+#endif
+
+bool HasAVX2() {
+#ifdef HULL_AVX2
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+} // namespace
+
+size_t DiscardInterior(std::vector<Vec2> &points) {
+  size_t n = points.size();
+  if (n < 4)
+    return 0;
+
+  // Counter-clockwise by direction: -y, x - y, x, x + y, y, y - x, -x, -x - y
+  Extremes at = FindExtremes(points);
+  const size_t order[8] = {at.low[1],  at.high[3], at.high[0], at.high[2],
+                           at.high[1], at.low[3],  at.low[0],  at.low[2]};
+  Vec2 octagon[8];
+  size_t corners = 0;
+  for (size_t i : order) {
+    if (corners == 0 || !(points[i] == octagon[corners - 1]))
+      octagon[corners++] = points[i];
+  }
+  while (corners > 1 && octagon[corners - 1] == octagon[0])
+    corners--;
+  if (corners < 3)
+    return 0;
+
+  double ax[8], ay[8], dx[8], dy[8];
+  for (size_t e = 0; e < corners; e++) {
+    const Vec2 &a = octagon[e], &b = octagon[(e + 1) % corners];
+    ax[e] = a[0];
+    ay[e] = a[1];
+    dx[e] = (double)b[0] - a[0];
+    dy[e] = (double)b[1] - a[1];
+  }
+
+  // Every point is copied down, the write position only moves past those
+  // kept
+  size_t kept = 0;
+  size_t i = 0;
+
+#ifdef HULL_AVX2
+  if (HasAVX2())
+    i = DiscardAVX2(points, i, kept, corners, ax, ay, dx, dy);
+#endif
+
+#ifdef HULL_SSE2
+  const float *coords = reinterpret_cast<const float *>(points.data());
+  const __m128d error = _mm_set1_pd(ORIENT_BOUND);
+  const __m128d sign = _mm_set1_pd(-0.0);
+
+  for (; i + 2 <= n; i += 2) {
+    __m128 xy = _mm_loadu_ps(coords + 2 * i);
+    __m128d p0 = _mm_cvtps_pd(xy);
+    __m128d p1 = _mm_cvtps_pd(_mm_movehl_ps(xy, xy));
+    __m128d px = _mm_unpacklo_pd(p0, p1), py = _mm_unpackhi_pd(p0, p1);
+
+    __m128d inside = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (size_t e = 0; e < corners; e++) {
+      __m128d left =
+          _mm_mul_pd(_mm_set1_pd(dx[e]), _mm_sub_pd(py, _mm_set1_pd(ay[e])));
+      __m128d right =
+          _mm_mul_pd(_mm_set1_pd(dy[e]), _mm_sub_pd(px, _mm_set1_pd(ax[e])));
+      __m128d det = _mm_sub_pd(left, right);
+      __m128d bound = _mm_mul_pd(error, _mm_add_pd(_mm_andnot_pd(sign, left),
+                                                   _mm_andnot_pd(sign, right)));
+      inside = _mm_and_pd(inside, _mm_cmpgt_pd(det, bound));
+    }
+
+    int interior = _mm_movemask_pd(inside);
+    points[kept] = points[i];
+    kept += !(interior & 1);
+    points[kept] = points[i + 1];
+    kept += !(interior & 2);
+  }
+#endif
+
+  for (; i < n; i++) {
+    bool inside = true;
+    for (size_t e = 0; e < corners; e++) {
+      double left = dx[e] * ((double)points[i][1] - ay[e]);
+      double right = dy[e] * ((double)points[i][0] - ax[e]);
+      double bound = ORIENT_BOUND * (std::fabs(left) + std::fabs(right));
+      inside &= left - right > bound;
+    }
+    points[kept] = points[i];
+    kept += !inside;
+  }
+
+  points.resize(kept);
+  return n - kept;
+}
+
+const char *HullAlgorithmName(HullAlgorithm algorithm) {
+  switch (algorithm) {
+  case HullAlgorithm::MonotoneChain:
+    return "monotoneChain";
+  case HullAlgorithm::Chan:
+    return "chan";
+  case HullAlgorithm::QuickHull:
+    return "quickHull";
+  case HullAlgorithm::ParallelQuickHull:
+    return "parallelQuickHull";
+  }
+  return "";
+}
+
+std::vector<Vec2> MonotoneChain(std::vector<Vec2> points) {
+  std::sort(points.begin(), points.end(), Less);
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+
+  size_t n = points.size();
+  if (n < 3)
+    return points;
+
+  std::vector<Vec2> hull(2 * n);
+  size_t k = 0;
+  for (size_t i = 0; i < n; i++) {
+    while (k >= 2 && orient2d(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
+  }
+
+  // The upper chain back to the first point, which ends it twice
+  for (size_t i = n - 1, lower = k + 1; i-- > 0;) {
+    while (k >= lower && orient2d(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
+  }
+
+  hull.resize(k - 1);
+  return hull;
+}
+
+std::vector<Vec2> ChanHull(const std::vector<Vec2> &points, HullStats *stats) {
+  size_t n = points.size();
+  if (n == 0)
+    return {};
+
+  const Vec2 start = *std::min_element(points.begin(), points.end(), Less);
+
+  std::vector<Vec2> hull;
+  std::vector<Vec2> vertices;
+  std::vector<size_t> offsets;
+  std::vector<size_t> tangent;
+
+  for (size_t m = std::min<size_t>(4, n);; m = std::min(m * m, n)) {
+    if (stats)
+      stats->recursions++;
+
+    // Hull of each group, group g in vertices[offsets[g], offsets[g + 1])
+    vertices.clear();
+    offsets.assign(1, 0);
+    for (size_t begin = 0; begin < n; begin += m) {
+      std::vector<Vec2> group = MonotoneChain(
+          {points.begin() + begin, points.begin() + std::min(begin + m, n)});
+      vertices.insert(vertices.end(), group.begin(), group.end());
+      offsets.push_back(vertices.size());
+    }
+    size_t groups = offsets.size() - 1;
+
+    // Each group hull starts at its lowest x point, the tangent from start
+    // is at or after it
+    tangent.assign(groups, 0);
+
+    hull.assign(1, start);
+    Vec2 p = start;
+    bool closed = false;
+    for (size_t step = 0; step < m && !closed; step++) {
+      const Vec2 *best = nullptr;
+      for (size_t g = 0; g < groups; g++) {
+        const Vec2 *group = vertices.data() + offsets[g];
+        size_t size = offsets[g + 1] - offsets[g];
+        size_t &t = tangent[g];
+
+        for (size_t moved = 0; moved < size; moved++) {
+          const Vec2 &next = group[(t + 1) % size];
+          if (group[t] == p || Turns(p, next, group[t])) {
+            t = (t + 1) % size;
+          } else {
+            break;
+          }
+        }
+
+        const Vec2 &c = group[t];
+        if (c != p && (!best || Turns(p, c, *best)))
+          best = &c;
+      }
+
+      // Back at the start, or every point is the start
+      if (!best || *best == start) {
+        closed = true;
+      } else {
+        p = *best;
+        hull.push_back(p);
+      }
+    }
+
+    if (closed || m == n)
+      return hull;
+  }
+}
+
+std::vector<Vec2> QuickHull(std::vector<Vec2> points, HullStats *stats) {
+  if (points.empty())
+    return {};
+
+  auto [min, max] = std::minmax_element(points.begin(), points.end(), Less);
+  Vec2 A = *min, B = *max;
+  if (A == B)
+    return {A};
+
+  std::vector<double> sides(points.size());
+  orient2d(A, B, points.data(), points.size(), sides.data());
+
+  // Below A -> B first, then above it with the signs of B -> A
+  Vec2 *first = points.data();
+  Vec2 *last = first + points.size();
+  Vec2 *lower = Partition(first, last, sides.data(),
+                          [](double side) { return side < 0; });
+  double *upperSides = sides.data() + (lower - first);
+  Vec2 *upper =
+      Partition(lower, last, upperSides, [](double side) { return side > 0; });
+  for (double *side = upperSides; side != upperSides + (upper - lower);
+       side++) {
+    *side = -*side;
+  }
+
+  uint32_t recursions = 0;
+  size_t below = FindHull(first, lower, sides.data(), A, B, recursions);
+  size_t above = FindHull(lower, upper, upperSides, B, A, recursions);
+  if (stats)
+    stats->recursions += recursions;
+
+  std::vector<Vec2> hull;
+  hull.reserve(below + above + 2);
+  hull.push_back(A);
+  hull.insert(hull.end(), first, first + below);
+  hull.push_back(B);
+  hull.insert(hull.end(), lower, lower + above);
+  DropInner(hull);
+  return hull;
+}
+
+std::vector<Vec2> ParallelQuickHull(std::vector<Vec2> points,
+                                    HullStats *stats) {
+  size_t n = points.size();
+  // Without workers the chunks only add passes over the points
+  if (n < PARALLEL_HULL || JobSystem::get().workers() == 0)
+    return QuickHull(std::move(points), stats);
+
+  std::array<std::pair<size_t, size_t>, MAX_CHUNKS> extremes;
+  extremes.fill({0, 0});
+  ForChunks(0, n, [&](size_t c, size_t from, size_t to) {
+    auto [min, max] =
+        std::minmax_element(points.begin() + from, points.begin() + to, Less);
+    extremes[c] = {min - points.begin(), max - points.begin()};
+  });
+  Vec2 A = points[0], B = points[0];
+  for (auto [min, max] : extremes) {
+    if (Less(points[min], A))
+      A = points[min];
+    if (Less(B, points[max]))
+      B = points[max];
+  }
+  if (A == B)
+    return {A};
+
+  std::vector<double> sides(n), scratchSides(n);
+  std::vector<Vec2> scratch(n);
+  std::vector<uint8_t> classes(n);
+  Buffers b{points.data(), sides.data(), scratch.data(), scratchSides.data(),
+            classes.data()};
+
+  // Below A -> B first, then above it with the signs of B -> A
+  ForChunks(0, n, [&](size_t, size_t from, size_t to) {
+    orient2d(A, B, b.points + from, to - from, b.sides + from);
+    for (size_t i = from; i < to; i++) {
+      b.classes[i] = b.sides[i] < 0 ? 1 : b.sides[i] > 0 ? 2 : 0;
+      b.sides[i] = -std::abs(b.sides[i]);
+    }
+  });
+  auto [lower, upper] = Scatter(b, 0, n);
+
+  Buffers next = b.swapped();
+  std::atomic<uint32_t> recursions = 0;
+  size_t below = 0;
+  JobSystem::Counter counter;
+  JobSystem::get().submit(
+      [&]() { below = ParallelFindHull(next, 0, lower, A, B, recursions); },
+      &counter);
+  size_t above =
+      ParallelFindHull(next, lower, lower + upper, B, A, recursions);
+  JobSystem::get().wait(counter);
+  if (stats)
+    stats->recursions += recursions;
+
+  std::vector<Vec2> hull;
+  hull.reserve(below + above + 2);
+  hull.push_back(A);
+  hull.insert(hull.end(), scratch.begin(), scratch.begin() + below);
+  hull.push_back(B);
+  hull.insert(hull.end(), scratch.begin() + lower,
+              scratch.begin() + lower + above);
+  DropInner(hull);
+  return hull;
+}
+
+std::vector<Vec2> MergeHulls(const std::vector<Vec2> &a,
+                             const std::vector<Vec2> &b) {
+  if (a.empty())
+    return b;
+  if (b.empty())
+    return a;
+
+  // Both start at their lowest point, their highest ends the lower chain
+  size_t am = std::max_element(a.begin(), a.end(), Less) - a.begin();
+  size_t bm = std::max_element(b.begin(), b.end(), Less) - b.begin();
+
+  auto sweep = [](const std::vector<Vec2> &sorted, std::vector<Vec2> &chain) {
+    for (const Vec2 &p : sorted) {
+      if (!chain.empty() && chain.back() == p)
+        continue;
+      while (chain.size() >= 2 &&
+             orient2d(chain[chain.size() - 2], chain.back(), p) <= 0)
+        chain.pop_back();
+      chain.push_back(p);
+    }
+  };
+
+  std::vector<Vec2> sorted;
+  sorted.reserve(a.size() + b.size() + 2);
+  std::merge(a.begin(), a.begin() + am + 1, b.begin(), b.begin() + bm + 1,
+             std::back_inserter(sorted), Less);
+  std::vector<Vec2> lower;
+  sweep(sorted, lower);
+
+  // The upper chains run from the highest point back to the first
+  std::vector<Vec2> aUpper(a.begin() + am, a.end());
+  aUpper.push_back(a[0]);
+  std::vector<Vec2> bUpper(b.begin() + bm, b.end());
+  bUpper.push_back(b[0]);
+  sorted.clear();
+  std::merge(aUpper.begin(), aUpper.end(), bUpper.begin(), bUpper.end(),
+             std::back_inserter(sorted),
+             [](const Vec2 &p, const Vec2 &q) { return Less(q, p); });
+  std::vector<Vec2> upper;
+  sweep(sorted, upper);
+
+  // Both chains hold the lowest and the highest point
+  lower.insert(lower.end(), upper.begin() + 1,
+               upper.end() - (upper.size() > 1));
+  return lower;
+}
+
+std::vector<Vec2> ConvexHull(std::vector<Vec2> points, HullAlgorithm algorithm,
+                             HullStats *stats) {
+  switch (algorithm) {
+  case HullAlgorithm::MonotoneChain:
+    return MonotoneChain(std::move(points));
+  case HullAlgorithm::Chan:
+    return ChanHull(points, stats);
+  case HullAlgorithm::QuickHull:
+    return QuickHull(std::move(points), stats);
+  case HullAlgorithm::ParallelQuickHull:
+    return ParallelQuickHull(std::move(points), stats);
+  }
+  return {};
+}
+
+} // namespace Math
+} // namespace Engine
@@ -0,0 +1,349 @@
+#include "Math/Hull3D.hpp"
+
+#include "Math/Predicates.hpp"
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace Engine {
+namespace Math {
+
+namespace {
+
+const uint32_t NONE = Hull3D::NONE;
+
+using Point = std::array<double, 3>;
+
+Point Difference(const Point &a, const Point &b) {
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+double CrossNorm2(const Point &a, const Point &b) {
+  double x = a[1] * b[2] - a[2] * b[1];
+  double y = a[2] * b[0] - a[0] * b[2];
+  double z = a[0] * b[1] - a[1] * b[0];
+  return x * x + y * y + z * z;
+}
+
+struct Face {
+  // Counter-clockwise seen from outside
+  uint32_t vertices[3];
+  // Points outside it, and the farthest of them
+  std::vector<uint32_t> conflicts;
+  uint32_t farthest = NONE;
+  double height = 0;
+  bool alive = false;
+  // Flood epoch it was last tested in, and whether the point sees it
+  uint32_t mark = 0;
+  bool visible = false;
+};
+
+// `above(a, b, c, p)` is positive when p is outside the counter-clockwise
+// face a, b, c, with the exact sign of a determinant proportional to its
+// height over it. `at(i)` only guides the choice of the first tetrahedron
+template <typename Above, typename At> class Builder {
+public:
+  Builder(size_t count, Above above, At at)
+      : m_count(count), m_above(above), m_at(at) {}
+
+  Hull3D run() {
+    if (!start())
+      return {};
+
+    while (!m_pending.empty()) {
+      uint32_t f = m_pending.back();
+      m_pending.pop_back();
+      if (m_faces[f].alive && !m_faces[f].conflicts.empty())
+        add(f);
+    }
+
+    return result();
+  }
+
+private:
+  struct Frame {
+    uint32_t face;
+    // Edges left to cross, from `first` on
+    uint32_t first;
+    uint32_t left;
+  };
+
+  struct Horizon {
+    uint32_t from;
+    uint32_t to;
+    // Half-edge the other way, on the face that stays
+    uint32_t outer;
+  };
+
+  double above(uint32_t f, uint32_t p) const {
+    const uint32_t *v = m_faces[f].vertices;
+    return m_above(v[0], v[1], v[2], p);
+  }
+
+  // A tetrahedron of four points off one plane, the others in its conflict
+  // lists. False when there is none
+  bool start() {
+    if (m_count < 4)
+      return false;
+
+    uint32_t a = 0, b = 0;
+    for (uint32_t i = 1; i < m_count; i++) {
+      if (m_at(i) < m_at(a))
+        a = i;
+      if (m_at(b) < m_at(i))
+        b = i;
+    }
+    if (m_at(a) == m_at(b))
+      return false;
+
+    // Farthest from the line ab
+    Point ab = Difference(m_at(b), m_at(a));
+    uint32_t c = NONE;
+    double best = 0;
+    for (uint32_t i = 0; i < m_count; i++) {
+      double distance = CrossNorm2(ab, Difference(m_at(i), m_at(a)));
+      if (distance > best) {
+        best = distance;
+        c = i;
+      }
+    }
+    if (c == NONE)
+      return false;
+
+    // Farthest from the plane abc, by the exact predicate so never on it
+    uint32_t d = NONE;
+    best = 0;
+    for (uint32_t i = 0; i < m_count; i++) {
+      double height = std::fabs(m_above(a, b, c, i));
+      if (height > best) {
+        best = height;
+        d = i;
+      }
+    }
+    if (d == NONE)
+      return false;
+
+    // d inside abc, then every face turns the same way
+    if (m_above(a, b, c, d) > 0)
+      std::swap(b, c);
+    uint32_t faces[4] = {newFace(a, b, c), newFace(a, d, b), newFace(b, d, c),
+                         newFace(c, d, a)};
+    for (uint32_t e = 0; e < 12; e++) {
+      for (uint32_t t = 0; t < 12; t++) {
+        if (origin(e) == target(t) && target(e) == origin(t))
+          m_twins[e] = t;
+      }
+    }
+
+    for (uint32_t i = 0; i < m_count; i++) {
+      if (i != a && i != b && i != c && i != d)
+        assign(i, faces, 4);
+    }
+    for (uint32_t f : faces) {
+      if (!m_faces[f].conflicts.empty())
+        m_pending.push_back(f);
+    }
+    return true;
+  }
+
+  // Puts p in the conflicts of the first face it sees, drops it when none
+  void assign(uint32_t p, const uint32_t *faces, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      double height = above(faces[i], p);
+      if (height <= 0)
+        continue;
+
+      Face &face = m_faces[faces[i]];
+      face.conflicts.push_back(p);
+      if (height > face.height) {
+        face.height = height;
+        face.farthest = p;
+      }
+      return;
+    }
+  }
+
+  // Adds the farthest conflict of f
+  void add(uint32_t f) {
+    uint32_t eye = m_faces[f].farthest;
+    m_epoch++;
+
+    // Depth first from f, an edge to a face the eye does not see is on the
+    // horizon. Entering a face through one edge and leaving through the two
+    // after it keeps the horizon in order around the visible faces
+    m_visible.assign(1, f);
+    m_horizon.clear();
+    m_faces[f].mark = m_epoch;
+    m_faces[f].visible = true;
+    m_stack.assign(1, {f, 0, 3});
+    while (!m_stack.empty()) {
+      Frame &frame = m_stack.back();
+      if (frame.left == 0) {
+        m_stack.pop_back();
+        continue;
+      }
+
+      uint32_t e = 3 * frame.face + frame.first;
+      frame.first = (frame.first + 1) % 3;
+      frame.left--;
+
+      uint32_t t = m_twins[e];
+      Face &face = m_faces[t / 3];
+      if (face.mark != m_epoch) {
+        face.mark = m_epoch;
+        face.visible = above(t / 3, eye) > 0;
+        if (face.visible) {
+          m_visible.push_back(t / 3);
+          m_stack.push_back({t / 3, (t % 3 + 1) % 3, 2});
+          continue;
+        }
+      }
+      if (!face.visible)
+        m_horizon.push_back({origin(e), target(e), t});
+    }
+
+    // Collected before the faces are reused
+    m_orphans.clear();
+    for (uint32_t v : m_visible) {
+      for (uint32_t p : m_faces[v].conflicts) {
+        if (p != eye)
+          m_orphans.push_back(p);
+      }
+      freeFace(v);
+    }
+
+    // A fan from the eye, consecutive faces share the edge to it
+    m_fan.resize(m_horizon.size());
+    for (size_t i = 0; i < m_horizon.size(); i++) {
+      const Horizon &edge = m_horizon[i];
+      m_fan[i] = newFace(edge.from, edge.to, eye);
+      m_twins[3 * m_fan[i]] = edge.outer;
+      m_twins[edge.outer] = 3 * m_fan[i];
+    }
+    for (size_t i = 0; i < m_fan.size(); i++) {
+      uint32_t a = m_fan[i], b = m_fan[(i + 1) % m_fan.size()];
+      m_twins[3 * a + 1] = 3 * b + 2;
+      m_twins[3 * b + 2] = 3 * a + 1;
+    }
+
+    for (uint32_t p : m_orphans) {
+      assign(p, m_fan.data(), m_fan.size());
+    }
+    for (uint32_t fan : m_fan) {
+      if (!m_faces[fan].conflicts.empty())
+        m_pending.push_back(fan);
+    }
+  }
+
+  uint32_t origin(uint32_t e) const { return m_faces[e / 3].vertices[e % 3]; }
+  uint32_t target(uint32_t e) const {
+    return m_faces[e / 3].vertices[(e % 3 + 1) % 3];
+  }
+
+  uint32_t newFace(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t f;
+    if (!m_free.empty()) {
+      f = m_free.back();
+      m_free.pop_back();
+    } else {
+      f = m_faces.size();
+      m_faces.emplace_back();
+      m_twins.resize(3 * m_faces.size(), NONE);
+    }
+
+    Face &face = m_faces[f];
+    face.vertices[0] = a;
+    face.vertices[1] = b;
+    face.vertices[2] = c;
+    face.alive = true;
+    face.mark = 0;
+    return f;
+  }
+
+  // Keeps the capacity of the conflicts for the next face
+  void freeFace(uint32_t f) {
+    Face &face = m_faces[f];
+    face.conflicts.clear();
+    face.farthest = NONE;
+    face.height = 0;
+    face.alive = false;
+    m_free.push_back(f);
+  }
+
+  Hull3D result() const {
+    Hull3D hull;
+    std::vector<uint32_t> remap(m_faces.size(), NONE);
+    uint32_t count = 0;
+    for (uint32_t f = 0; f < m_faces.size(); f++) {
+      if (m_faces[f].alive)
+        remap[f] = count++;
+    }
+
+    std::vector<bool> vertex(m_count, false);
+    hull.edges.resize(3 * count);
+    for (uint32_t f = 0; f < m_faces.size(); f++) {
+      if (remap[f] == NONE)
+        continue;
+
+      for (uint32_t k = 0; k < 3; k++) {
+        uint32_t t = m_twins[3 * f + k];
+        hull.edges[3 * remap[f] + k] = {m_faces[f].vertices[k],
+                                        3 * remap[t / 3] + t % 3};
+        vertex[m_faces[f].vertices[k]] = true;
+      }
+    }
+
+    for (uint32_t i = 0; i < m_count; i++) {
+      if (vertex[i])
+        hull.vertices.push_back(i);
+    }
+    return hull;
+  }
+
+  size_t m_count;
+  Above m_above;
+  At m_at;
+
+  std::vector<Face> m_faces;
+  // Three per face, even freed ones
+  std::vector<uint32_t> m_twins;
+  std::vector<uint32_t> m_free;
+  // Faces that may still have conflicts
+  std::vector<uint32_t> m_pending;
+
+  // Scratch of add
+  uint32_t m_epoch = 0;
+  std::vector<uint32_t> m_visible;
+  std::vector<Horizon> m_horizon;
+  std::vector<Frame> m_stack;
+  std::vector<uint32_t> m_orphans;
+  std::vector<uint32_t> m_fan;
+};
+
+} // namespace
+
+Hull3D QuickHull3D(const std::vector<Vector<3>> &points) {
+  auto above = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t p) {
+    return -orient3d(points[a], points[b], points[c], points[p]);
+  };
+  auto at = [&](uint32_t i) {
+    return Point{points[i][0], points[i][1], points[i][2]};
+  };
+  return Builder(points.size(), above, at).run();
+}
+
+Hull3D LiftedHull(const std::vector<Vector<2>> &sites) {
+  // incircle has the sign of orient3d on the lifted sites
+  auto above = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t p) {
+    return -incircle(sites[a], sites[b], sites[c], sites[p]);
+  };
+  auto at = [&](uint32_t i) {
+    double x = sites[i][0], y = sites[i][1];
+    return Point{x, y, x * x + y * y};
+  };
+  return Builder(sites.size(), above, at).run();
+}
+
+} // namespace Math
+} // namespace Engine
@@ -0,0 +1,443 @@
+#include "Math/Predicates.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PREDICATES_SSE2
+#endif
+
+namespace Engine {
+namespace Math {
+
+namespace {
+
+// Half an ulp of 1, the relative error of one rounding
+const double EPSILON = std::numeric_limits<double>::epsilon() / 2;
+const double ORIENT_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+const double ORIENT3D_BOUND = (7.0 + 56.0 * EPSILON) * EPSILON;
+const double INCIRCLE_BOUND = (10.0 + 96.0 * EPSILON) * EPSILON;
+const double CROSSING_BOUND = (8.0 + 64.0 * EPSILON) * EPSILON;
+// One more rounding in every lifted coordinate
+const double POWER_BOUND = (11.0 + 112.0 * EPSILON) * EPSILON;
+
+// One writer per counter, so plain loads and stores instead of locked adds
+struct Counters {
+  std::atomic<uint64_t> calls = 0;
+  std::atomic<uint64_t> exact = 0;
+
+  void add(uint64_t n, uint64_t fallbacks) {
+    calls.store(calls.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+    if (fallbacks)
+      exact.store(exact.load(std::memory_order_relaxed) + fallbacks,
+                  std::memory_order_relaxed);
+  }
+};
+
+std::mutex s_countersMutex;
+// Kept after their thread exits so the totals never go back
+std::vector<std::unique_ptr<Counters>> s_counters;
+
+Counters &localCounters() {
+  thread_local Counters *counters = [] {
+    std::lock_guard lock(s_countersMutex);
+    s_counters.push_back(std::make_unique<Counters>());
+    return s_counters.back().get();
+  }();
+  return *counters;
+}
+
+// Expansions: sums of non-overlapping doubles, smallest magnitude first,
+// zero components dropped
+using Expansion = std::vector<double>;
+
+void twoSum(double a, double b, double &x, double &y) {
+  x = a + b;
+  double bv = x - a;
+  double av = x - bv;
+  y = (a - av) + (b - bv);
+}
+
+// Requires |a| >= |b|
+void fastTwoSum(double a, double b, double &x, double &y) {
+  x = a + b;
+  y = b - (x - a);
+}
+
+void twoProduct(double a, double b, double &x, double &y) {
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+Expansion difference(double a, double b) {
+  double x, y;
+  twoSum(a, -b, x, y);
+  Expansion e;
+  if (y != 0)
+    e.push_back(y);
+  if (x != 0)
+    e.push_back(x);
+  return e;
+}
+
+Expansion grow(const Expansion &e, double b) {
+  Expansion h;
+  h.reserve(e.size() + 1);
+  double q = b;
+  for (double component : e) {
+    double total, error;
+    twoSum(q, component, total, error);
+    if (error != 0)
+      h.push_back(error);
+    q = total;
+  }
+  if (q != 0)
+    h.push_back(q);
+  return h;
+}
+
+Expansion sum(const Expansion &e, const Expansion &f) {
+  Expansion h = e;
+  for (double component : f) {
+    h = grow(h, component);
+  }
+  return h;
+}
+
+Expansion scale(const Expansion &e, double b) {
+  Expansion h;
+  if (e.empty() || b == 0)
+    return h;
+
+  h.reserve(2 * e.size());
+  double q, error;
+  twoProduct(e[0], b, q, error);
+  if (error != 0)
+    h.push_back(error);
+
+  for (size_t i = 1; i < e.size(); i++) {
+    double high, low, partial;
+    twoProduct(e[i], b, high, low);
+    twoSum(q, low, partial, error);
+    if (error != 0)
+      h.push_back(error);
+    fastTwoSum(high, partial, q, error);
+    if (error != 0)
+      h.push_back(error);
+  }
+  if (q != 0)
+    h.push_back(q);
+  return h;
+}
+
+Expansion product(const Expansion &e, const Expansion &f) {
+  Expansion h;
+  for (double component : f) {
+    h = sum(h, scale(e, component));
+  }
+  return h;
+}
+
+Expansion negate(Expansion e) {
+  for (double &component : e) {
+    component = -component;
+  }
+  return e;
+}
+
+// The largest component carries the sign of the whole expansion
+double estimate(const Expansion &e) { return e.empty() ? 0 : e.back(); }
+
+double orient2dExact(const Vector<2> &a, const Vector<2> &b,
+                     const Vector<2> &c) {
+  Expansion acx = difference(a[0], c[0]), acy = difference(a[1], c[1]);
+  Expansion bcx = difference(b[0], c[0]), bcy = difference(b[1], c[1]);
+
+  return estimate(sum(product(acx, bcy), negate(product(acy, bcx))));
+}
+
+double orient3dExact(const Vector<3> &a, const Vector<3> &b,
+                     const Vector<3> &c, const Vector<3> &d) {
+  Expansion adx = difference(a[0], d[0]), ady = difference(a[1], d[1]);
+  Expansion bdx = difference(b[0], d[0]), bdy = difference(b[1], d[1]);
+  Expansion cdx = difference(c[0], d[0]), cdy = difference(c[1], d[1]);
+  Expansion adz = difference(a[2], d[2]), bdz = difference(b[2], d[2]);
+  Expansion cdz = difference(c[2], d[2]);
+
+  Expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  Expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  Expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+
+  return estimate(
+      sum(sum(product(adz, bc), product(bdz, ca)), product(cdz, ab)));
+}
+
+double incircleExact(const Vector<2> &a, const Vector<2> &b,
+                     const Vector<2> &c, const Vector<2> &d) {
+  Expansion adx = difference(a[0], d[0]), ady = difference(a[1], d[1]);
+  Expansion bdx = difference(b[0], d[0]), bdy = difference(b[1], d[1]);
+  Expansion cdx = difference(c[0], d[0]), cdy = difference(c[1], d[1]);
+
+  Expansion alift = sum(product(adx, adx), product(ady, ady));
+  Expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+  Expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+
+  Expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  Expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  Expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+
+  return estimate(sum(sum(product(alift, bc), product(blift, ca)),
+                      product(clift, ab)));
+}
+
+double powertestExact(const Vector<2> &a, float aw, const Vector<2> &b,
+                      float bw, const Vector<2> &c, float cw,
+                      const Vector<2> &d, float dw) {
+  Expansion adx = difference(a[0], d[0]), ady = difference(a[1], d[1]);
+  Expansion bdx = difference(b[0], d[0]), bdy = difference(b[1], d[1]);
+  Expansion cdx = difference(c[0], d[0]), cdy = difference(c[1], d[1]);
+
+  Expansion alift = sum(sum(product(adx, adx), product(ady, ady)),
+                        negate(difference(aw, dw)));
+  Expansion blift = sum(sum(product(bdx, bdx), product(bdy, bdy)),
+                        negate(difference(bw, dw)));
+  Expansion clift = sum(sum(product(cdx, cdx), product(cdy, cdy)),
+                        negate(difference(cw, dw)));
+
+  Expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  Expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  Expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+
+  return estimate(sum(sum(product(alift, bc), product(blift, ca)),
+                      product(clift, ab)));
+}
+
+double crossingOrderExact(const Vector<2> &a, const Vector<2> &b,
+                          const Vector<2> &c, const Vector<2> &d,
+                          const Vector<2> &s) {
+  Expansion bax = difference(b[0], a[0]), bay = difference(b[1], a[1]);
+  Expansion cax = difference(c[0], a[0]), cay = difference(c[1], a[1]);
+  Expansion dcx = difference(d[0], c[0]), dcy = difference(d[1], c[1]);
+
+  Expansion den = sum(product(bax, dcy), negate(product(bay, dcx)));
+  Expansion num = sum(product(cax, dcy), negate(product(cay, dcx)));
+
+  double order = estimate(
+      sum(product(difference(a[0], s[0]), den), product(num, bax)));
+  if (order == 0)
+    order = estimate(
+        sum(product(difference(a[1], s[1]), den), product(num, bay)));
+  return estimate(den) > 0 ? order : -order;
+}
+
+} // namespace
+
+double orient2d(const Vector<2> &a, const Vector<2> &b, const Vector<2> &c) {
+  double left = ((double)a[0] - c[0]) * ((double)b[1] - c[1]);
+  double right = ((double)a[1] - c[1]) * ((double)b[0] - c[0]);
+  double det = left - right;
+  double bound = ORIENT_BOUND * (std::fabs(left) + std::fabs(right));
+
+  if (det >= bound || -det >= bound) {
+    localCounters().add(1, 0);
+    return det;
+  }
+
+  localCounters().add(1, 1);
+  return orient2dExact(a, b, c);
+}
+
+double orient3d(const Vector<3> &a, const Vector<3> &b, const Vector<3> &c,
+                const Vector<3> &d) {
+  double adx = (double)a[0] - d[0], ady = (double)a[1] - d[1];
+  double bdx = (double)b[0] - d[0], bdy = (double)b[1] - d[1];
+  double cdx = (double)c[0] - d[0], cdy = (double)c[1] - d[1];
+  double adz = (double)a[2] - d[2], bdz = (double)b[2] - d[2];
+  double cdz = (double)c[2] - d[2];
+
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+  double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) +
+               cdz * (adxbdy - bdxady);
+  double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz) +
+                     (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz) +
+                     (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+  double bound = ORIENT3D_BOUND * permanent;
+
+  if (det > bound || -det > bound || permanent == 0) {
+    localCounters().add(1, 0);
+    return det;
+  }
+
+  localCounters().add(1, 1);
+  return orient3dExact(a, b, c, d);
+}
+
+double incircle(const Vector<2> &a, const Vector<2> &b, const Vector<2> &c,
+                const Vector<2> &d) {
+  double adx = (double)a[0] - d[0], ady = (double)a[1] - d[1];
+  double bdx = (double)b[0] - d[0], bdy = (double)b[1] - d[1];
+  double cdx = (double)c[0] - d[0], cdy = (double)c[1] - d[1];
+
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+  double alift = adx * adx + ady * ady;
+  double blift = bdx * bdx + bdy * bdy;
+  double clift = cdx * cdx + cdy * cdy;
+
+  double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+               clift * (adxbdy - bdxady);
+  double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift +
+                     (std::fabs(cdxady) + std::fabs(adxcdy)) * blift +
+                     (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+  double bound = INCIRCLE_BOUND * permanent;
+
+  if (det > bound || -det > bound || permanent == 0) {
+    localCounters().add(1, 0);
+    return det;
+  }
+
+  localCounters().add(1, 1);
+  return incircleExact(a, b, c, d);
+}
+
+double powertest(const Vector<2> &a, float aw, const Vector<2> &b, float bw,
+                 const Vector<2> &c, float cw, const Vector<2> &d, float dw) {
+  double adx = (double)a[0] - d[0], ady = (double)a[1] - d[1];
+  double bdx = (double)b[0] - d[0], bdy = (double)b[1] - d[1];
+  double cdx = (double)c[0] - d[0], cdy = (double)c[1] - d[1];
+  double adw = (double)aw - dw, bdw = (double)bw - dw, cdw = (double)cw - dw;
+
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+  double adistance = adx * adx + ady * ady;
+  double bdistance = bdx * bdx + bdy * bdy;
+  double cdistance = cdx * cdx + cdy * cdy;
+
+  double det = (adistance - adw) * (bdxcdy - cdxbdy) +
+               (bdistance - bdw) * (cdxady - adxcdy) +
+               (cdistance - cdw) * (adxbdy - bdxady);
+  double permanent =
+      (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * (adistance + std::fabs(adw)) +
+      (std::fabs(cdxady) + std::fabs(adxcdy)) * (bdistance + std::fabs(bdw)) +
+      (std::fabs(adxbdy) + std::fabs(bdxady)) * (cdistance + std::fabs(cdw));
+  double bound = POWER_BOUND * permanent;
+
+  if (det > bound || -det > bound || permanent == 0) {
+    localCounters().add(1, 0);
+    return det;
+  }
+
+  localCounters().add(1, 1);
+  return powertestExact(a, aw, b, bw, c, cw, d, dw);
+}
+
+// The crossing is a + t (b - a) with t = (c - a) x (d - c) / (b - a) x (d - c),
+// so its x is past s when ((a - s) den + num (b - a)) den is positive
+double crossingOrder(const Vector<2> &a, const Vector<2> &b,
+                     const Vector<2> &c, const Vector<2> &d,
+                     const Vector<2> &s) {
+  double bax = (double)b[0] - a[0], bay = (double)b[1] - a[1];
+  double cax = (double)c[0] - a[0], cay = (double)c[1] - a[1];
+  double dcx = (double)d[0] - c[0], dcy = (double)d[1] - c[1];
+  double asx = (double)a[0] - s[0];
+
+  double denLeft = bax * dcy, denRight = bay * dcx;
+  double numLeft = cax * dcy, numRight = cay * dcx;
+  double den = denLeft - denRight;
+  double order = asx * den + (numLeft - numRight) * bax;
+
+  double denBound = ORIENT_BOUND * (std::fabs(denLeft) + std::fabs(denRight));
+  double bound = CROSSING_BOUND *
+                 (std::fabs(asx) * (std::fabs(denLeft) + std::fabs(denRight)) +
+                  std::fabs(bax) * (std::fabs(numLeft) + std::fabs(numRight)));
+
+  if ((den > denBound || -den > denBound) &&
+      (order > bound || -order > bound)) {
+    localCounters().add(1, 0);
+    return den > 0 ? order : -order;
+  }
+
+  localCounters().add(1, 1);
+  return crossingOrderExact(a, b, c, d, s);
+}
+
+void orient2d(const Vector<2> &a, const Vector<2> &b, const Vector<2> *points,
+              size_t count, double *sides) {
+  static_assert(sizeof(Vector<2>) == 2 * sizeof(float));
+
+  // orient2d(b, p, a) in the filter's form, the same sign as (a, b, p) with
+  // the line's differences shared by every point
+  double abx = (double)b[0] - a[0], aby = (double)b[1] - a[1];
+  uint64_t fallbacks = 0;
+  size_t i = 0;
+
+#ifdef PREDICATES_SSE2
+  const float *coords = reinterpret_cast<const float *>(points);
+  __m128d ax = _mm_set1_pd(a[0]), ay = _mm_set1_pd(a[1]);
+  __m128d dx = _mm_set1_pd(abx), dy = _mm_set1_pd(aby);
+  __m128d error = _mm_set1_pd(ORIENT_BOUND);
+  __m128d sign = _mm_set1_pd(-0.0);
+
+  for (; i + 2 <= count; i += 2) {
+    __m128 xy = _mm_loadu_ps(coords + 2 * i);
+    __m128d p0 = _mm_cvtps_pd(xy);
+    __m128d p1 = _mm_cvtps_pd(_mm_movehl_ps(xy, xy));
+    __m128d px = _mm_unpacklo_pd(p0, p1), py = _mm_unpackhi_pd(p0, p1);
+
+    __m128d left = _mm_mul_pd(dx, _mm_sub_pd(py, ay));
+    __m128d right = _mm_mul_pd(dy, _mm_sub_pd(px, ax));
+    __m128d det = _mm_sub_pd(left, right);
+    __m128d bound = _mm_mul_pd(error, _mm_add_pd(_mm_andnot_pd(sign, left),
+                                                 _mm_andnot_pd(sign, right)));
+    _mm_storeu_pd(sides + i, det);
+
+    int settled = _mm_movemask_pd(_mm_cmpge_pd(_mm_andnot_pd(sign, det), bound));
+    for (int k = 0; k < 2; k++) {
+      if (!(settled & (1 << k))) {
+        sides[i + k] = orient2dExact(b, points[i + k], a);
+        fallbacks++;
+      }
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    double left = abx * ((double)points[i][1] - a[1]);
+    double right = aby * ((double)points[i][0] - a[0]);
+    double det = left - right;
+    double bound = ORIENT_BOUND * (std::fabs(left) + std::fabs(right));
+
+    if (det >= bound || -det >= bound) {
+      sides[i] = det;
+    } else {
+      sides[i] = orient2dExact(b, points[i], a);
+      fallbacks++;
+    }
+  }
+
+  localCounters().add(count, fallbacks);
+}
+
+PredicateStats predicateStats() {
+  PredicateStats stats;
+  std::lock_guard lock(s_countersMutex);
+  for (const auto &counters : s_counters) {
+    stats.calls += counters->calls.load(std::memory_order_relaxed);
+    stats.exact += counters->exact.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+} // namespace Math
+} // namespace Engine
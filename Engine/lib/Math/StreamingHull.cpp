@@ -0,0 +1,162 @@
+#include "Math/StreamingHull.hpp"
+
+#include "Math/Hull.hpp"
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STREAMING_MMAP
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace Engine {
+namespace Math {
+
+namespace {
+
+using Vec2 = Vector<2>;
+using Clock = std::chrono::steady_clock;
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float),
+              "points are read as float pairs");
+
+// Points per slice hulled by one job
+const size_t SLICE = 1 << 16;
+
+// One chunk is read while the previous one is hulled
+void ReadChunks(std::FILE *file, StreamingHull &hull, size_t chunk,
+                StreamStats &stats) {
+  std::vector<Vec2> reading(chunk), hulling(chunk);
+  size_t count = std::fread(reading.data(), sizeof(Vec2), chunk, file);
+  while (count > 0) {
+    reading.swap(hulling);
+    JobSystem::Counter counter;
+    JobSystem::get().submit(
+        [&, count]() { hull.add(hulling.data(), count); }, &counter);
+    stats.points += count;
+    count = std::fread(reading.data(), sizeof(Vec2), chunk, file);
+    JobSystem::get().wait(counter);
+  }
+
+  if (std::ferror(file))
+    throw std::runtime_error("Could not read the points");
+}
+
+// False when the file cannot be mapped: a pipe, an empty file or no mmap
+#ifdef STREAMING_MMAP
+bool MapChunks(const std::string &path, StreamingHull &hull, size_t chunk,
+               StreamStats &stats) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  void *mapping = MAP_FAILED;
+  size_t bytes = 0;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    bytes = info.st_size;
+    mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping keeps the file open
+  close(fd);
+  if (mapping == MAP_FAILED)
+    return false;
+
+  madvise(mapping, bytes, MADV_SEQUENTIAL);
+  const Vec2 *points = static_cast<const Vec2 *>(mapping);
+  size_t count = bytes / sizeof(Vec2);
+  // Page aligned, as the mapping
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t step = std::max(chunk * sizeof(Vec2) / page, (size_t)1) * page;
+  step /= sizeof(Vec2);
+
+  for (size_t begin = 0; begin < count; begin += step) {
+    size_t end = std::min(begin + step, count);
+    if (end < count) {
+      size_t ahead = std::min(end + step, count) - end;
+      madvise((void *)(points + end), ahead * sizeof(Vec2), MADV_WILLNEED);
+    }
+    hull.add(points + begin, end - begin);
+    stats.points += end - begin;
+    // Clean pages of the file, read again from it if ever touched
+    madvise((void *)(points + begin), (end - begin) * sizeof(Vec2),
+            MADV_DONTNEED);
+  }
+
+  munmap(mapping, bytes);
+  stats.mapped = true;
+  return true;
+}
+#else
+bool MapChunks(const std::string &, StreamingHull &, size_t, StreamStats &) {
+  return false;
+}
+#endif
+
+} // namespace
+
+void StreamingHull::add(const Vec2 *points, size_t count) {
+  size_t slices = (count + SLICE - 1) / SLICE;
+  std::vector<std::vector<Vec2>> hulls(slices);
+  JobSystem::get().parallelFor(0, slices, 1, [&](size_t begin, size_t end) {
+    for (size_t s = begin; s < end; s++) {
+      const Vec2 *first = points + s * SLICE;
+      const Vec2 *last = points + std::min(count, (s + 1) * SLICE);
+      std::vector<Vec2> slice(first, last);
+      DiscardInterior(slice);
+      hulls[s] = QuickHull(std::move(slice));
+    }
+  });
+
+  for (const std::vector<Vec2> &slice : hulls) {
+    m_hull = MergeHulls(m_hull, slice);
+  }
+  m_count += count;
+}
+
+void StreamingHull::clear() {
+  m_hull.clear();
+  m_count = 0;
+}
+
+StreamStats StreamHull(const std::string &path, StreamingHull &hull,
+                       size_t chunk) {
+  StreamStats stats;
+  auto start = Clock::now();
+
+  if (path == "-") {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    ReadChunks(stdin, hull, chunk, stats);
+  } else if (!MapChunks(path, hull, chunk, stats)) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+      throw std::runtime_error("Could not open " + path);
+    try {
+      ReadChunks(file, hull, chunk, stats);
+    } catch (...) {
+      std::fclose(file);
+      throw;
+    }
+    std::fclose(file);
+  }
+
+  stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return stats;
+}
+
+} // namespace Math
+} // namespace Engine
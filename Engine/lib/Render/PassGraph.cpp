@@ -0,0 +1,149 @@
+#include "Render/PassGraph.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace Engine {
+namespace Render {
+
+uint32_t PassGraph::Frame::resolve(uint32_t resources) const {
+  if (resources & aliased) {
+    resources &= ~aliased;
+    resources |= BACKBUFFER;
+  }
+
+  return resources;
+}
+
+PassGraph::~PassGraph() {
+  for (auto &query : m_queries) {
+    glDeleteQueries(2, query.id);
+  }
+}
+
+void PassGraph::addPass(Pass pass) {
+  Query query;
+  glGenQueries(2, query.id);
+
+  m_timings.push_back({pass.name});
+  m_queries.push_back(query);
+  m_passes.push_back(std::move(pass));
+}
+
+bool PassGraph::removePass(const std::string &name) {
+  auto it = std::find_if(m_passes.begin(), m_passes.end(),
+                         [&](const Pass &pass) { return pass.name == name; });
+  if (it == m_passes.end())
+    return false;
+
+  size_t i = std::distance(m_passes.begin(), it);
+  glDeleteQueries(2, m_queries[i].id);
+
+  m_passes.erase(it);
+  m_queries.erase(std::next(m_queries.begin(), i));
+  m_timings.erase(std::next(m_timings.begin(), i));
+  return true;
+}
+
+PassGraph::Pass *PassGraph::find(const std::string &name) {
+  auto it = std::find_if(m_passes.begin(), m_passes.end(),
+                         [&](const Pass &pass) { return pass.name == name; });
+  return it == m_passes.end() ? nullptr : &*it;
+}
+
+// Walks the passes backwards from the requested sinks, keeping only the ones
+// whose outputs are consumed. Copy passes whose source has no other reader
+// are dropped and their source aliased to the destination, as long as the
+// source is produced this frame (otherwise it holds retained contents).
+std::vector<bool> PassGraph::cull(uint32_t sinks, Frame &frame) const {
+  std::vector<bool> live(m_passes.size(), false);
+
+  uint32_t required = sinks;
+  for (size_t i = m_passes.size(); i-- > 0;) {
+    const Pass &pass = m_passes[i];
+    if (pass.enabled && !pass.enabled())
+      continue;
+
+    if (pass.writes & required) {
+      live[i] = true;
+      required |= pass.reads;
+    }
+  }
+
+  for (size_t i = 0; i < m_passes.size(); i++) {
+    const Pass &pass = m_passes[i];
+    if (!live[i] || !pass.copy || pass.writes != BACKBUFFER)
+      continue;
+
+    bool consumed = false, produced = false;
+    for (size_t j = 0; j < m_passes.size(); j++) {
+      if (j == i || !live[j])
+        continue;
+
+      consumed |= (m_passes[j].reads & pass.reads) != 0;
+      produced |= (m_passes[j].writes & pass.reads) != 0;
+    }
+
+    if (produced && !consumed) {
+      live[i] = false;
+      frame.aliased |= pass.reads;
+    }
+  }
+
+  return live;
+}
+
+void PassGraph::collectGpuTime(size_t i) {
+  Query &query = m_queries[i];
+  if (!query.pending[m_parity])
+    return;
+
+  int available = 0;
+  glGetQueryObjectiv(query.id[m_parity], GL_QUERY_RESULT_AVAILABLE,
+                     &available);
+  if (!available)
+    return;
+
+  uint64_t ns = 0;
+  glGetQueryObjectui64v(query.id[m_parity], GL_QUERY_RESULT, &ns);
+  m_timings[i].gpuMs = ns / 1e6;
+  query.pending[m_parity] = false;
+}
+
+void PassGraph::execute(uint32_t sinks) {
+  Frame frame;
+  std::vector<bool> live = cull(sinks, frame);
+
+  m_parity ^= 1;
+  for (size_t i = 0; i < m_passes.size(); i++) {
+    collectGpuTime(i);
+
+    Timing &timing = m_timings[i];
+    timing.ran = live[i];
+    if (!live[i]) {
+      timing.cpuMs = 0;
+      continue;
+    }
+
+    // Only time on the GPU when the previous result in this slot was read,
+    // otherwise reusing the query would stall on it.
+    Query &query = m_queries[i];
+    bool timed = !query.pending[m_parity];
+    if (timed)
+      glBeginQuery(GL_TIME_ELAPSED, query.id[m_parity]);
+
+    auto start = Clock::now();
+    m_passes[i].execute(frame);
+    timing.cpuMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    if (timed) {
+      glEndQuery(GL_TIME_ELAPSED);
+      query.pending[m_parity] = true;
+    }
+  }
+}
+
+} // namespace Render
+} // namespace Engine
@@ -0,0 +1,444 @@
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr size_t NO_WORKER = std::numeric_limits<size_t>::max();
+// Failed find() attempts before a worker goes to sleep
+constexpr size_t SPINS = 64;
+
+thread_local size_t t_index = NO_WORKER;
+} // namespace
+
+// Chase-Lev work stealing deque ("Correct and Efficient Work-Stealing for
+// Weak Memory Models", Le et al. 2013). Grown arrays are kept alive until
+// the deque dies since a thief may still be reading the old one.
+class JobSystem::Deque {
+public:
+  Deque() {
+    m_arrays.emplace_back(new Array(64));
+    m_array = m_arrays.back().get();
+  }
+
+  void push(Task *task) {
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    Array *array = m_array.load(std::memory_order_relaxed);
+
+    if (b - t > static_cast<int64_t>(array->capacity()) - 1) {
+      array = grow(array, t, b);
+    }
+
+    array->put(b, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  Task *pop() {
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    Array *array = m_array.load(std::memory_order_relaxed);
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    Task *task = array->get(b);
+    if (t == b) {
+      // Last element, race the thieves for it
+      if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+        task = nullptr;
+      }
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return task;
+  }
+
+  Task *steal() {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+      return nullptr;
+
+    Array *array = m_array.load(std::memory_order_acquire);
+    Task *task = array->get(t);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;
+    }
+
+    return task;
+  }
+
+private:
+  class Array {
+  public:
+    explicit Array(size_t capacity)
+        : m_mask(capacity - 1), m_data(new std::atomic<Task *>[capacity]) {}
+
+    size_t capacity() const { return m_mask + 1; }
+
+    Task *get(int64_t i) const {
+      return m_data[i & m_mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, Task *task) {
+      m_data[i & m_mask].store(task, std::memory_order_relaxed);
+    }
+
+  private:
+    size_t m_mask;
+    std::unique_ptr<std::atomic<Task *>[]> m_data;
+  };
+
+  Array *grow(Array *old, int64_t t, int64_t b) {
+    m_arrays.emplace_back(new Array(old->capacity() * 2));
+    Array *array = m_arrays.back().get();
+
+    for (int64_t i = t; i < b; i++) {
+      array->put(i, old->get(i));
+    }
+
+    m_array.store(array, std::memory_order_release);
+    return array;
+  }
+
+  std::atomic<int64_t> m_top = 0;
+  std::atomic<int64_t> m_bottom = 0;
+  std::atomic<Array *> m_array;
+  std::vector<std::unique_ptr<Array>> m_arrays;
+};
+
+JobSystem &JobSystem::get() {
+  static JobSystem instance;
+  return instance;
+}
+
+JobSystem::JobSystem() {
+  size_t count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  count = std::max<size_t>(count, 1);
+
+  // Slot 0 is left to the main thread once bound, which runs jobs while
+  // waiting. Until then every thread outside the pool submits through the
+  // injection queue
+  for (size_t i = 0; i <= count; i++) {
+    auto worker = std::make_unique<Worker>();
+    worker->deque = std::make_unique<Deque>();
+    m_workers.push_back(std::move(worker));
+  }
+
+  m_statsStart = Clock::now();
+
+  for (size_t i = 1; i <= count; i++) {
+    m_workers[i]->thread = std::thread(&JobSystem::loop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  m_running = false;
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+  }
+  m_sleep.notify_all();
+
+  for (auto &worker : m_workers) {
+    if (worker->thread.joinable())
+      worker->thread.join();
+  }
+}
+
+size_t JobSystem::workers() const { return m_workers.size() - 1; }
+
+void JobSystem::submit(Job job, Counter *counter) {
+  if (counter)
+    counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+
+  Task *task = new Task{std::move(job), counter};
+  if (t_index != NO_WORKER) {
+    m_workers[t_index]->deque->push(task);
+  } else {
+    std::lock_guard<std::mutex> lock(m_injectMutex);
+    m_inject.push_back(task);
+  }
+
+  m_queued.fetch_add(1);
+  if (m_sleeping.load() > 0) {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_sleep.notify_one();
+  }
+}
+
+void JobSystem::wait(Counter &counter) {
+  while (!counter.done()) {
+    if (!runOne(t_index))
+      std::this_thread::yield();
+  }
+
+  if (counter.m_error) {
+    std::exception_ptr error = counter.m_error;
+    counter.m_error = nullptr;
+    // The counter may be reused, its next failure is recorded again
+    counter.m_failed.store(false, std::memory_order_relaxed);
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain,
+                            const std::function<void(size_t, size_t)> &body) {
+  if (end <= begin)
+    return;
+
+  // A few chunks per thread so stealing can even out uneven work
+  size_t count = end - begin;
+  size_t slices = m_workers.size() * 4;
+  size_t chunk = std::max({grain, size_t(1), (count + slices - 1) / slices});
+
+  if (chunk >= count) {
+    body(begin, end);
+    return;
+  }
+
+  Counter counter;
+  size_t from = begin;
+  for (; from + chunk < end; from += chunk) {
+    size_t to = from + chunk;
+    submit([&body, from, to]() { body(from, to); }, &counter);
+  }
+
+  // The queued chunks hold references to body and counter, so they must be
+  // finished before an exception thrown here leaves the frame
+  try {
+    body(from, end);
+  } catch (...) {
+    wait(counter);
+    throw;
+  }
+  wait(counter);
+}
+
+void JobSystem::runOnMainThread(Job job) {
+  std::function<void()> wake;
+  {
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainJobs.push_back(std::move(job));
+    wake = m_mainWake;
+  }
+
+  if (wake)
+    wake();
+}
+
+void JobSystem::pumpMainThread() {
+  std::vector<Job> jobs;
+  {
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    jobs.swap(m_mainJobs);
+  }
+
+  for (auto &job : jobs) {
+    job();
+  }
+}
+
+bool JobSystem::hasMainThreadWork() {
+  std::lock_guard<std::mutex> lock(m_mainMutex);
+  return !m_mainJobs.empty();
+}
+
+bool JobSystem::isMainThread() const {
+  return std::this_thread::get_id() == m_mainThread.load();
+}
+
+void JobSystem::bindMainThread() {
+  std::thread::id self = std::this_thread::get_id();
+  std::thread::id bound;
+  if (!m_mainThread.compare_exchange_strong(bound, self) && bound != self)
+    throw std::runtime_error("JobSystem main thread already bound");
+  if (t_index != NO_WORKER && t_index != 0)
+    throw std::runtime_error("A JobSystem worker cannot be the main thread");
+
+  t_index = 0;
+}
+
+void JobSystem::setMainThreadWake(std::function<void()> wake) {
+  std::lock_guard<std::mutex> lock(m_mainMutex);
+  m_mainWake = std::move(wake);
+}
+
+JobSystem::Stats JobSystem::stats() {
+  auto now = Clock::now();
+  double elapsed = std::chrono::duration<double, std::nano>(now - m_statsStart)
+                       .count();
+  m_statsStart = now;
+
+  Stats stats;
+  stats.executed = m_executed.exchange(0);
+  stats.stolen = m_stolen.exchange(0);
+
+  for (auto &worker : m_workers) {
+    double busy = static_cast<double>(worker->busyNs.exchange(0));
+    stats.utilisation.push_back(elapsed > 0 ? std::min(1.0, busy / elapsed)
+                                            : 0.0);
+  }
+
+  return stats;
+}
+
+void JobSystem::loop(size_t index) {
+  t_index = index;
+  size_t idle = 0;
+
+  while (m_running.load(std::memory_order_relaxed)) {
+    if (runOne(index)) {
+      idle = 0;
+      continue;
+    }
+
+    if (++idle < SPINS) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_sleeping.fetch_add(1);
+    m_sleep.wait(lock, [this]() { return m_queued.load() > 0 || !m_running; });
+    m_sleeping.fetch_sub(1);
+    idle = 0;
+  }
+}
+
+bool JobSystem::runOne(size_t index) {
+  Task *task = find(index);
+  if (!task)
+    return false;
+
+  execute(index, task);
+  return true;
+}
+
+// Own deque first, then the injection queue, then steal from the others
+JobSystem::Task *JobSystem::find(size_t index) {
+  Task *task = nullptr;
+  if (index != NO_WORKER)
+    task = m_workers[index]->deque->pop();
+
+  if (!task) {
+    std::lock_guard<std::mutex> lock(m_injectMutex);
+    if (!m_inject.empty()) {
+      task = m_inject.front();
+      m_inject.pop_front();
+    }
+  }
+
+  if (!task) {
+    size_t count = m_workers.size();
+    size_t start = index == NO_WORKER ? 0 : index + 1;
+    for (size_t i = 0; i < count && !task; i++) {
+      size_t victim = (start + i) % count;
+      if (victim == index)
+        continue;
+
+      task = m_workers[victim]->deque->steal();
+      if (task)
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  if (task)
+    m_queued.fetch_sub(1);
+
+  return task;
+}
+
+void JobSystem::execute(size_t index, Task *task) {
+  auto start = Clock::now();
+
+  try {
+    task->job();
+  } catch (...) {
+    if (task->counter && !task->counter->m_failed.exchange(true))
+      task->counter->m_error = std::current_exception();
+  }
+
+  if (index != NO_WORKER) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  Clock::now() - start)
+                  .count();
+    m_workers[index]->busyNs.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  m_executed.fetch_add(1, std::memory_order_relaxed);
+  if (task->counter)
+    task->counter->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+
+  delete task;
+}
+
+TaskGraph::TaskID TaskGraph::add(JobSystem::Job job) {
+  Node &node = m_nodes.emplace_back();
+  node.job = std::move(job);
+  return m_nodes.size() - 1;
+}
+
+void TaskGraph::precede(TaskID before, TaskID after) {
+  m_nodes.at(before).successors.push_back(after);
+  m_nodes.at(after).dependencies++;
+}
+
+void TaskGraph::run() {
+  // Kahn's algorithm, only to reject cycles before anything runs
+  std::vector<size_t> indegree(m_nodes.size());
+  std::vector<TaskID> ready;
+  for (TaskID id = 0; id < m_nodes.size(); id++) {
+    indegree[id] = m_nodes[id].dependencies;
+    if (indegree[id] == 0)
+      ready.push_back(id);
+  }
+
+  size_t visited = 0;
+  for (size_t i = 0; i < ready.size(); i++, visited++) {
+    for (TaskID next : m_nodes[ready[i]].successors) {
+      if (--indegree[next] == 0)
+        ready.push_back(next);
+    }
+  }
+
+  if (visited != m_nodes.size())
+    throw std::runtime_error("TaskGraph has a cycle");
+
+  JobSystem::Counter counter;
+  for (auto &node : m_nodes) {
+    node.remaining = node.dependencies;
+  }
+
+  for (TaskID id = 0; id < m_nodes.size(); id++) {
+    if (m_nodes[id].dependencies == 0)
+      schedule(id, counter);
+  }
+
+  JobSystem::get().wait(counter);
+}
+
+void TaskGraph::schedule(TaskID id, JobSystem::Counter &counter) {
+  JobSystem::get().submit(
+      [this, id, &counter]() {
+        Node &node = m_nodes[id];
+        node.job();
+
+        for (TaskID next : node.successors) {
+          if (m_nodes[next].remaining.fetch_sub(1) == 1)
+            schedule(next, counter);
+        }
+      },
+      &counter);
+}
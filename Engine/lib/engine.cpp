@@ -4,12 +4,14 @@
 #include "Objects/ObjectManager.hpp"
 
 #include "Objects/ObjectUUID.hpp"
+#include "Objects/ObjectVAO.hpp"
 #include "Solvers/Instanced.hpp"
 #include "Wrappers/Line.hpp"
 #include "Wrappers/Point.hpp"
 
 #include <glad/glad.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
@@ -46,15 +48,17 @@ Engine *Engine::init(GLADloadproc proc, Math::Vector<2, uint32_t> &windowSize) {
     glDeleteRenderbuffers(1, &m_instance->m_rboDepthStencil);
   }
 
+  m_instance->setupPasses();
+
   return m_instance.get();
 }
 
 Engine *Engine::get() { return m_instance.get(); }
 
 bool Engine::resize(double w, double h) {
-  unsigned int rboDepthStencil;
   m_windowSize[0] = w;
   m_windowSize[1] = h;
+  m_idGeneration = std::nullopt;
 
   glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
 
@@ -104,32 +108,111 @@ bool Engine::resize(double w, double h) {
   return true;
 }
 
-void Engine::draw() {
+// Scene -> ObjectID -> Present. Present is elided (the scene is drawn straight
+// into the default framebuffer) unless another pass reads SCENE_COLOR, and
+// ObjectID only runs when a lookup finds the ID buffer stale.
+void Engine::setupPasses() {
+  m_passGraph.addPass({
+      .name = "Scene",
+      .writes = Render::SCENE_COLOR,
+      .execute =
+          [this](const Render::PassGraph::Frame &frame) {
+            bindTarget(frame.resolve(Render::SCENE_COLOR));
+            glClearColor(0, 0, 0, 255);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawBackground();
+            drawScene();
+          },
+  });
+
+  m_passGraph.addPass({
+      .name = "ObjectID",
+      .writes = Render::OBJECT_ID,
+      .execute =
+          [this](const Render::PassGraph::Frame &frame) {
+            bindTarget(Render::OBJECT_ID);
+            unsigned int clearID[4] = {0, 0, 0, 0};
+            glClearBufferuiv(GL_COLOR, 1, clearID);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawScene();
+            m_idGeneration = sceneGeneration();
+          },
+  });
+
+  m_passGraph.addPass({
+      .name = "Present",
+      .reads = Render::SCENE_COLOR,
+      .writes = Render::BACKBUFFER,
+      .copy = true,
+      .execute =
+          [this](const Render::PassGraph::Frame &frame) {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fboID);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+            glBlitFramebuffer(0, 0, m_windowSize[0], m_windowSize[1], 0, 0,
+                              m_windowSize[0], m_windowSize[1],
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+          },
+  });
+}
+
+void Engine::bindTarget(uint32_t resources) {
+  if (resources & Render::BACKBUFFER) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return;
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
-  glClearColor(0, 0, 0, 255);
-  unsigned int clearID[2] = {0, 0};
-  glClearBufferuiv(GL_COLOR, 1, clearID); // Clear attachment 1
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glEnable(GL_DEPTH_TEST);
+  unsigned int attachments[2] = {GL_NONE, GL_NONE};
+  if (resources & Render::SCENE_COLOR)
+    attachments[0] = GL_COLOR_ATTACHMENT0;
+  if (resources & Render::OBJECT_ID)
+    attachments[1] = GL_COLOR_ATTACHMENT1;
+  glDrawBuffers(2, attachments);
+}
+
+// Into the bound draw framebuffer, whose ID attachment is never a blit target
+void Engine::drawBackground() {
+  if (!m_backgroundWidth || !m_backgroundHeight)
+    return;
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_backgroundFboID);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBlitFramebuffer(0, 0, m_backgroundWidth, m_backgroundHeight, 0, 0,
+                    m_windowSize[0], m_windowSize[1], GL_COLOR_BUFFER_BIT,
+                    GL_NEAREST);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+// Meshes first, then the layers in order. Everything is painted in order,
+// depth would only fight it
+void Engine::drawScene() {
+  glDisable(GL_DEPTH_TEST);
 
   glBindBuffer(GL_UNIFORM_BUFFER, m_instance->uboMatrices);
+  drawMeshes();
   m_objManager.draw();
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
 
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fboID);
+// Both only grow, their sum changes whenever either does
+uint64_t Engine::sceneGeneration() {
+  return m_objManager.generation() + m_meshGeneration;
+}
 
-  glReadBuffer(GL_COLOR_ATTACHMENT0);
+void Engine::draw() {
+  m_frame++;
 
-  glBlitFramebuffer(0, 0, m_windowSize[0], m_windowSize[1], // Source rectangle
-                    0, 0, m_windowSize[0],
-                    m_windowSize[1],     // Destination rectangle
-                    GL_COLOR_BUFFER_BIT, // Buffers to copy
-                    GL_NEAREST           // Filter to use if scaling
-  );
+  uint32_t sinks = Render::BACKBUFFER;
+  if (m_pickInterval && m_frame % m_pickInterval == 0) {
+    sinks |= Render::OBJECT_ID;
+  }
 
-  // Unbind the read framebuffer
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  m_passGraph.execute(sinks);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 int Engine::getType(Objects::ObjectUUID::UUID id) {
@@ -141,6 +224,11 @@ int Engine::getType(Objects::ObjectUUID::UUID id) {
 }
 
 Objects::ObjectUUID::UUID Engine::lookupObjectUUID(int x, int y) {
+  if (m_idGeneration != sceneGeneration()) {
+    m_passGraph.execute(Render::OBJECT_ID);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
   glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fboID);
   glReadBuffer(GL_COLOR_ATTACHMENT1);
 
@@ -216,15 +304,205 @@ void Engine::remove(Objects::ObjectUUID::UUID id) {
 
 void Engine::clear() { m_objManager.clear(); }
 
+Engine::LayerID Engine::createLayer(const std::string &name,
+                                    Objects::Layer::Policy policy,
+                                    int32_t order) {
+  return m_objManager.createLayer(name, policy, order);
+}
+
+std::optional<Engine::LayerID> Engine::findLayer(const std::string &name) {
+  return m_objManager.findLayer(name);
+}
+
+void Engine::useLayer(LayerID layer) { m_objManager.setActiveLayer(layer); }
+
+void Engine::clearLayer(LayerID layer) { m_objManager.clearLayer(layer); }
+
+void Engine::setLayerVisible(LayerID layer, bool visible) {
+  m_objManager.setLayerVisible(layer, visible);
+}
+
+void Engine::setLayerOrder(LayerID layer, int32_t order) {
+  m_objManager.setLayerOrder(layer, order);
+}
+
+void Engine::setBackground(const uint8_t *rgba, uint32_t width,
+                           uint32_t height) {
+  if (!m_backgroundFboID) {
+    glGenFramebuffers(1, &m_backgroundFboID);
+    glGenTextures(1, &m_backgroundTextureID);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, m_backgroundTextureID);
+  if (width == m_backgroundWidth && height == m_backgroundHeight) {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                    GL_UNSIGNED_BYTE, rgba);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, rgba);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_backgroundFboID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           m_backgroundTextureID, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  m_backgroundWidth = width;
+  m_backgroundHeight = height;
+}
+
+void Engine::clearBackground() {
+  m_backgroundWidth = 0;
+  m_backgroundHeight = 0;
+}
+
+uint32_t Engine::createMesh(const Objects::MeshView &view) {
+  uint32_t id = m_nextMeshID++;
+  Objects::MeshData &mesh = m_meshes[id];
+  glGenBuffers(4, mesh.buffers);
+  updateMesh(id, view);
+  return id;
+}
+
+void Engine::updateMesh(uint32_t id, const Objects::MeshView &view) {
+  m_meshGeneration++;
+  static_assert(sizeof(Math::Vector<2>) == 2 * sizeof(float));
+  static_assert(sizeof(Math::Vector<3>) == 3 * sizeof(float));
+
+  Objects::MeshData &mesh = m_meshes.at(id);
+  const void *arrays[4] = {view.vertices, view.halfEdges, view.faces,
+                           view.faceColors};
+  size_t sizes[4] = {view.vertexCount * sizeof(Math::Vector<2>),
+                     view.halfEdgeCount * 4 * sizeof(uint32_t),
+                     view.faceCount * sizeof(uint32_t),
+                     view.faceColors ? view.faceCount * sizeof(Math::Vector<3>)
+                                     : 0};
+  for (int i = 0; i < 4; i++) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh.buffers[i]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizes[i], arrays[i],
+                 GL_DYNAMIC_DRAW);
+    mesh.capacities[i] = sizes[i];
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  mesh.halfEdgeCount = view.halfEdgeCount;
+  mesh.fill = view.faceColors && view.faceCount;
+  mesh.edgeColor = view.edgeColor;
+  mesh.stroke = view.stroke;
+}
+
+void Engine::patchMesh(uint32_t id, const Objects::MeshView &view,
+                       const Objects::MeshPatch &patch) {
+  m_meshGeneration++;
+  Objects::MeshData &mesh = m_meshes.at(id);
+  if (mesh.fill != (view.faceColors && view.faceCount)) {
+    updateMesh(id, view);
+    return;
+  }
+
+  const void *arrays[4] = {view.vertices, view.halfEdges, view.faces,
+                           view.faceColors};
+  size_t strides[4] = {sizeof(Math::Vector<2>), 4 * sizeof(uint32_t),
+                       sizeof(uint32_t), sizeof(Math::Vector<3>)};
+  uint32_t counts[4] = {view.vertexCount, view.halfEdgeCount, view.faceCount,
+                        view.faceColors ? view.faceCount : 0};
+  const std::vector<Objects::MeshRange> *ranges[4] = {
+      &patch.vertices, &patch.halfEdges, &patch.faces, &patch.faces};
+
+  for (int i = 0; i < 4; i++) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh.buffers[i]);
+    size_t size = counts[i] * strides[i];
+    const uint8_t *data = static_cast<const uint8_t *>(arrays[i]);
+    if (size > mesh.capacities[i]) {
+      // Room for the next ones
+      mesh.capacities[i] = 2 * size;
+      glBufferData(GL_SHADER_STORAGE_BUFFER, mesh.capacities[i], nullptr,
+                   GL_DYNAMIC_DRAW);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+      continue;
+    }
+
+    for (const Objects::MeshRange &range : *ranges[i]) {
+      uint32_t end = std::min(range.end, counts[i]);
+      if (range.begin < end)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, range.begin * strides[i],
+                        (end - range.begin) * strides[i],
+                        data + range.begin * strides[i]);
+    }
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  mesh.halfEdgeCount = view.halfEdgeCount;
+  mesh.edgeColor = view.edgeColor;
+  mesh.stroke = view.stroke;
+}
+
+void Engine::removeMesh(uint32_t id) {
+  m_meshGeneration++;
+  auto it = m_meshes.find(id);
+  if (it == m_meshes.end())
+    return;
+
+  glDeleteBuffers(4, it->second.buffers);
+  m_meshes.erase(it);
+}
+
+void Engine::drawMeshes() {
+  m_meshDrawCalls = 0;
+  if (m_meshes.empty())
+    return;
+
+  Shader &faces = m_shaderManager.at("MeshFace");
+  Shader &edges = m_shaderManager.at("MeshEdge");
+  // Attributes are not read, but core profiles need a vertex array bound
+  glBindVertexArray(Objects::ObjectVAO::get());
+
+  for (const auto &[id, mesh] : m_meshes) {
+    if (mesh.halfEdgeCount == 0)
+      continue;
+
+    for (uint32_t i = 0; i < (mesh.fill ? 4 : 2); i++) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, mesh.buffers[i]);
+    }
+
+    // A fan per face, one triangle per half-edge
+    if (mesh.fill) {
+      faces.bind();
+      m_meshDrawCalls++;
+      glDrawArrays(GL_TRIANGLES, 0, 3 * mesh.halfEdgeCount);
+      faces.unbind();
+    }
+
+    // A quad per half-edge, empty for the second half of every edge
+    edges.bind();
+    edges.set("edgeColor", mesh.edgeColor);
+    edges.set("stroke", mesh.stroke);
+    m_meshDrawCalls++;
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, mesh.halfEdgeCount);
+    edges.unbind();
+  }
+
+  glBindVertexArray(0);
+}
+
 void Engine::setWinSize(Math::Vector<2, float> m_windowSize) {
   resize(m_windowSize[0], m_windowSize[1]);
 }
 
-uint32_t Engine::drawCalls() { return m_objManager.drawCalls(); }
+uint32_t Engine::drawCalls() {
+  return m_objManager.drawCalls() + m_meshDrawCalls;
+}
 uint32_t Engine::entities() { return m_objManager.entities(); }
 Objects::ObjectManager::ObjectCount Engine::count() {
   return m_objManager.count();
 }
 Math::Vector<2, uint32_t> Engine::winSize() { return m_windowSize; }
 
+void Engine::setPickInterval(uint32_t frames) { m_pickInterval = frames; }
+Render::PassGraph &Engine::passGraph() { return m_passGraph; }
+uint32_t Engine::sceneColorTexture() { return m_colorTextureID; }
+
 } // namespace Engine
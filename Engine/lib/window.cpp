@@ -8,6 +8,7 @@
 #include "GLFW/glfw3.h"
 #include "Math/Vector.hpp"
 #include "Objects/ObjectUUID.hpp"
+#include "Utils/JobSystem.hpp"
 #include "engine.hpp"
 
 namespace Engine {
@@ -84,6 +85,7 @@ void Window::gameloop() {
   double dt = std::chrono::duration<double>(now - m_lastTime).count();
 
   glfwPollEvents();
+  JobSystem::get().pumpMainThread();
   double x, y;
   glfwGetCursorPos(m_window, &x, &y);
 
@@ -131,6 +133,7 @@ void Window::init(Math::Vector<2, uint32_t> windowSize) {
   glfwMakeContextCurrent(m_window);
   glfwSwapInterval(0);
 
+  JobSystem::get().bindMainThread();
   m_engine = Engine::init((GLADloadproc)glfwGetProcAddress, windowSize);
   m_lastTime = std::chrono::high_resolution_clock::now();
   m_startTime = std::chrono::high_resolution_clock::now();
@@ -1,4 +1,7 @@
 #include "GLFW/glfw3.h"
+#include "Math/Hull.hpp"
+#include "Math/Predicates.hpp"
+#include "Utils/Pipeline.hpp"
 #include "engine.hpp"
 #include "window.hpp"
 #include <algorithm>
@@ -8,7 +11,9 @@
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <random>
+#include <string>
 #include <vector>
 
 using Vec2 = Engine::Math::Vector<2>;
@@ -17,113 +22,14 @@ using Color = Engine::Math::Vector<3>;
 using Cell = std::vector<Vec2>;
 using Polygon = std::vector<Vec2>;
 
-float pointSide(Vec2 P, Vec2 A, Vec2 B) {
-  Vec2 AB = B - A;
-  Vec2 AP = P - A;
-
-  return (AB[0] * AP[1]) - (AB[1] * AP[0]);
-}
-
-void FindHull(std::vector<Vec2> &hull, std::vector<Vec2> &points, Vec2 P,
-              Vec2 Q) {
-
-  if (points.empty()) {
-    return;
-  }
-
-  struct {
-    float dist = 0;
-    size_t i = 0;
-  } max;
-
-  Vec2 delta = Q - P;
-  Vec2 dir = delta;
-  dir.norm();
-  for (size_t i = 0; i < points.size(); i++) {
-    float dist = std::abs(pointSide(points[i], P, Q));
-    if (max.dist < dist) {
-      max.dist = dist;
-      max.i = i;
-    }
-  }
-
-  Vec2 C = points[max.i];
-  auto it = std::find(hull.begin(), hull.end(), P);
-  if (it == hull.end()) {
-    throw std::runtime_error("P not find in hull");
-  }
-  hull.emplace(++it, C);
-
-  std::vector<Vec2> S[2];
-
-  for (size_t i = 0; i < points.size(); i++) {
-    if (i == max.i)
-      continue;
-
-    float sidePC = pointSide(points[i], P, C);
-    float sideCQ = pointSide(points[i], C, Q);
-
-    if (sidePC > 0) {
-      S[0].push_back(points[i]);
-    }
-
-    if (sideCQ > 0) {
-      S[1].push_back(points[i]);
-    }
-  }
-
-  FindHull(hull, S[0], P, C);
-  FindHull(hull, S[1], C, Q);
-}
-
-std::vector<Vec2> ConvexHull(std::vector<Vec2> points) {
-  std::vector<Vec2> hull;
-
-  std::sort(points.begin(), points.end(),
-            [](Vec2 a, Vec2 b) { return a[0] < b[0]; });
-
-  size_t left = 0;
-  size_t right = points.size();
-
-  hull.push_back(points.front());
-  hull.push_back(points.back());
-
-  std::vector<Vec2> S[2];
-
-  float midx = (points.front()[0] + points.back()[0]) / 2;
-  size_t mid = 0;
-
-  for (size_t i = 1; i < points.size() - 1 && mid == 0; i++) {
-    float side = pointSide(points[i], points.front(), points.back());
-    S[side < 0].push_back(points[i]);
-  }
-
-  FindHull(hull, S[0], points.front(), points.back());
-  FindHull(hull, S[1], points.back(), points.front());
-
-  Vec2 centroid = {0.0f, 0.0f};
-  for (const auto &p : hull) {
-    centroid[0] += p[0];
-    centroid[1] += p[1];
-  }
-  centroid[0] /= hull.size();
-  centroid[1] /= hull.size();
-
-  std::sort(hull.begin(), hull.end(), [&](const Vec2 &a, const Vec2 &b) {
-    float angleA = atan2(a[1] - centroid[1], a[0] - centroid[0]);
-    float angleB = atan2(b[1] - centroid[1], b[0] - centroid[0]);
-    return angleA < angleB;
-  });
-
-  return hull;
-}
-
 // Helper function to find the 2D cross product of vectors AB and AC
 // This tells us if C is to the left or right of the line AB
 // > 0: C is to the left
 // < 0: C is to the right
 // = 0: C is collinear
-float cross_product(Vec2 a, Vec2 b) { return a[0] * b[1] - a[1] * b[0]; }
+double cross_product(Vec2 a, Vec2 b) {
+  return Engine::Math::orient2d({0, 0}, a, b);
+}
 
 // Helper function to find the index of the vertex with the minimum Y-coordinate
 // This is a robust way to find a "starting" vertex on the convex hull.
@@ -180,7 +86,7 @@ Polygon MinkowskiSum_impl(const Polygon &A, const Polygon &B) {
       Vec2 edgeA = A[(currA + 1) % m] - A[currA % m];
       Vec2 edgeB = B[(currB + 1) % n] - B[currB % n];
 
-      float cp = cross_product(edgeA, edgeB);
+      double cp = cross_product(edgeA, edgeB);
 
       // If cp >= 0, edgeA has a smaller (or equal) angle than edgeB.
       if (cp >= 0) {
@@ -279,11 +185,24 @@ struct MyWindow : public Engine::Window {
   MyWindow() {
     m_state.addHeader("objPoints");
     m_state.addHeader("robotPoints");
+    m_state.addHeader("hullAlgorithm");
+    m_state.addHeader("hullTime");
+    m_state.addHeader("recursions");
     m_state.addHeader("sumTime");
+    m_state.addHeader("exactRate");
+    m_state.addHeader("rejectedRate");
+    m_state.addHeader("latency");
 
     m_state.get("objPoints") = 0u;
     m_state.get("robotPoints") = 0u;
+    m_state.get("hullAlgorithm") =
+        std::string(Engine::Math::HullAlgorithmName(m_algorithm));
+    m_state.get("hullTime") = (double)0;
+    m_state.get("recursions") = 0u;
     m_state.get("sumTime") = (double)0;
+    m_state.get("exactRate") = (double)0;
+    m_state.get("rejectedRate") = (double)0;
+    m_state.get("latency") = (double)0;
   }
 
   const float POINT_RADIUS = 12;
@@ -305,98 +224,186 @@ struct MyWindow : public Engine::Window {
   const double timeout = 5;
   void update(double dt) override {
     m_state.get("sumTime") = (double)0;
+    m_state.get("hullTime") = (double)0;
 
     if (refresh) {
-      clearEngine();
-
-      Polygon robotHull;
-      if (robot.size() > 2) {
-        robotHull = ConvexHull(robot);
-        for (size_t i = 0; i < robot.size(); i++)
-          m_points.emplace_back(std::move(m_engine->createPoint(
-              robot[i], POINT_ROBOT_COLOR, POINT_RADIUS)));
-        for (size_t i = 0; i < robotHull.size(); i++) {
-          size_t ni = (i + 1) % robotHull.size();
+      m_pipeline.submit([robot = robot, obs = obs, summing = currObs == -1,
+                         algorithm = m_algorithm, prefilter = m_prefilter](
+                            Pipeline<Sums>::Task &task) {
+        return Compute(robot, obs, summing, algorithm, prefilter, task);
+      });
+      refresh = false;
+    }
 
-          m_lines.emplace_back(std::move(m_engine->createLine(
-              robotHull[i], robotHull[ni], LINE_COLOR, LINE_STOKE)));
-        }
-        m_polys.emplace_back(std::move(
-            m_engine->createPoly(robotHull, ROBOT_COLOR, ROBOT_COLOR, 0)));
-      } else {
-        for (size_t i = 0; i < robot.size(); i++) {
-          size_t ni = (i + 1) % robot.size();
+    // Results of the newest edit only, so the polygons still match them
+    std::optional<Pipeline<Sums>::Output> output = m_pipeline.poll();
+    if (!output)
+      return;
+
+    render(output->result);
+
+    if (output->complete) {
+      m_state.get("sumTime") = output->result.sumSeconds;
+      m_state.get("hullTime") = output->result.hullSeconds;
+      m_state.get("recursions") = output->result.recursions;
+      m_state.get("hullAlgorithm") = std::string(
+          Engine::Math::HullAlgorithmName(output->result.algorithm));
+      m_state.get("exactRate") = output->result.exactRate;
+      m_state.get("rejectedRate") = output->result.rejectedRate;
+      m_state.get("latency") = output->latency;
+    }
+  }
 
-          m_points.emplace_back(std::move(m_engine->createPoint(
-              robot[i], POINT_ROBOT_COLOR, POINT_RADIUS)));
-          m_lines.emplace_back(std::move(m_engine->createLine(
-              robot[i], robot[ni], LINE_COLOR, LINE_STOKE)));
-        }
-      }
+private:
+  // Hulls and sums of a copy of the polygons, built in the background. The
+  // hulls are published first, the sums complete them
+  struct Sums {
+    Polygon robotHull;
+    // Of the obstacles with three points or more, in order
+    std::vector<Polygon> obsHull;
+    std::vector<Polygon> sum;
+    Engine::Math::HullAlgorithm algorithm;
+    // Over every hull
+    uint32_t recursions = 0;
+    double hullSeconds = 0;
+    double sumSeconds = 0;
+    double exactRate = 0;
+    // Share of the hulled points the octagon prefilter removed
+    double rejectedRate = 0;
+  };
+
+  static Sums Compute(const Polygon &robot, const std::vector<Polygon> &obs,
+                      bool summing, Engine::Math::HullAlgorithm algorithm,
+                      bool prefilter, Pipeline<Sums>::Task &task) {
+    Sums sums;
+    sums.algorithm = algorithm;
+    Engine::Math::PredicateStats before = Engine::Math::predicateStats();
+
+    Engine::Math::HullStats stats;
+    size_t hulled = 0, rejected = 0;
+    auto hull = [&](Polygon points) {
+      hulled += points.size();
+      if (prefilter)
+        rejected += Engine::Math::DiscardInterior(points);
+      return Engine::Math::ConvexHull(std::move(points), algorithm, &stats);
+    };
+
+    auto start = Clock::now();
+    if (robot.size() > 2)
+      sums.robotHull = hull(robot);
+
+    for (size_t i = 0; i < obs.size(); i++) {
+      if (obs[i].size() > 2)
+        sums.obsHull.push_back(hull(obs[i]));
+    }
+    std::chrono::duration<double> seconds = Clock::now() - start;
+    sums.hullSeconds = seconds.count();
+    sums.recursions = stats.recursions;
+    if (hulled)
+      sums.rejectedRate = (double)rejected / hulled;
+
+    if (!sums.robotHull.empty() && !sums.obsHull.empty() && summing) {
+      task.publish(sums);
+      task.checkpoint();
+
+      start = Clock::now();
+      sums.sum = MinkowskiSum(sums.robotHull, sums.obsHull);
+      seconds = Clock::now() - start;
+      sums.sumSeconds = seconds.count();
+
+      dumpDistances(sums.robotHull, sums.sum);
+    }
 
-      uint32_t points = 0;
-      std::vector<Polygon> obsHull;
-      for (size_t i = 0; i < obs.size(); i++) {
-        if (obs[i].size() > 2) {
-          obsHull.push_back(ConvexHull(obs[i]));
-          for (size_t j = 0; j < obs[i].size(); j++) {
-            m_points.emplace_back(std::move(m_engine->createPoint(
-                obs[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
-          }
-          points += obsHull.back().size();
-        } else {
-          for (size_t j = 0; j < obs[i].size(); j++) {
-            size_t nj = (j + 1) % obs[i].size();
-            m_points.emplace_back(std::move(m_engine->createPoint(
-                obs[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
-            if (obs[i].size() > 1)
-              m_lines.emplace_back(std::move(m_engine->createLine(
-                  obs[i][j], obs[i][nj], LINE_COLOR, LINE_STOKE)));
-          }
-        }
-      }
-      m_state.get("objPoints") = points;
-      m_state.get("robotPoints") = (uint32_t)robotHull.size();
+    Engine::Math::PredicateStats after = Engine::Math::predicateStats();
+    sums.exactRate = Engine::Math::PredicateStats{after.calls - before.calls,
+                                                  after.exact - before.exact}
+                         .fallbackRate();
+    return sums;
+  }
 
-      if (!robotHull.empty() && !obsHull.empty() && currObs == -1) {
+  void render(Sums &sums) {
+    clearEngine();
 
-        auto start = Clock::now();
-        std::vector<Polygon> sum = MinkowskiSum(robotHull, obsHull);
-        std::chrono::duration<double> seconds = Clock::now() - start;
-        m_state.get("sumTime") = seconds.count();
+    Polygon &robotHull = sums.robotHull;
+    if (robot.size() > 2) {
+      for (size_t i = 0; i < robot.size(); i++)
+        m_points.emplace_back(std::move(m_engine->createPoint(
+            robot[i], POINT_ROBOT_COLOR, POINT_RADIUS)));
+      for (size_t i = 0; i < robotHull.size(); i++) {
+        size_t ni = (i + 1) % robotHull.size();
 
-        for (size_t i = 0; i < sum.size(); i++) {
-          for (size_t j = 0; j < sum[i].size(); j++) {
-            size_t nj = (j + 1) % sum[i].size();
+        m_lines.emplace_back(std::move(m_engine->createLine(
+            robotHull[i], robotHull[ni], LINE_COLOR, LINE_STOKE)));
+      }
+      m_polys.emplace_back(std::move(
+          m_engine->createPoly(robotHull, ROBOT_COLOR, ROBOT_COLOR, 0)));
+    } else {
+      for (size_t i = 0; i < robot.size(); i++) {
+        size_t ni = (i + 1) % robot.size();
+
+        m_points.emplace_back(std::move(m_engine->createPoint(
+            robot[i], POINT_ROBOT_COLOR, POINT_RADIUS)));
+        m_lines.emplace_back(std::move(m_engine->createLine(
+            robot[i], robot[ni], LINE_COLOR, LINE_STOKE)));
+      }
+    }
 
-            m_points.emplace_back(std::move(m_engine->createPoint(
-                sum[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
+    uint32_t points = 0;
+    std::vector<Polygon> &obsHull = sums.obsHull;
+    size_t hull = 0;
+    for (size_t i = 0; i < obs.size(); i++) {
+      if (obs[i].size() > 2) {
+        for (size_t j = 0; j < obs[i].size(); j++) {
+          m_points.emplace_back(std::move(m_engine->createPoint(
+              obs[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
+        }
+        points += obsHull[hull++].size();
+      } else {
+        for (size_t j = 0; j < obs[i].size(); j++) {
+          size_t nj = (j + 1) % obs[i].size();
+          m_points.emplace_back(std::move(m_engine->createPoint(
+              obs[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
+          if (obs[i].size() > 1)
             m_lines.emplace_back(std::move(m_engine->createLine(
-                sum[i][j], sum[i][nj], LINE_OUT_COLOR, LINE_STOKE)));
-          }
-          m_polys.emplace_back(std::move(
-              m_engine->createPoly(sum[i], POLY_OUT_COLOR, POLY_OUT_COLOR, 0)));
+                obs[i][j], obs[i][nj], LINE_COLOR, LINE_STOKE)));
         }
-
-        dumpDistances(robotHull, sum);
       }
+    }
+    m_state.get("objPoints") = points;
+    m_state.get("robotPoints") = (uint32_t)robotHull.size();
+
+    std::vector<Polygon> &sum = sums.sum;
+    for (size_t i = 0; i < sum.size(); i++) {
+      for (size_t j = 0; j < sum[i].size(); j++) {
+        size_t nj = (j + 1) % sum[i].size();
+
+        m_points.emplace_back(std::move(m_engine->createPoint(
+            sum[i][j], POINT_OBS_COLOR, POINT_RADIUS)));
+        m_lines.emplace_back(std::move(m_engine->createLine(
+            sum[i][j], sum[i][nj], LINE_OUT_COLOR, LINE_STOKE)));
+      }
+      m_polys.emplace_back(std::move(
+          m_engine->createPoly(sum[i], POLY_OUT_COLOR, POLY_OUT_COLOR, 0)));
+    }
 
-      for (size_t i = 0; i < obsHull.size(); i++) {
-        for (size_t j = 0; j < obsHull[i].size(); j++) {
-          size_t nj = (j + 1) % obsHull[i].size();
+    for (size_t i = 0; i < obsHull.size(); i++) {
+      for (size_t j = 0; j < obsHull[i].size(); j++) {
+        size_t nj = (j + 1) % obsHull[i].size();
 
-          m_lines.emplace_back(std::move(m_engine->createLine(
-              obsHull[i][j], obsHull[i][nj], LINE_COLOR, LINE_STOKE)));
-        }
-
-        m_polys.emplace_back(std::move(
-            m_engine->createPoly(obsHull[i], OBS_COLOR, OBS_COLOR, 0)));
+        m_lines.emplace_back(std::move(m_engine->createLine(
+            obsHull[i][j], obsHull[i][nj], LINE_COLOR, LINE_STOKE)));
       }
 
-      refresh = false;
+      m_polys.emplace_back(std::move(
+          m_engine->createPoly(obsHull[i], OBS_COLOR, OBS_COLOR, 0)));
     }
   }
 
+  Engine::Math::HullAlgorithm m_algorithm =
+      Engine::Math::HullAlgorithm::QuickHull;
+  bool m_prefilter = true;
+  Pipeline<Sums> m_pipeline;
+
 private:
   void mouseButtonCallback(int button, int action, int mods) override {
     if (action == GLFW_PRESS) {
@@ -467,6 +474,20 @@ private:
         genRandom();
         break;
 
+      case GLFW_KEY_H:
+        m_algorithm = (Engine::Math::HullAlgorithm)(
+            ((int)m_algorithm + 1) % Engine::Math::HULL_ALGORITHMS);
+        std::cout << "hull: " << Engine::Math::HullAlgorithmName(m_algorithm)
+                  << '\n';
+        refresh = true;
+        break;
+
+      case GLFW_KEY_P:
+        m_prefilter = !m_prefilter;
+        std::cout << "prefilter: " << (m_prefilter ? "on" : "off") << '\n';
+        refresh = true;
+        break;
+
       case GLFW_KEY_LEFT_SHIFT:
         currObs = obs.size();
         obs.emplace_back();
@@ -15,6 +15,8 @@ public:
   virtual void clear() {}
   virtual void reset() {}
   virtual bool isBlocking() { return false; }
+  // A goal agents can be sent to, a source of the Territories
+  virtual bool isDestination() { return false; }
 
   Vec2u getPos() { return m_pos; }
 
@@ -46,6 +46,12 @@ public:
       return m_wrappedCell->isBlocking();
     return false;
   }
+
+  bool isDestination() override {
+    if (m_wrappedCell)
+      return m_wrappedCell->isDestination();
+    return false;
+  }
 };
 
 } // namespace Cells
@@ -13,6 +13,8 @@ public:
     EMPTY,
     OBS,
     ORIGIN,
+    // An origin whose agent heads to the nearest destination
+    ORIGIN_NEAREST,
     DESTINATION,
   };
 
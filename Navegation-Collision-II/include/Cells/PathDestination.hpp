@@ -11,6 +11,7 @@ public:
   void draw(Engine::Engine &engine) override;
   bool tick(Engine::Engine &engine, double dt) override;
   void clear() override;
+  bool isDestination() override;
 
 private:
   Vec2u m_dest;
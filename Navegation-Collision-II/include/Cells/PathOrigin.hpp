@@ -11,7 +11,9 @@ namespace Cells {
 class PathOrigin final : public ICell {
 public:
   PathOrigin(Vec2u origin);
-  PathOrigin(Vec2u origin, Vec2u destination);
+  // With `nearest` the agent heads to whichever destination is closest and
+  // `destination` is ignored
+  PathOrigin(Vec2u origin, Vec2u destination, bool nearest = false);
   PathOrigin(PathOrigin &&other);
   ~PathOrigin();
 
@@ -29,6 +31,7 @@ private:
 
   Vec2 m_pos;
   bool m_hasAgent;
+  bool m_nearest = false;
 
   Simulation::Manager::AgentID m_agent;
   PathManager::PathPtr m_path;
@@ -24,10 +24,16 @@ struct IGrid {
   std::vector<Simulation::Agent *> &getAgents();
   bool empty() const;
   bool isBlocking() const;
+  bool isDestination() const;
   void fill(Color color);
   void subscribeOnChanged(Subscriber *sub);
+  // Draws what the cell holds, which may also pick the fill colour
+  void drawCell(Engine::Engine &engine);
 
+  // Fill polygon, the one picked by the object ID lookup
   virtual void draw(Engine::Engine &engine) = 0;
+  // Border lines, only redrawn when the grid layout changes
+  virtual void drawOutline(Engine::Engine &engine) = 0;
   virtual Vec2 center() const = 0;
   virtual Engine::Objects::ObjectUUID::UUID getUUID() const = 0;
   virtual float offsetRow(size_t row) const = 0;
@@ -9,11 +9,14 @@ public:
   HexagonalGrid(Vec2u coord);
 
   void draw(Engine::Engine &engine) override;
+  void drawOutline(Engine::Engine &engine) override;
   Vec2 center() const override;
   Engine::Objects::ObjectUUID::UUID getUUID() const override;
   float offsetRow(size_t row) const override;
 
 private:
+  std::vector<Vec2> verts() const;
+
   Engine::Poly *poly;
 };
 } // namespace Grid
@@ -63,18 +63,48 @@ public:
   bool allocated() const;
 
   void setup();
+  // Redraws the cells and their contents, leaving the overlay layer active.
+  // Outlines live in a static layer only rebuilt when the layout changes.
   bool update(Engine::Engine &engine, std::optional<double> dt = std::nullopt);
 
+  // Told before every cell change, changedCell() says which
   GridManager &subscribeOnCellChange(Subscriber *obs);
   GridManager &unsubscribeOnCellChange(Subscriber *obs);
   GridManager &subscribeOnGridChange(Subscriber *obs);
   GridManager &unsubscribeOnGridChange(Subscriber *obs);
 
+  // Coordinate of the cell being changed, as get(Vec2u) takes it. Only
+  // meaningful while a cell change is published
+  Vec2u changedCell() const;
+
   static GridManager &get();
 
 private:
+  struct Layers {
+    Engine::Engine::LayerID cells;
+    Engine::Engine::LayerID outline;
+    Engine::Engine::LayerID overlays;
+  };
+
+  // Forwards the change of one cell with its coordinate
+  class CellWatch final : public Subscriber {
+  public:
+    CellWatch(GridManager &manager, Vec2u coord)
+        : m_manager(manager), m_coord(coord) {}
+    void update() override;
+
+  private:
+    GridManager &m_manager;
+    Vec2u m_coord;
+  };
+
   GridManager();
 
+  // Subscribes the watch of cell `index` to `grid`, made with the cell
+  void watch(size_t index, Grid::IGrid *grid, Vec2u coord);
+
+  void setupLayers(Engine::Engine &engine);
+
   Grid::IGrid *impl_get(size_t row, size_t col) const;
   inline size_t getGridIndex(size_t row, size_t col, Vec2u gridSize) const;
   inline Vec2u getIndexGrid(size_t index, Vec2u gridSize) const;
@@ -82,7 +112,9 @@ private:
   static std::unique_ptr<GridManager> m_instance;
   std::unique_ptr<GridFactories::IFactory> m_factory;
 
-  Subscribers::CallbackSubscriber m_changed;
+  // One per cell, in the order of m_grid
+  std::vector<std::unique_ptr<CellWatch>> m_watches;
+  Vec2u m_changedCell;
 
   Publisher m_cellPublisher;
   Publisher m_gridPublisher;
@@ -97,6 +129,9 @@ private:
   Vec2u m_gridSize;
   Vec2 m_area[2];
   Vec2 m_delta;
+
+  std::optional<Layers> m_layers;
+  bool m_outlineDirty = true;
 };
 
 #endif // GRID_MANAGER_HPP
@@ -10,11 +10,14 @@ public:
   SquareGrid(Vec2u coord);
 
   void draw(Engine::Engine &engine) override;
+  void drawOutline(Engine::Engine &engine) override;
   Vec2 center() const override;
   Engine::Objects::ObjectUUID::UUID getUUID() const override;
   float offsetRow(size_t row) const override;
 
 private:
+  void corners(Vec2 out[4]) const;
+
   Engine::Poly *poly;
 };
 
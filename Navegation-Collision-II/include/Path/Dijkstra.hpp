@@ -19,6 +19,10 @@ class Dijkstra {
 
   static std::vector<Vec2u> ShortestPath(Vec2u start, Vec2u end,
                                          Grid::IGraph *graph);
+  // Same search with its state kept only for the cells reached, for graphs
+  // much sparser than the grid. `cells` is about how many it has
+  static std::vector<Vec2u> SparsePath(Vec2u start, Vec2u end,
+                                       Grid::IGraph *graph, size_t cells);
 
   friend PathManager;
 };
@@ -4,6 +4,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <unordered_set>
 #include <vector>
@@ -12,6 +13,8 @@
 #include "Math/Vector.hpp"
 #include "Observer/GridChanged.hpp"
 
+class Roadmap;
+
 class PathManager {
 public:
   // Forward declare the internal ID structure
@@ -35,13 +38,18 @@ public:
 
   // 1. Create a path and get ownership
   PathPtr requestPath(DynamicInfo info, Vec2u start, Vec2u end);
+  // Or to whichever destination is nearest, looked up in the Territories
+  PathPtr requestNearestPath(DynamicInfo info, Vec2u start);
 
   void registerOnChange(PathID *id, OnChangeCallback callback);
 
   // 2. Get the next waypoint (Thread-safe read)
   std::optional<Vec2> getSegment(PathID *id, size_t i);
 
-  // 3. Recalculate all empty/dirty paths (Call this in your Game Loop)
+  // 3. Recalculate all empty/dirty paths (Call this in your Game Loop).
+  // Searches run on the JobSystem, callbacks on the calling thread. With
+  // "roadmapPath" set they run on a Roadmap of the grid, built here. Nearest
+  // paths follow the Territories, brought up to date first while any exists
   void update();
 
   // 4. Force all paths to recalculate (e.g., on Grid Change)
@@ -54,6 +62,14 @@ private:
   // Internal methods used by PathDeleter
   void unregisterPath(PathID *id);
 
+  PathPtr store(std::vector<Vec2u> path, DynamicInfo info, Vec2u start,
+                Vec2u end, bool nearest);
+
+  // Onto the roadmap, along it and off again, over the whole grid when any
+  // leg has no path
+  std::vector<Vec2u> plan(Vec2u start, Vec2u end,
+                          const std::shared_ptr<Roadmap> &roadmap);
+
   // --- Data Storage ---
 
   // The actual path data. Stable iterators are crucial here.
@@ -62,8 +78,18 @@ private:
   // The Registry: A set of raw pointers to currently active IDs.
   // We do NOT own them here; the Agent (PathPtr) owns them.
   std::unordered_set<PathID *> m_registry;
-
-  // Observer for Grid changes
+  // Guards the two containers above, agents may request paths from workers
+  std::mutex m_mutex;
+  // Registered paths to the nearest destination
+  size_t m_nearest = 0;
+  // Territories::update() is not reentrant
+  std::mutex m_territoryMutex;
+
+  // Built on update, dropped when a cell or the grid changes
+  std::shared_ptr<Roadmap> m_roadmap;
+
+  // Observers for cell edits and Grid changes
+  Subscribers::CallbackSubscriber m_onCellChange;
   Subscribers::CallbackSubscriber m_onGridChange;
 };
 
@@ -0,0 +1,64 @@
+#ifndef PATH_ROADMAP_HPP
+#define PATH_ROADMAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Grid/Graph.hpp"
+#include "Math/Vector.hpp"
+
+// Generalized Voronoi roadmap of the free cells: the ridge of cells as far as
+// possible from the two nearest obstacles
+//
+// "Sensor-based exploration: The hierarchical generalized Voronoi graph" by
+//  Howie Choset and Joel Burdick (2000)
+//
+// Blocked cells are grouped in connected obstacles, each side of the grid is
+// one more. A brushfire (breadth first search from every obstacle at once)
+// labels each free cell with its distance to the nearest one and which one it
+// is; cells next to a cell of another label are the ridge. Ridge cells
+// touching an obstacle are pruned: they only hug walls and lead into the
+// points where two obstacles meet.
+//
+// The ridge is a much sparser graph than the grid. Any free cell retracts to
+// its nearest ridge cell, so a search only has to climb on, follow the ridge
+// and climb off.
+//
+// A snapshot of the grid: edits need a new Roadmap.
+class Roadmap : public Grid::IGraph {
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // O(rows * cols), over the neighbours of `graph`
+  explicit Roadmap(Grid::IGraph *graph);
+
+  // Neighbours in `graph` that are on the roadmap
+  std::vector<Vec2u> getNeighbors(Vec2u coord) override;
+  // On the roadmap
+  bool isValid(Vec2u coord) override;
+
+  // Cells from `coord` to the nearest roadmap cell, both included. Empty when
+  // none can be reached
+  std::vector<Vec2u> retract(Vec2u coord) const;
+
+  // Number of roadmap cells
+  size_t size() const;
+  // The graph it was built on
+  Grid::IGraph *graph() const;
+
+private:
+  uint32_t index(Vec2u coord) const;
+  Vec2u coord(uint32_t index) const;
+
+  Grid::IGraph *m_graph;
+  size_t m_rows;
+  size_t m_cols;
+
+  std::vector<bool> m_onRoadmap;
+  size_t m_size = 0;
+  // Next cell towards the roadmap, NONE on it or when unreachable
+  std::vector<uint32_t> m_toward;
+  std::vector<bool> m_reached;
+};
+
+#endif // PATH_ROADMAP_HPP
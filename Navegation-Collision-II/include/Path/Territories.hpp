@@ -0,0 +1,81 @@
+#ifndef PATH_TERRITORIES_HPP
+#define PATH_TERRITORIES_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Grid/Graph.hpp"
+#include "Math/Vector.hpp"
+#include "Observer/GridChanged.hpp"
+
+// Discrete geodesic Voronoi diagram of the destinations: every free cell
+// labelled with its nearest destination, how many steps away it is and the
+// next step towards it
+//
+// "Dynamic Brushfire: A Fast, Incremental Method for Generating Voronoi
+//  Diagrams" by Nidhi Kalra, Dave Ferguson and Anthony Stentz (2006)
+//
+// Built by a breadth first search from every destination at once, over the
+// neighbours of the grid graph, so square and hex grids alike. Edits are
+// repaired instead of rebuilt: update() compares the cells the grid reported
+// changed with what it last saw of them,
+// - a new destination or a freed cell can only lower distances, they spread
+//   from it until they stop improving;
+// - a removed destination or a new obstacle drops the cells whose next steps
+//   led through it, which are then filled in again from the cells around
+//   them.
+//
+// Nearest goal queries are then a lookup, the path a walk of its length.
+class Territories {
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  static Territories &get();
+
+  // Catches up with the grid, one caller at a time and never during a cell
+  // change. Rebuilt after the grid was reallocated, otherwise repaired around
+  // the cells that changed
+  void update();
+
+  // Nearest destination of `coord`, none when no destination can be reached
+  std::optional<Vec2u> nearest(Vec2u coord) const;
+  // Steps to it, NONE when unreachable
+  uint32_t distance(Vec2u coord) const;
+  // Cells from `coord` to its nearest destination, both included. Empty
+  // when none can be reached
+  std::vector<Vec2u> path(Vec2u coord) const;
+
+private:
+  Territories();
+
+  // What of a cell the territories depend on
+  enum State : uint8_t { FREE, BLOCKED, SOURCE };
+
+  void rebuild();
+  void repair(const std::vector<uint32_t> &changed);
+  // Lowers distances from `seeds` until they stop improving
+  void spread(std::vector<uint32_t> &seeds);
+
+  uint32_t index(Vec2u coord) const;
+  Vec2u coord(uint32_t index) const;
+
+  Grid::IGraph *m_graph = nullptr;
+  size_t m_rows = 0;
+  size_t m_cols = 0;
+  // Told by the grid before the change itself, so update() reads them later
+  std::vector<Vec2u> m_changed;
+  bool m_reallocated = true;
+
+  std::vector<State> m_state;
+  // Cell index of the nearest destination
+  std::vector<uint32_t> m_label;
+  std::vector<uint32_t> m_distance;
+  // Next cell towards the nearest destination, NONE on it
+  std::vector<uint32_t> m_toward;
+
+  Subscribers::CallbackSubscriber m_onCellChange;
+  Subscribers::CallbackSubscriber m_onGridChange;
+};
+
+#endif // PATH_TERRITORIES_HPP
@@ -21,6 +21,8 @@ public:
   struct Path {
     Vec2u start;
     Vec2u end;
+    // To whichever destination is nearest, `end` is unused
+    bool nearest = false;
   };
 
   // Physics State
@@ -44,9 +46,21 @@ public:
 
   // Methods
   void setStrategy(std::unique_ptr<Collision::IStrategy> newStrategy);
+  // A new path for `goal` from the PathManager
+  PathManager::PathPtr requestPath() const;
   void reset();
   void draw(Engine::Engine &engine);
   void update(double dt);
+
+  // update() split in two: plan() computes the next position reading only
+  // the current state, commit() applies it
+  void plan(double dt);
+  void commit();
+
+private:
+  Vec2 m_next;
+  bool m_arrived = false;
+  bool m_reached = false;
 };
 
 } // namespace Simulation
@@ -22,6 +22,7 @@ class DirectSystem : public ISystem {
 public:
   void preStep(double dt) override;
   void postStep() override;
+  bool concurrent() const override { return true; }
 };
 
 // =========================================================
@@ -8,6 +8,9 @@ class ISystem {
 public:
   virtual void preStep(double dt) {}
   virtual void postStep() {}
+  // Whether the strategies of this system only read other agents, so every
+  // agent of a step can be planned in parallel
+  virtual bool concurrent() const { return false; }
   virtual ~ISystem() = default;
 };
 
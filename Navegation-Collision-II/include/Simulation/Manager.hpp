@@ -44,7 +44,13 @@ public:
   void update(double dt);
 
 private:
+  // Agents planned by a single job
+  static constexpr size_t AGENT_GRAIN = 32;
+
+  void step(double dt);
+
   Agents_t agents;
+  std::vector<Agent *> m_batch;
 
   std::unique_ptr<Collision::IFactory> factory;
   std::unique_ptr<Collision::ISystem> system;
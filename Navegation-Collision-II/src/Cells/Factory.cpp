@@ -22,6 +22,10 @@ Cells::ICell *CellFactory::Create(CellType type, Vec2u pos,
       newCell = new Cells::PathOrigin(pos);
     break;
 
+  case CellType::ORIGIN_NEAREST:
+    newCell = new Cells::PathOrigin(pos, pos, true);
+    break;
+
   case CellType::OBS:
     newCell = new Cells::Obstacle(pos);
     break;
@@ -13,6 +13,8 @@ void PathDestination::draw(Engine::Engine &engine) {
 
 bool PathDestination::tick(Engine::Engine &engine, double dt) { return true; }
 
+bool PathDestination::isDestination() { return true; }
+
 void PathDestination::clear() { GridManager::get().get(m_origin)->clear(); }
 
 }; // namespace Cells
@@ -17,8 +17,9 @@ PathOrigin::PathOrigin(Vec2u origin)
   m_pos = GridManager::get().getCenter(origin);
 }
 
-PathOrigin::PathOrigin(Vec2u origin, Vec2u destination)
-    : m_origin(origin), m_dest(destination), m_hasAgent(true) {
+PathOrigin::PathOrigin(Vec2u origin, Vec2u destination, bool nearest)
+    : m_origin(origin), m_dest(destination), m_hasAgent(true),
+      m_nearest(nearest) {
   m_pos = GridManager::get().getCenter(origin);
 
   auto &pathMgr = PathManager::get();
@@ -30,7 +31,8 @@ PathOrigin::PathOrigin(Vec2u origin, Vec2u destination)
   float speed = std::get<double>(stats.get("agentsSpeed").value_or(30.0));
 
   auto agent = std::make_unique<Simulation::Agent>(
-      m_pos, radius, speed, Simulation::Agent::Path{m_origin, m_dest});
+      m_pos, radius, speed,
+      Simulation::Agent::Path{m_origin, m_dest, m_nearest});
 
   m_agent = simMgr.addAgent(std::move(agent));
 }
@@ -60,7 +62,9 @@ bool PathOrigin::tick(Engine::Engine &engine, double dt) {
 }
 
 void PathOrigin::clear() {
-  Invoker::get().addCommand(new Commands::RemoveCell(m_dest, false));
+  // A nearest origin owns no destination
+  if (!m_nearest)
+    Invoker::get().addCommand(new Commands::RemoveCell(m_dest, false));
 }
 void PathOrigin::reset() { m_pos = GridManager::get().getCenter(m_origin); }
 
@@ -46,9 +46,17 @@ std::vector<Simulation::Agent *> &IGrid::getAgents() { return m_agents; }
 bool IGrid::empty() const { return !m_cell; }
 
 bool IGrid::isBlocking() const { return m_cell && m_cell->isBlocking(); }
+bool IGrid::isDestination() const {
+  return m_cell && m_cell->isDestination();
+}
 void IGrid::fill(Color color) { m_fill = color; }
 void IGrid::subscribeOnChanged(Subscriber *sub) {
   m_cellChanged.subscribe(sub);
 }
 
+void IGrid::drawCell(Engine::Engine &engine) {
+  if (m_cell)
+    m_cell->draw(engine);
+}
+
 } // namespace Grid
@@ -11,7 +11,7 @@ namespace Grid {
 
 HexagonalGrid::HexagonalGrid(Vec2u coord) : IGrid(coord) {}
 
-void HexagonalGrid::draw(Engine::Engine &engine) {
+std::vector<Vec2> HexagonalGrid::verts() const {
   Vec2 gridSize = GridManager::get().getCellSize();
   Vec2 start = GridManager::get().start();
 
@@ -41,6 +41,12 @@ void HexagonalGrid::draw(Engine::Engine &engine) {
                      center[1] + radiusY * std::sin(angle_rad)});
   }
 
+  return verts;
+}
+
+void HexagonalGrid::drawOutline(Engine::Engine &engine) {
+  std::vector<Vec2> verts = this->verts();
+
   const Color LINE_COLOR = {1, 1, 1};
   const float LINE_STROKE = 2;
 
@@ -48,12 +54,11 @@ void HexagonalGrid::draw(Engine::Engine &engine) {
     size_t next = (i + 1) % 6;
     engine.createLine(verts[i], verts[next], LINE_COLOR, LINE_STROKE);
   }
+}
 
+void HexagonalGrid::draw(Engine::Engine &engine) {
+  std::vector<Vec2> verts = this->verts();
   poly = &engine.createPoly(verts, m_fill, m_fill, 0, true);
-
-  if (m_cell) {
-    m_cell->draw(engine);
-  }
 }
 
 Vec2 HexagonalGrid::center() const {
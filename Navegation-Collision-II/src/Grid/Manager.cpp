@@ -1,7 +1,18 @@
 #include "Grid/Manager.hpp"
 
-GridManager::GridManager() {
-  m_changed.setOnChange([this]() { m_cellPublisher.notifySubscribers(); });
+GridManager::GridManager() {}
+
+void GridManager::CellWatch::update() {
+  m_manager.m_changedCell = m_coord;
+  m_manager.m_cellPublisher.notifySubscribers();
+}
+
+void GridManager::watch(size_t index, Grid::IGrid *grid, Vec2u coord) {
+  if (index >= m_watches.size())
+    m_watches.resize(index + 1);
+  if (!m_watches[index])
+    m_watches[index] = std::make_unique<CellWatch>(*this, coord);
+  grid->subscribeOnChanged(m_watches[index].get());
 }
 
 GridManager &GridManager::clear() {
@@ -40,10 +51,11 @@ GridManager &GridManager::allocate(size_t rows, size_t cols, Vec2 start,
   for (size_t i = 0; i < rows; i++) {
     for (size_t j = 0; j < cols; j++) {
       m_grid.emplace_back(m_factory->createGrid({i, j}));
-      m_grid.back()->subscribeOnChanged(&m_changed);
+      watch(m_grid.size() - 1, m_grid.back().get(), {j, i});
     }
   }
 
+  m_outlineDirty = true;
   m_gridPublisher.notifySubscribers();
 
   return *this;
@@ -55,6 +67,7 @@ GridManager &GridManager::setGridFactory(GridFactories::IFactory *gridFactory) {
   }
 
   m_graph.reset(m_factory->createGraph());
+  m_outlineDirty = true;
 
   for (size_t i = 0; i < m_gridSize[1]; i++) {
     for (size_t j = 0; j < m_gridSize[0]; j++) {
@@ -62,7 +75,7 @@ GridManager &GridManager::setGridFactory(GridFactories::IFactory *gridFactory) {
 
       auto *grid = m_factory->createGrid({i, j});
       grid->set(m_grid[idx]->reset());
-      grid->subscribeOnChanged(&m_changed);
+      watch(idx, grid, {j, i});
       grid->tickSetup();
 
       m_grid[idx].reset(grid);
@@ -82,16 +95,20 @@ GridManager &GridManager::resize(size_t rows, size_t cols) {
 
   std::vector<std::unique_ptr<Grid::IGrid>> newGrid;
   newGrid.reserve(newTotal);
+  // Kept cells stay subscribed to their watch, which moves with them
+  std::vector<std::unique_ptr<CellWatch>> watches;
+  watches.swap(m_watches);
 
   for (size_t r = 0; r < rows; ++r) {
     for (size_t c = 0; c < cols; ++c) {
       if (r < oldSize[0] && c < oldSize[1]) {
         size_t oldIdx = r * oldSize[1] + c;
         newGrid.push_back(std::move(m_grid.at(oldIdx)));
+        m_watches.push_back(std::move(watches.at(oldIdx)));
       } else {
         Vec2u pos = {r, c};
         auto item = m_factory->createGrid(pos);
-        item->subscribeOnChanged(&m_changed);
+        watch(m_watches.size(), item, {c, r});
         newGrid.emplace_back(item);
       }
     }
@@ -112,6 +129,7 @@ GridManager &GridManager::resize(size_t rows, size_t cols) {
   }
   m_occupied = std::move(newOccupied);
 
+  m_outlineDirty = true;
   m_gridPublisher.notifySubscribers();
 
   return *this;
@@ -119,6 +137,8 @@ GridManager &GridManager::resize(size_t rows, size_t cols) {
 
 GridManager &GridManager::deallocate() {
   m_grid.clear();
+  m_watches.clear();
+  m_outlineDirty = true;
   m_gridPublisher.notifySubscribers();
   return *this;
 }
@@ -208,19 +228,53 @@ void GridManager::setup() {
     grid->tickSetup();
   }
 }
+void GridManager::setupLayers(Engine::Engine &engine) {
+  using Policy = Engine::Objects::Layer::Policy;
+
+  m_layers = Layers{
+      .cells = engine.createLayer("cells", Policy::DYNAMIC, 0),
+      .outline = engine.createLayer("outline", Policy::STATIC, 1),
+      .overlays = engine.createLayer("overlays", Policy::STREAM, 2),
+  };
+}
+
 bool GridManager::update(Engine::Engine &engine, std::optional<double> dt) {
+  if (!m_layers)
+    setupLayers(engine);
+
+  if (m_outlineDirty) {
+    engine.clearLayer(m_layers->outline);
+    engine.useLayer(m_layers->outline);
+    for (auto &grid : m_grid) {
+      grid->drawOutline(engine);
+    }
+    m_outlineDirty = false;
+  }
+
+  engine.clearLayer(m_layers->cells);
+  engine.clearLayer(m_layers->overlays);
+
   bool allDone = true;
   m_uuidLookUp.clear();
 
+  // Contents first, they decide the fill of their cell
+  engine.useLayer(m_layers->overlays);
   for (auto &grid : m_grid) {
     if (dt) {
       if (!grid->tick(engine, *dt)) {
         allDone = false;
       }
     }
+    grid->drawCell(engine);
+  }
+
+  engine.useLayer(m_layers->cells);
+  for (auto &grid : m_grid) {
     grid->draw(engine);
     m_uuidLookUp.insert({grid->getUUID(), grid.get()});
   }
+
+  engine.useLayer(m_layers->overlays);
   return allDone;
 }
 
@@ -243,6 +297,8 @@ GridManager &GridManager::unsubscribeOnGridChange(Subscriber *obs) {
   return *this;
 }
 
+Vec2u GridManager::changedCell() const { return m_changedCell; }
+
 GridManager &GridManager::get() {
   static GridManager *m_instance = new GridManager();
   return *m_instance;
@@ -7,19 +7,25 @@ namespace Grid {
 
 SquareGrid::SquareGrid(Vec2u coord) : IGrid(coord) {}
 
-void SquareGrid::draw(Engine::Engine &engine) {
+void SquareGrid::corners(Vec2 out[4]) const {
   Vec2 gridSize = GridManager::get().getCellSize();
   Vec2 start = GridManager::get().start();
 
   start[0] += gridSize[0] * m_coord[1];
   start[1] += gridSize[1] * m_coord[0];
-  Vec2 corners[4] = {start, start, start, start};
+  for (size_t i = 0; i < 4; i++)
+    out[i] = start;
+
+  out[1][0] += gridSize[0];
+  out[2][1] += gridSize[1];
 
-  corners[1][0] += gridSize[0];
-  corners[2][1] += gridSize[1];
+  out[3][0] += gridSize[0];
+  out[3][1] += gridSize[1];
+}
 
-  corners[3][0] += gridSize[0];
-  corners[3][1] += gridSize[1];
+void SquareGrid::drawOutline(Engine::Engine &engine) {
+  Vec2 corners[4];
+  this->corners(corners);
 
   const Color LINE_COLOR = {1, 1, 1};
   const float LINE_STROKE = 2;
@@ -28,12 +34,14 @@ void SquareGrid::draw(Engine::Engine &engine) {
   engine.createLine(corners[0], corners[2], LINE_COLOR, LINE_STROKE);
   engine.createLine(corners[1], corners[3], LINE_COLOR, LINE_STROKE);
   engine.createLine(corners[2], corners[3], LINE_COLOR, LINE_STROKE);
+}
+
+void SquareGrid::draw(Engine::Engine &engine) {
+  Vec2 corners[4];
+  this->corners(corners);
 
   std::vector<Vec2> verts(corners, corners + 4);
   poly = &engine.createPoly(verts, m_fill, m_fill, 0, false);
-
-  if (m_cell)
-    m_cell->draw(engine);
 }
 
 Vec2 SquareGrid::center() const {
@@ -3,6 +3,7 @@
 #include "Grid/Manager.hpp"
 
 #include <algorithm>
+#include <unordered_map>
 
 std::vector<Vec2u> Dijkstra::ShortestPath(Vec2u start, Vec2u end,
                                           Grid::IGraph *graph) {
@@ -71,3 +72,72 @@ std::vector<Vec2u> Dijkstra::ShortestPath(Vec2u start, Vec2u end,
 
   return path;
 }
+
+std::vector<Vec2u> Dijkstra::SparsePath(Vec2u start, Vec2u end,
+                                        Grid::IGraph *graph, size_t cells) {
+  GridManager &grid = GridManager::get();
+  if (!grid.allocated())
+    return {};
+
+  struct Visit {
+    int dist;
+    Vec2u parent;
+  };
+
+  const uint32_t UINTMAX = std::numeric_limits<uint32_t>::max();
+  const size_t cols = grid.cols();
+  auto key = [cols](Vec2u coord) { return coord[1] * cols + coord[0]; };
+
+  std::unordered_map<size_t, Visit> visits;
+  visits.reserve(cells);
+
+  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> pq;
+
+  visits[key(start)] = {0, {UINTMAX, UINTMAX}};
+  pq.push({0, start});
+
+  while (!pq.empty()) {
+    Node current = pq.top();
+    pq.pop();
+
+    int d = current.dist;
+    Vec2u u = current.pos;
+
+    if (u == end) {
+      break;
+    }
+
+    if (d > visits[key(u)].dist) {
+      continue;
+    }
+
+    for (Vec2u next : graph->getNeighbors(u)) {
+      if (grid.get(next)->isBlocking())
+        continue;
+
+      int newDist = d + 1;
+      auto [it, added] = visits.try_emplace(key(next), Visit{newDist, u});
+      if (added || newDist < it->second.dist) {
+        it->second = {newDist, u};
+        pq.push({newDist, next});
+      }
+    }
+  }
+
+  std::vector<Vec2u> path;
+
+  auto reached = visits.find(key(end));
+  if (reached == visits.end()) {
+    return path;
+  }
+
+  Vec2u curr = end;
+  while (!(curr[1] == UINTMAX && curr[0] == UINTMAX)) {
+    path.push_back(curr);
+    curr = visits[key(curr)].parent;
+  }
+
+  std::reverse(path.begin(), path.end());
+
+  return path;
+}
@@ -1,6 +1,10 @@
 #include "Path/Manager.hpp"
 #include "Grid/Manager.hpp"
 #include "Path/Dijkstra.hpp"
+#include "Path/Roadmap.hpp"
+#include "Path/Territories.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/StatsManager.hpp"
 #include <iostream>
 
 #include "Tracy.hpp"
@@ -12,11 +16,13 @@ struct PathManager::PathID {
   DynamicInfo info;
   Vec2u start;
   Vec2u end;
+  // To the nearest destination, `end` is only where it was at the request
+  bool nearest;
 
   OnChangeCallback callback = nullptr;
 
-  PathID(decltype(dataRef) ref, DynamicInfo i, Vec2u s, Vec2u e)
-      : dataRef(ref), info(i), start(s), end(e) {}
+  PathID(decltype(dataRef) ref, DynamicInfo i, Vec2u s, Vec2u e, bool n)
+      : dataRef(ref), info(i), start(s), end(e), nearest(n) {}
 };
 
 void PathManager::PathDeleter::operator()(PathID *p) const {
@@ -36,10 +42,21 @@ PathManager::PathManager() {
 
   auto onChange = [this]() {
     std::cout << "[PathManager] Grid changed. Invalidating paths...\n";
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_roadmap.reset();
+    }
     this->invalidateAll();
   };
   m_onGridChange.setOnChange(onChange);
   GridManager::get().subscribeOnGridChange(&m_onGridChange);
+
+  // The roadmap is a snapshot, painted or erased walls need a new one
+  m_onCellChange.setOnChange([this]() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_roadmap.reset();
+  });
+  GridManager::get().subscribeOnCellChange(&m_onCellChange);
 }
 
 PathManager::~PathManager() {
@@ -52,14 +69,40 @@ PathManager::PathPtr PathManager::requestPath(DynamicInfo info, Vec2u start,
                                               Vec2u end) {
   ZoneScoped;
 
-  m_pathStore.emplace_front();
-  auto it = m_pathStore.begin();
+  std::shared_ptr<Roadmap> roadmap;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    roadmap = m_roadmap;
+  }
+
+  return store(plan(start, end, roadmap), info, start, end, false);
+}
+
+PathManager::PathPtr PathManager::requestNearestPath(DynamicInfo info,
+                                                     Vec2u start) {
+  ZoneScoped;
 
-  PathID *id = new PathID(it, info, start, end);
-  *id->dataRef =
-      Dijkstra::ShortestPath(id->start, id->end, GridManager::get().getGraph());
+  // Agents ask from workers, the first one brings the Territories up to date
+  std::vector<Vec2u> path;
+  {
+    std::lock_guard<std::mutex> lock(m_territoryMutex);
+    Territories::get().update();
+    path = Territories::get().path(start);
+  }
+  Vec2u end = path.empty() ? start : path.back();
+  return store(std::move(path), info, start, end, true);
+}
 
+PathManager::PathPtr PathManager::store(std::vector<Vec2u> path,
+                                        DynamicInfo info, Vec2u start,
+                                        Vec2u end, bool nearest) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pathStore.emplace_front(std::move(path));
+  auto it = m_pathStore.begin();
+
+  PathID *id = new PathID(it, info, start, end, nearest);
   m_registry.insert(id);
+  m_nearest += nearest;
 
   return PathPtr(id);
 }
@@ -73,7 +116,9 @@ void PathManager::unregisterPath(PathID *id) {
   if (!id)
     return;
 
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_registry.erase(id);
+  m_nearest -= id->nearest;
 
   m_pathStore.erase(id->dataRef);
 }
@@ -88,15 +133,49 @@ void PathManager::invalidateAll() {
 void PathManager::update() {
   ZoneScoped;
 
-  for (auto *id : m_registry) {
+  bool useRoadmap = std::get<bool>(
+      StatsManager::get().get("roadmapPath").value_or(false));
+
+  std::shared_ptr<Roadmap> roadmap;
+  bool nearest;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    nearest = m_nearest > 0;
+    // A new grid factory swaps the graph without reallocating
+    if (!useRoadmap || !GridManager::get().allocated()) {
+      m_roadmap.reset();
+    } else if (!m_roadmap ||
+               m_roadmap->graph() != GridManager::get().getGraph()) {
+      m_roadmap = std::make_shared<Roadmap>(GridManager::get().getGraph());
+    }
+    roadmap = m_roadmap;
+  }
 
-    std::vector<Vec2u> newPath = Dijkstra::ShortestPath(
-        id->start, id->end, GridManager::get().getGraph());
+  // Only kept up to date while some path reads them
+  Territories &territories = Territories::get();
+  if (nearest) {
+    std::lock_guard<std::mutex> lock(m_territoryMutex);
+    territories.update();
+  }
 
-    if (newPath.empty()) {
+  std::vector<PathID *> ids(m_registry.begin(), m_registry.end());
+  std::vector<std::vector<Vec2u>> paths(ids.size());
 
-    } else {
-      *id->dataRef = std::move(newPath);
+  // Each search only reads the grid, so they are independent
+  JobSystem::get().parallelFor(0, ids.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      paths[i] = ids[i]->nearest ? territories.path(ids[i]->start)
+                                 : plan(ids[i]->start, ids[i]->end, roadmap);
+    }
+  });
+
+  for (size_t i = 0; i < ids.size(); i++) {
+    PathID *id = ids[i];
+
+    if (!paths[i].empty()) {
+      if (id->nearest)
+        id->end = paths[i].back();
+      *id->dataRef = std::move(paths[i]);
     }
 
     if (id->callback) {
@@ -105,6 +184,33 @@ void PathManager::update() {
   }
 }
 
+std::vector<Vec2u> PathManager::plan(Vec2u start, Vec2u end,
+                                     const std::shared_ptr<Roadmap> &roadmap) {
+  Grid::IGraph *graph = GridManager::get().getGraph();
+  // Built on a graph since swapped, until update() replaces it
+  if (!roadmap || roadmap->graph() != graph) {
+    return Dijkstra::ShortestPath(start, end, graph);
+  }
+
+  std::vector<Vec2u> on = roadmap->retract(start);
+  std::vector<Vec2u> off = roadmap->retract(end);
+  if (on.empty() || off.empty()) {
+    return Dijkstra::ShortestPath(start, end, graph);
+  }
+
+  // Rows * cols of search state would outweigh a search of the ridge
+  std::vector<Vec2u> along = Dijkstra::SparsePath(
+      on.back(), off.back(), roadmap.get(), roadmap->size());
+  if (along.empty()) {
+    return Dijkstra::ShortestPath(start, end, graph);
+  }
+
+  std::vector<Vec2u> path(on.begin(), on.end() - 1);
+  path.insert(path.end(), along.begin(), along.end());
+  path.insert(path.end(), off.rbegin() + 1, off.rend());
+  return path;
+}
+
 std::optional<Vec2> PathManager::getSegment(PathID *id, size_t i) {
   if (!id || i >= id->dataRef->size())
     return std::nullopt;
@@ -0,0 +1,173 @@
+#include "Path/Roadmap.hpp"
+
+#include "Grid/Manager.hpp"
+
+#include <algorithm>
+#include <queue>
+
+#include "Tracy.hpp"
+
+Roadmap::Roadmap(Grid::IGraph *graph)
+    : m_graph(graph), m_rows(GridManager::get().rows()),
+      m_cols(GridManager::get().cols()) {
+  ZoneScoped;
+
+  GridManager &grid = GridManager::get();
+  const size_t cells = m_rows * m_cols;
+
+  std::vector<bool> blocked(cells);
+  for (uint32_t i = 0; i < cells; i++) {
+    blocked[i] = grid.get(coord(i))->isBlocking();
+  }
+
+  // Connected obstacles
+  std::vector<uint32_t> label(cells, NONE);
+  uint32_t obstacles = 0;
+  std::vector<uint32_t> stack;
+  for (uint32_t i = 0; i < cells; i++) {
+    if (!blocked[i] || label[i] != NONE)
+      continue;
+
+    label[i] = obstacles;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      uint32_t u = stack.back();
+      stack.pop_back();
+      for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+        uint32_t v = index(next);
+        if (blocked[v] && label[v] == NONE) {
+          label[v] = obstacles;
+          stack.push_back(v);
+        }
+      }
+    }
+    obstacles++;
+  }
+
+  // Brushfire, obstacles at 0 and the free cells on each side of the grid at
+  // 1, as if a wall ran around it
+  std::vector<uint32_t> distance(cells, NONE);
+  std::queue<uint32_t> queue;
+  for (uint32_t i = 0; i < cells; i++) {
+    if (blocked[i]) {
+      distance[i] = 0;
+      queue.push(i);
+    }
+  }
+  for (uint32_t i = 0; i < cells; i++) {
+    if (blocked[i])
+      continue;
+
+    Vec2u c = coord(i);
+    uint32_t side = NONE;
+    if (c[0] == 0)
+      side = 0;
+    else if (c[0] + 1 == m_cols)
+      side = 1;
+    else if (c[1] == 0)
+      side = 2;
+    else if (c[1] + 1 == m_rows)
+      side = 3;
+
+    if (side != NONE) {
+      distance[i] = 1;
+      label[i] = obstacles + side;
+      queue.push(i);
+    }
+  }
+
+  while (!queue.empty()) {
+    uint32_t u = queue.front();
+    queue.pop();
+    for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+      uint32_t v = index(next);
+      if (distance[v] == NONE) {
+        distance[v] = distance[u] + 1;
+        label[v] = label[u];
+        queue.push(v);
+      }
+    }
+  }
+
+  // Both cells of a pair with different labels are kept, a one cell ridge
+  // would not stay connected on a four neighbour grid
+  m_onRoadmap.assign(cells, false);
+  for (uint32_t i = 0; i < cells; i++) {
+    if (blocked[i] || distance[i] <= 1 || distance[i] == NONE)
+      continue;
+
+    for (Vec2u next : m_graph->getNeighbors(coord(i))) {
+      uint32_t v = index(next);
+      if (!blocked[v] && label[v] != label[i]) {
+        m_onRoadmap[i] = true;
+        m_size++;
+        break;
+      }
+    }
+  }
+
+  // Retraction, breadth first from the roadmap over the free cells
+  m_toward.assign(cells, NONE);
+  m_reached.assign(cells, false);
+  for (uint32_t i = 0; i < cells; i++) {
+    if (m_onRoadmap[i]) {
+      m_reached[i] = true;
+      queue.push(i);
+    }
+  }
+
+  while (!queue.empty()) {
+    uint32_t u = queue.front();
+    queue.pop();
+    for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+      uint32_t v = index(next);
+      if (!blocked[v] && !m_reached[v]) {
+        m_reached[v] = true;
+        m_toward[v] = u;
+        queue.push(v);
+      }
+    }
+  }
+}
+
+std::vector<Vec2u> Roadmap::getNeighbors(Vec2u coord) {
+  std::vector<Vec2u> neighbors = m_graph->getNeighbors(coord);
+  neighbors.erase(std::remove_if(neighbors.begin(), neighbors.end(),
+                                 [this](Vec2u next) { return !isValid(next); }),
+                  neighbors.end());
+  return neighbors;
+}
+
+bool Roadmap::isValid(Vec2u coord) {
+  if (coord[1] >= m_rows || coord[0] >= m_cols)
+    return false;
+  return m_onRoadmap[index(coord)];
+}
+
+std::vector<Vec2u> Roadmap::retract(Vec2u from) const {
+  std::vector<Vec2u> path;
+  if (from[1] >= m_rows || from[0] >= m_cols)
+    return path;
+
+  uint32_t i = index(from);
+  if (!m_reached[i])
+    return path;
+
+  path.push_back(from);
+  for (i = m_toward[i]; i != NONE; i = m_toward[i]) {
+    path.push_back(coord(i));
+  }
+  return path;
+}
+
+size_t Roadmap::size() const { return m_size; }
+
+Grid::IGraph *Roadmap::graph() const { return m_graph; }
+
+uint32_t Roadmap::index(Vec2u coord) const {
+  return (uint32_t)(coord[1] * m_cols + coord[0]);
+}
+
+Vec2u Roadmap::coord(uint32_t index) const {
+  return {index % m_cols, index / m_cols};
+}
@@ -0,0 +1,231 @@
+#include "Path/Territories.hpp"
+
+#include "Grid/Manager.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "Tracy.hpp"
+
+Territories &Territories::get() {
+  static Territories *m_instance = new Territories();
+  return *m_instance;
+}
+
+Territories::Territories() {
+  // Nobody may read them for a while, past one per cell a rebuild is cheaper
+  m_onCellChange.setOnChange([this]() {
+    if (m_changed.size() > m_state.size())
+      m_reallocated = true;
+    else
+      m_changed.push_back(GridManager::get().changedCell());
+  });
+  m_onGridChange.setOnChange([this]() { m_reallocated = true; });
+  GridManager::get().subscribeOnCellChange(&m_onCellChange);
+  GridManager::get().subscribeOnGridChange(&m_onGridChange);
+}
+
+void Territories::update() {
+  ZoneScoped;
+
+  GridManager &grid = GridManager::get();
+  if (!grid.allocated()) {
+    m_graph = nullptr;
+    m_rows = m_cols = 0;
+    m_state.clear();
+    m_label.clear();
+    m_distance.clear();
+    m_toward.clear();
+    m_changed.clear();
+    return;
+  }
+
+  // A new grid factory swaps the graph without reallocating
+  if (m_reallocated || grid.getGraph() != m_graph || grid.rows() != m_rows ||
+      grid.cols() != m_cols) {
+    m_graph = grid.getGraph();
+    m_rows = grid.rows();
+    m_cols = grid.cols();
+    m_reallocated = false;
+    m_changed.clear();
+    rebuild();
+    return;
+  }
+
+  if (m_changed.empty())
+    return;
+
+  // Only the cells reported, a cell changed back and forth is left out
+  std::vector<uint32_t> changed;
+  for (Vec2u at : m_changed) {
+    if (at[0] >= m_cols || at[1] >= m_rows)
+      continue;
+    uint32_t i = index(at);
+    Grid::IGrid *cell = grid.get(at);
+    State state = cell->isBlocking()      ? BLOCKED
+                  : cell->isDestination() ? SOURCE
+                                          : FREE;
+    if (state != m_state[i])
+      changed.push_back(i);
+  }
+  m_changed.clear();
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+  if (!changed.empty())
+    repair(changed);
+}
+
+std::optional<Vec2u> Territories::nearest(Vec2u coord) const {
+  uint32_t d = distance(coord);
+  if (d == NONE)
+    return std::nullopt;
+
+  return this->coord(m_label[index(coord)]);
+}
+
+uint32_t Territories::distance(Vec2u coord) const {
+  if (coord[0] >= m_cols || coord[1] >= m_rows)
+    return NONE;
+
+  return m_distance[index(coord)];
+}
+
+std::vector<Vec2u> Territories::path(Vec2u from) const {
+  std::vector<Vec2u> path;
+  uint32_t d = distance(from);
+  if (d == NONE)
+    return path;
+
+  path.reserve(d + 1);
+  path.push_back(from);
+  for (uint32_t i = m_toward[index(from)]; i != NONE; i = m_toward[i]) {
+    path.push_back(coord(i));
+  }
+  return path;
+}
+
+void Territories::rebuild() {
+  ZoneScoped;
+
+  GridManager &grid = GridManager::get();
+  const size_t cells = m_rows * m_cols;
+
+  m_state.assign(cells, FREE);
+  m_label.assign(cells, NONE);
+  m_distance.assign(cells, NONE);
+  m_toward.assign(cells, NONE);
+
+  std::vector<uint32_t> seeds;
+  for (uint32_t i = 0; i < cells; i++) {
+    Grid::IGrid *cell = grid.get(coord(i));
+    if (cell->isBlocking()) {
+      m_state[i] = BLOCKED;
+    } else if (cell->isDestination()) {
+      m_state[i] = SOURCE;
+      m_label[i] = i;
+      m_distance[i] = 0;
+      seeds.push_back(i);
+    }
+  }
+
+  spread(seeds);
+}
+
+void Territories::repair(const std::vector<uint32_t> &changed) {
+  ZoneScoped;
+
+  GridManager &grid = GridManager::get();
+
+  // Cells whose next steps led through a lost destination or a new obstacle
+  std::vector<uint32_t> dropped;
+  std::vector<uint32_t> freed;
+  std::vector<uint32_t> seeds;
+  for (uint32_t i : changed) {
+    Grid::IGrid *cell = grid.get(coord(i));
+    State before = m_state[i];
+    State now = cell->isBlocking()      ? BLOCKED
+                : cell->isDestination() ? SOURCE
+                                        : FREE;
+    m_state[i] = now;
+
+    if ((before == SOURCE || now == BLOCKED) && m_distance[i] != NONE) {
+      size_t first = dropped.size();
+      m_distance[i] = m_label[i] = m_toward[i] = NONE;
+      dropped.push_back(i);
+
+      for (size_t k = first; k < dropped.size(); k++) {
+        uint32_t u = dropped[k];
+        for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+          uint32_t v = index(next);
+          if (m_toward[v] == u && m_distance[v] != NONE) {
+            m_distance[v] = m_label[v] = m_toward[v] = NONE;
+            dropped.push_back(v);
+          }
+        }
+      }
+    }
+
+    if (before == BLOCKED && now != BLOCKED)
+      freed.push_back(i);
+  }
+
+  // After every drop, a later change may have dropped an earlier source
+  for (uint32_t i : changed) {
+    if (m_state[i] == SOURCE) {
+      m_label[i] = i;
+      m_distance[i] = 0;
+      m_toward[i] = NONE;
+      seeds.push_back(i);
+    }
+  }
+
+  // The cells still reached around the holes fill them in again
+  for (const std::vector<uint32_t> *holes : {&dropped, &freed}) {
+    for (uint32_t u : *holes) {
+      for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+        uint32_t v = index(next);
+        if (m_state[v] != BLOCKED && m_distance[v] != NONE)
+          seeds.push_back(v);
+      }
+    }
+  }
+
+  spread(seeds);
+}
+
+void Territories::spread(std::vector<uint32_t> &seeds) {
+  // Seeds sit at different distances, so a priority queue rather than FIFO
+  using Entry = std::pair<uint32_t, uint32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  for (uint32_t i : seeds) {
+    queue.push({m_distance[i], i});
+  }
+
+  while (!queue.empty()) {
+    auto [d, u] = queue.top();
+    queue.pop();
+    if (d != m_distance[u])
+      continue;
+
+    for (Vec2u next : m_graph->getNeighbors(coord(u))) {
+      uint32_t v = index(next);
+      if (m_state[v] == BLOCKED || d + 1 >= m_distance[v])
+        continue;
+
+      m_distance[v] = d + 1;
+      m_label[v] = m_label[u];
+      m_toward[v] = u;
+      queue.push({d + 1, v});
+    }
+  }
+}
+
+uint32_t Territories::index(Vec2u coord) const {
+  return (uint32_t)(coord[1] * m_cols + coord[0]);
+}
+
+Vec2u Territories::coord(uint32_t index) const {
+  return {index % m_cols, index / m_cols};
+}
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <iostream>
 #include <optional>
+#include <random>
 
 namespace Simulation {
 
@@ -36,6 +37,14 @@ void Agent::setStrategy(std::unique_ptr<Collision::IStrategy> newStrategy) {
   strategy = std::move(newStrategy);
 }
 
+PathManager::PathPtr Agent::requestPath() const {
+  PathManager &pm = PathManager::get();
+  if (goal.nearest)
+    return pm.requestNearestPath({maxSpeed, radius}, goal.start);
+
+  return pm.requestPath({maxSpeed, radius}, goal.start, goal.end);
+}
+
 void Agent::reset() {
   i = 0;
   velocity = {0, 0};
@@ -48,17 +57,27 @@ void Agent::reset() {
 void Agent::draw(Engine::Engine &engine) {}
 
 void Agent::update(double dt) {
-  if (!goals.empty() && i >= goals.size()) {
-    position = finalPos;
+  plan(dt);
+  commit();
+}
+
+void Agent::plan(double dt) {
+  m_arrived = !goals.empty() && i >= goals.size();
+  if (m_arrived) {
+    // finalPos is only known for a fixed destination
+    m_next = goal.nearest ? goals.back() : finalPos;
     return;
   }
 
+  // rand() is not reentrant and plan() may run on any worker
+  thread_local std::minstd_rand rng(std::random_device{}());
+
   Vec2 goal = position;
   if (!goals.empty()) {
     goal = goals[i];
     Vec2 direction = goal - position;
     direction.norm();
-    float noise = ((rand() % 100) / 100.0f - 0.5f) * 0.1f;
+    float noise = ((rng() % 100) / 100.0f - 0.5f) * 0.1f;
     direction[0] += noise;
     direction[1] += noise;
     direction.norm();
@@ -74,15 +93,21 @@ void Agent::update(double dt) {
     velocity = preferredVelocity;
   }
 
-  Vec2 newPosition = position + (velocity * (float)dt);
+  m_next = position + (velocity * (float)dt);
 
-  float distSq = (goal - newPosition).magSq();
+  float distSq = (goal - m_next).magSq();
   float tolerance = 2.0f;
 
-  if (distSq < (tolerance * tolerance)) {
+  m_reached = distSq < (tolerance * tolerance);
+}
+
+void Agent::commit() {
+  position = m_next;
+  if (m_arrived)
+    return;
+
+  if (m_reached)
     i++;
-  }
-  position = newPosition;
 
   static GridManager &gm = GridManager::get();
   static Invoker &ink = Invoker::get();
@@ -41,8 +41,7 @@ Vec2 RvoStrategy::computeVelocity(Agent *me) {
 
   if (me->goals.empty()) {
     PathManager &pm = PathManager::get();
-    me->pathID = pm.requestPath({me->maxSpeed, me->radius}, me->goal.start,
-                                me->goal.end);
+    me->pathID = me->requestPath();
 
     auto processPath = processes.at(me);
     processPath();
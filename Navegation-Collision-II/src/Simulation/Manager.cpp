@@ -1,5 +1,6 @@
 #include "Simulation/Manager.hpp"
 
+#include "Utils/JobSystem.hpp"
 #include "Utils/StatsManager.hpp"
 #include "engine.hpp"
 
@@ -79,11 +80,15 @@ void Manager::update(double dt) {
       system->preStep(dt);
     }
 
-    for (auto &agent : agents) {
+    if (system->concurrent()) {
+      step(dt);
+    } else {
+      for (auto &agent : agents) {
 
-      {
-        ZoneScopedN("Sim::update");
-        agent->update(dt);
+        {
+          ZoneScopedN("Sim::update");
+          agent->update(dt);
+        }
       }
     }
 
@@ -94,4 +99,27 @@ void Manager::update(double dt) {
   }
 }
 
+// Every agent plans against the same snapshot of the others, then all of them
+// move at once, in list order so the grid commands stay deterministic
+void Manager::step(double dt) {
+  ZoneScopedN("Sim::step");
+
+  m_batch.clear();
+  for (auto &agent : agents) {
+    m_batch.push_back(agent.get());
+  }
+
+  JobSystem::get().parallelFor(0, m_batch.size(), AGENT_GRAIN,
+                               [this, dt](size_t begin, size_t end) {
+                                 ZoneScopedN("Sim::plan");
+                                 for (size_t i = begin; i < end; i++) {
+                                   m_batch[i]->plan(dt);
+                                 }
+                               });
+
+  for (Agent *agent : m_batch) {
+    agent->commit();
+  }
+}
+
 } // namespace Simulation
\ No newline at end of file
@@ -67,20 +67,27 @@ struct MyWindow : public Engine::Window {
 
     if (refresh) {
       refresh = false;
-      clearEngine();
 
-      if (GridManager::get().allocated()) {
+      if (!GridManager::get().allocated()) {
+        clearEngine();
+      } else {
+        // Only the dynamic layers are rebuilt, the grid outline is kept
+        anim.loop(dt);
+
         Vec2 start = GridManager::get().start();
         Vec2 end = GridManager::get().end();
 
         m_engine->createPoint(end, {1, 1, 0}, 8);
         m_engine->createPoint(start, {0, 1, 1}, 8);
-
-        anim.loop(dt);
       }
     }
   }
 
+  // A pending rebuild or a playing animation keeps the window loop awake
+  bool animating() override {
+    return refresh || anim.getState() == decltype(anim)::PlayerState::PLAYING;
+  }
+
   void uiUpdate() {
     ZoneScoped;
 
@@ -194,8 +201,15 @@ struct MyWindow : public Engine::Window {
       static double radius = std::get<double>(sm.get("agentsRadius").value());
       static double speed = std::get<double>(sm.get("agentsSpeed").value());
       static bool midPoints = std::get<bool>(sm.get("midPointPath").value());
+      static bool roadmap = std::get<bool>(sm.get("roadmapPath").value());
 
       ImGui::Checkbox("midPoints", &midPoints);
+      ImGui::SameLine();
+      // Paths are only planned again once dirty, as after a cell edit
+      if (ImGui::Checkbox("roadmap", &roadmap)) {
+        dirty = true;
+        anim.pause();
+      }
       ImGui::PushItemWidth(120.0f);
       ImGui::InputDouble("radius", &radius);
       if (radius <= 10) {
@@ -213,6 +227,7 @@ struct MyWindow : public Engine::Window {
       sm.set("agentsRadius", radius);
       sm.set("agentsSpeed", speed);
       sm.set("midPointPath", midPoints);
+      sm.set("roadmapPath", roadmap);
     }
 
     ImGui::Spacing();
@@ -424,8 +439,13 @@ private:
           Vec2 end = {glx, gly};
           Vec2u endGrid = GridManager::get().getCoord(end);
 
-          if (endGrid == *m_startGrid ||
-              !GridManager::get().cget(endGrid)->empty()) {
+          // Released where it started: to the nearest destination instead
+          if (endGrid == *m_startGrid) {
+            Invoker::get().addCommand(new Commands::AddCell(
+                CellFactory::get().Create(
+                    CellFactory::CellType::ORIGIN_NEAREST, *m_startGrid),
+                *m_startGrid));
+          } else if (!GridManager::get().cget(endGrid)->empty()) {
             Invoker::get().addCommand(new Commands::RemoveCell(*m_startGrid));
             std::cout << "short\n";
           } else {
@@ -499,6 +519,7 @@ private:
     sm.set("agentsSpeed", 150.0);
     sm.set("agentsRadius", 16.0);
     sm.set("midPointPath", false);
+    sm.set("roadmapPath", false);
 
     sm.set("sample", 1ull);
     sm.set("run", 1ull);
@@ -0,0 +1,23 @@
+#ifndef VORONOI_BENCH_HPP
+#define VORONOI_BENCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Times every method on uniform random sites and writes one csv row per run
+// to `path`. The half-plane method is too slow past ORACLE_LIMIT sites, up
+// to there it also checks the area of every cell of the others. Every
+// method must also cover the area it does on fine lattices far from the
+// origin.
+int RunBenchmark(const std::string &path,
+                 const std::vector<size_t> &sizes = {1000, 10000, 100000,
+                                                     1000000});
+
+// Relaxes uniform random sites with warm-started Lloyd iterations and
+// writes one row per iteration, next to the time a rebuild from scratch of
+// the same sites and cells takes
+int RunLloydBenchmark(const std::string &path, size_t sites = 100000,
+                      size_t iterations = 100);
+
+#endif // VORONOI_BENCH_HPP
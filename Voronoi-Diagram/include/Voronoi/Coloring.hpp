@@ -0,0 +1,100 @@
+#ifndef VORONOI_COLORING_HPP
+#define VORONOI_COLORING_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Geometry.hpp"
+
+inline Line RgbToXyz(const Line &rgb) {
+  auto linearize = [](float value) {
+    if (value > 0.04045f) {
+      return powf((value + 0.055f) / 1.055f, 2.4f);
+    }
+    return value / 12.92f;
+  };
+
+  float r = linearize(rgb[0]);
+  float g = linearize(rgb[1]);
+  float b = linearize(rgb[2]);
+
+  float x = r * 0.4124f + g * 0.3576f + b * 0.1805f;
+  float y = r * 0.2126f + g * 0.7152f + b * 0.0722f;
+  float z = r * 0.0193f + g * 0.1192f + b * 0.9505f;
+
+  return {x, y, z};
+}
+
+inline Line XyzToLab(const Line &xyz) {
+  const float ref_x = 0.95047f;
+  const float ref_y = 1.00000f;
+  const float ref_z = 1.08883f;
+
+  float x = xyz[0] / ref_x;
+  float y = xyz[1] / ref_y;
+  float z = xyz[2] / ref_z;
+
+  auto f = [](float t) {
+    if (t > 0.008856f) { // (6/29)^3
+      return cbrtf(t);
+    }
+    return (7.787f * t) + (16.0f / 116.0f);
+  };
+
+  float fx = f(x);
+  float fy = f(y);
+  float fz = f(z);
+
+  float l = (116.0f * fy) - 16.0f;
+  float a = 500.0f * (fx - fy);
+  float b = 200.0f * (fy - fz);
+
+  return {l, a, b};
+}
+
+inline float CalculateColorDifference(const Line &rgb1, const Line &rgb2) {
+  Line lab1 = XyzToLab(RgbToXyz(rgb1));
+  Line lab2 = XyzToLab(RgbToXyz(rgb2));
+
+  float deltaL = lab1[0] - lab2[0];
+  float deltaA = lab1[1] - lab2[1];
+  float deltaB = lab1[2] - lab2[2];
+
+  return sqrtf(deltaL * deltaL + deltaA * deltaA + deltaB * deltaB);
+}
+
+// Also the largest palette the coloring takes
+const uint8_t NO_COLOR = 255;
+
+// `count` colors spread in CIELAB by farthest point sampling over an RGB
+// grid, each as far as possible from the ones before and from `avoid`. The
+// seed picks the first color when there is nothing to avoid.
+// O(count * grid)
+std::vector<Line> LabPalette(size_t count, uint32_t seed,
+                             const std::vector<Line> &avoid = {});
+
+// A palette index per site so that no two Delaunay neighbours share one,
+// NO_COLOR for sites not in the triangulation
+//
+// "Smallest-last ordering and clustering and graph coloring algorithms" by
+//  David W. Matula and Leland L. Beck (1983)
+//
+// Sites are colored greedily in smallest-last order. A planar graph always
+// has a vertex with at most five neighbours, so six colors are enough. Each
+// site takes the least used color its neighbours leave free, ties broken by
+// an order drawn from the seed. O(N)
+std::vector<uint8_t> ColorSites(const Triangulation &triangulation,
+                                size_t paletteSize, uint32_t seed);
+
+// After edits: gives each of `sites` that has no color, or shares one with
+// a neighbour, a color its neighbours leave free, or the rarest around it
+// when there is none. Other sites keep theirs. O(sum of degrees)
+void RepairColors(const Triangulation &triangulation,
+                  std::vector<uint8_t> &colors,
+                  const std::vector<Triangulation::Index> &sites,
+                  size_t paletteSize);
+
+#endif // VORONOI_COLORING_HPP
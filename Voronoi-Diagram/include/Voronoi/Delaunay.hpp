@@ -0,0 +1,161 @@
+#ifndef VORONOI_DELAUNAY_HPP
+#define VORONOI_DELAUNAY_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Voronoi/Geometry.hpp"
+
+struct DelaunayEdge {
+  Vec2 p1;
+  Vec2 p2;
+};
+
+// Delaunay triangulation with adjacency, built by Bowyer-Watson insertion
+// in Hilbert order
+//
+// "Computing the n-dimensional Delaunay tessellation with application to
+//  Voronoi polytopes" by Bowyer (1981) and "Computational Geometry:
+//  Algorithms and Applications" Chapter 9
+//
+// The convex hull is closed with ghost triangles sharing the INFINITE
+// vertex, so every triangle has three neighbours and points outside the
+// hull need no special case. Until three sites are not collinear there are
+// no triangles and the sites are kept on a line.
+//
+// insert, remove and move are local: only the triangles around the site
+// change and changed() lists the sites whose cells did, so a single edit
+// costs O(sqrt(N)) for the walk plus O(degree) instead of a rebuild.
+//
+// With weights it is the regular triangulation, the dual of the power
+// diagram: the lower convex hull of the sites lifted to x² + y² - w, with
+// powertest in place of incircle. A site whose lifted point is above the
+// hull has an empty power cell and is never part of it.
+//
+// "Incremental topological flipping works for regular triangulations" by
+//  Herbert Edelsbrunner and Nimish R. Shah (1996)
+//
+// O(N log(N)) expected
+class Triangulation {
+public:
+  using Index = uint32_t;
+
+  static constexpr Index NONE = std::numeric_limits<Index>::max();
+  static constexpr Index INFINITE = NONE - 1;
+
+  struct Triangle {
+    // Counter-clockwise, ghosts have one INFINITE vertex
+    Index vertices[3];
+    // neighbours[i] is across the edge opposite vertices[i]
+    Index neighbours[3];
+  };
+
+  Triangulation() = default;
+  // Sites keep their index as vertex index
+  explicit Triangulation(const std::vector<Vec2> &sites);
+  // Regular triangulation, one weight per site. Built once: insert, remove
+  // and move throw on it
+  Triangulation(const std::vector<Vec2> &sites,
+                const std::vector<float> &weights);
+
+  // Returns the new vertex, or the existing one at the same position.
+  // Bowyer-Watson, the same triangles Lawson flips would reach
+  Index insert(const Vec2 &site);
+  // Retriangulates the star of v with Delaunay ears, v keeps its index but
+  // leaves the triangulation. False when v is not part of it. O(degree³)
+  bool remove(Index v);
+  // Moves v and keeps its index. Inside its star only the position changes
+  // and Lawson flips repair the triangles around it, otherwise it is removed
+  // and inserted again. False when v is not part of the triangulation or
+  // lands on another site, which leaves it removed
+  bool move(Index v, const Vec2 &to);
+  // Sites whose cell changed with the last insert or remove
+  const std::vector<Index> &changed() const { return m_changed; }
+  // Triangles freed by the last insert, remove or move, some reused since.
+  // With those around changed() they are every triangle the edit touched
+  const std::vector<Index> &freed() const { return m_freed; }
+
+  size_t size() const { return m_sites.size(); }
+  const Vec2 &site(Index v) const { return m_sites[v]; }
+  // False for removed and duplicated sites, and hidden ones once weighted
+  bool contains(Index v) const;
+  bool weighted() const { return !m_weights.empty(); }
+  float weight(Index v) const { return m_weights.empty() ? 0 : m_weights[v]; }
+
+  const std::vector<Triangle> &triangles() const { return m_triangles; }
+  bool alive(Index t) const { return m_triangles[t].vertices[0] != NONE; }
+  // One triangle around v, NONE while v is not part of the triangulation
+  Index triangleAround(Index v) const { return m_vertexTriangle[v]; }
+  bool ghost(Index t) const;
+  // Alive, non ghost triangles
+  size_t triangleCount() const;
+
+  // Circumcenter of a finite triangle, or power center once weighted: a
+  // vertex of the dual
+  Vec2 center(Index t) const;
+  // Edge of the dual between the cells of u and v, IsOnPositiveSide on u's
+  // side
+  Line bisector(Index u, Index v) const;
+
+  // Vertices sharing an edge with v, counter-clockwise. O(degree)
+  std::vector<Index> neighbours(Index v) const;
+
+  // Every finite edge once
+  std::vector<DelaunayEdge> edges() const;
+  // While every site is collinear, the sites ordered along the line without
+  // duplicates or hidden ones. Empty once there are triangles
+  std::vector<Index> line() const;
+
+  // The dual: one counter-clockwise cell per site clipped to the box, empty
+  // for duplicated and removed sites. O(N)
+  std::vector<Cell> voronoi(const Vec2 &topleft,
+                            const Vec2 &bottomright) const;
+  // A single cell of the dual. O(degree)
+  Cell cell(Index v, const Vec2 &topleft, const Vec2 &bottomright) const;
+
+private:
+  // Both return v, or the vertex already at its position
+  Index add(Index v);
+  Index addToLine(Index v);
+  void start(Index a, Index b, Index c);
+
+  Index locate(const Vec2 &p) const;
+  bool conflict(Index t, Index v) const;
+  // d inside the circle of the counter-clockwise a, b, c, any may be
+  // INFINITE. Negative power to their orthogonal circle once weighted
+  bool encloses(Index a, Index b, Index c, Index d) const;
+  void carve(Index v, Index first);
+  // Swaps the edge opposite vertices[i] of t for the other diagonal of its
+  // quad, t and the neighbour keep their indices
+  void flip(Index t, int i);
+  // Starts over from the given vertices, for edits that change dimension
+  void rebuild(const std::vector<Index> &vertices);
+
+  Index newTriangle(Index a, Index b, Index c);
+  void freeTriangle(Index t);
+
+  std::vector<Vec2> m_sites;
+  // Empty unless weighted
+  std::vector<float> m_weights;
+  std::vector<Triangle> m_triangles;
+  std::vector<Index> m_free;
+  // One triangle around each vertex, NONE while it is not part of it
+  std::vector<Index> m_vertexTriangle;
+
+  // Sites inserted while every one of them is collinear
+  std::vector<Index> m_line;
+  Index m_last = NONE;
+  // Vertices in the triangulation once it has triangles
+  size_t m_count = 0;
+  std::vector<Index> m_changed;
+  std::vector<Index> m_freed;
+
+  // Bowyer-Watson scratch, per triangle epoch marks avoid clearing
+  std::vector<uint32_t> m_marks;
+  uint32_t m_epoch = 0;
+  std::vector<Index> m_cavity;
+  mutable uint32_t m_seed = 0x9E3779B9;
+};
+
+#endif // VORONOI_DELAUNAY_HPP
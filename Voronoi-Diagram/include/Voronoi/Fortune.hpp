@@ -0,0 +1,26 @@
+#ifndef VORONOI_FORTUNE_HPP
+#define VORONOI_FORTUNE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Voronoi/Geometry.hpp"
+
+// Fortune's sweep line
+//
+// "A sweepline algorithm for Voronoi diagrams" by Steven Fortune (1987) and
+// "Computational Geometry: Algorithms and Applications" Chapter 7
+//
+// The sweep moves towards +y. The beach line is kept in a treap ordered by
+// x, circle events in a binary heap, both O(log(N)) per event.
+//
+// O(N log(N))
+//
+// Same output as ComputeVoronoi: one counter-clockwise polygon per site,
+// clipped to the box, empty when the cell misses it. Sites must be unique
+// (see CleanSites). `m` counts the events processed.
+std::vector<Cell> ComputeFortune(const std::vector<Vec2> &sites,
+                                 const Vec2 &topleft, const Vec2 &bottomright,
+                                 uint32_t &m);
+
+#endif // VORONOI_FORTUNE_HPP
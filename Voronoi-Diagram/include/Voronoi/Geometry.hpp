@@ -0,0 +1,106 @@
+#ifndef VORONOI_GEOMETRY_HPP
+#define VORONOI_GEOMETRY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Math/Vector.hpp"
+
+using Vec2 = Engine::Math::Vector<2>;
+using Line = Engine::Math::Vector<3>;
+using Cell = std::vector<Vec2>;
+
+// A few ulps relative to the coordinates, what float rounding leaves behind
+const float EPSILON = 4 * std::numeric_limits<float>::epsilon();
+
+inline bool IsClose(Vec2 a, Vec2 b, float eps = EPSILON) {
+  return std::fabs(a[0] - b[0]) <= eps * std::max(1.f, std::fabs(a[0])) &&
+         std::fabs(a[1] - b[1]) <= eps * std::max(1.f, std::fabs(a[1]));
+}
+
+inline Line TwoPointsBisector(Vec2 a, Vec2 b) {
+  Vec2 n{b[0] - a[0], b[1] - a[1]};
+  float c = 0.5f * (n[0] * (b[0] + a[0]) + n[1] * (b[1] + a[1]));
+
+  // line: n.x*x + n.y*y = c  →  n.x*x + n.y*y - c = 0
+  return {n[0], n[1], -c}; // store Ax + By + C = 0
+}
+
+// Power bisector of two weighted sites, where |x - a|² - aw = |x - b|² - bw.
+// Moves towards the lighter site, TwoPointsBisector with equal weights
+inline Line RadicalAxis(Vec2 a, float aw, Vec2 b, float bw) {
+  Vec2 n{b[0] - a[0], b[1] - a[1]};
+  double c = 0.5 * ((double)n[0] * ((double)b[0] + a[0]) +
+                    (double)n[1] * ((double)b[1] + a[1]) + aw - bw);
+  return {n[0], n[1], (float)-c};
+}
+
+// Equal power to the three weighted sites. In double and relative to a, far
+// from the origin floats cancel badly
+inline Vec2 PowerCenter(const Vec2 &a, float aw, const Vec2 &b, float bw,
+                        const Vec2 &c, float cw) {
+  double bx = (double)b[0] - a[0], by = (double)b[1] - a[1];
+  double cx = (double)c[0] - a[0], cy = (double)c[1] - a[1];
+  double b2 = bx * bx + by * by - ((double)bw - aw);
+  double c2 = cx * cx + cy * cy - ((double)cw - aw);
+  double d = 2 * (bx * cy - by * cx);
+
+  return {(float)(a[0] + (cy * b2 - by * c2) / d),
+          (float)(a[1] + (bx * c2 - cx * b2) / d)};
+}
+
+inline Vec2 Circumcenter(const Vec2 &a, const Vec2 &b, const Vec2 &c) {
+  return PowerCenter(a, 0, b, 0, c, 0);
+}
+
+inline bool Intersects(const Line &line, const Vec2 &p, const Vec2 &q,
+                       float eps = 1e-8f) {
+  float lp = line[0] * p[0] + line[1] * p[1] + line[2];
+  float lq = line[0] * q[0] + line[1] * q[1] + line[2];
+  return (lp < -eps && lq > eps) || (lp > eps && lq < -eps);
+}
+
+inline Vec2 Intersect(const Line &line, const Vec2 &p, const Vec2 &q) {
+  // solve parametric intersection of segment pq with line
+  float dp = line[0] * p[0] + line[1] * p[1] + line[2];
+  float dq = line[0] * q[0] + line[1] * q[1] + line[2];
+  float t = dp / (dp - dq);
+  return {p[0] + t * (q[0] - p[0]), p[1] + t * (q[1] - p[1])};
+}
+
+inline bool IsOnPositiveSide(const Line &line, const Vec2 &p) {
+  return (line[0] * p[0] + line[1] * p[1] + line[2]) <= 0.f;
+}
+
+// Shoelace formula, positive for counter-clockwise cells. Relative to the
+// first vertex and in double, small cells far from the origin cancel badly
+inline float CellArea(const Cell &cell) {
+  if (cell.size() < 3)
+    return 0;
+
+  double area = 0;
+  for (size_t i = 1; i + 1 < cell.size(); i++) {
+    double px = cell[i][0] - cell[0][0], py = cell[i][1] - cell[0][1];
+    double qx = cell[i + 1][0] - cell[0][0], qy = cell[i + 1][1] - cell[0][1];
+    area += px * qy - qx * py;
+  }
+
+  return area * 0.5;
+}
+
+// The box as a counter-clockwise cell, the start of every clipped cell
+Cell BoxCell(const Vec2 &topleft, const Vec2 &bottomright);
+
+// Sutherland-Hodgman against one line, keeps the side IsOnPositiveSide
+// accepts. O(M) for M vertices
+void ClipCell(Cell &cell, const Line &line);
+
+void RemoveNearDuplicates(std::vector<Vec2> &poly, float eps = EPSILON);
+
+// Sorts and Removes Duplicates
+// O(N log(N) + N)
+void CleanSites(std::vector<Vec2> &sites);
+
+#endif // VORONOI_GEOMETRY_HPP
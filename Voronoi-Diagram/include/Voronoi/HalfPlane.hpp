@@ -0,0 +1,53 @@
+#ifndef VORONOI_HALFPLANE_HPP
+#define VORONOI_HALFPLANE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Voronoi/Geometry.hpp"
+
+// Brute-Force Intersection of Half-Planes
+//
+// "Computational Geometry: Algorithms and Applications" Chapter 7 by
+//  Prof. Dr. Mark de Berg, Dr. Otfried Cheong, Dr. Marc van Kreveld, Prof. Dr.
+//  Mark Overmars
+//
+// O(N * (N - 1) * (N - 1)) -> O(N³)
+//
+// Kept as the reference the faster methods are checked against. `m` counts
+// the polygon vertices visited while clipping.
+std::vector<Cell> ComputeVoronoi(std::vector<Vec2> &input_sites,
+                                 const Vec2 &topleft, const Vec2 &bottomright,
+                                 uint32_t &m);
+
+// Power diagram by the same clipping against radical axes: the cell of site
+// i holds the points where |x - site|² - weights[i] is the least, a circle
+// of radius r has weight r². Heavy sites can leave a lighter one with an
+// empty cell, or with a cell that misses its site. Without weights it is
+// ComputeVoronoi. O(N³)
+std::vector<Cell> ComputePowerDiagram(const std::vector<Vec2> &sites,
+                                      const std::vector<float> &weights,
+                                      const Vec2 &topleft,
+                                      const Vec2 &bottomright, uint32_t &m);
+
+// The same clipping with the sites bucketed in a uniform grid: a cell is
+// clipped against growing rings of buckets around its site until the rings
+// cover twice its farthest vertex, since no site further away can cut it.
+// Cells are independent and clipped in parallel.
+//
+// O(N * K) for K sites within the security radius, about constant for
+// evenly spread sites
+//
+// `emit` receives every finished cell with its site index as soon as it is
+// clipped, from the worker threads and in no particular order.
+void ClipVoronoiCells(const std::vector<Vec2> &sites, const Vec2 &topleft,
+                      const Vec2 &bottomright,
+                      const std::function<void(size_t, Cell &)> &emit,
+                      uint32_t &m);
+
+std::vector<Cell> ComputeVoronoiGrid(const std::vector<Vec2> &sites,
+                                     const Vec2 &topleft,
+                                     const Vec2 &bottomright, uint32_t &m);
+
+#endif // VORONOI_HALFPLANE_HPP
@@ -0,0 +1,42 @@
+#ifndef VORONOI_LLOYD_HPP
+#define VORONOI_LLOYD_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Geometry.hpp"
+
+// Lloyd relaxation towards a centroidal Voronoi tessellation: every site
+// moves to the centroid of its cell until the sites stop moving
+//
+// "Least squares quantization in PCM" by Stuart P. Lloyd (1982) and
+// "Centroidal Voronoi Tessellations: Applications and Algorithms" by Qiang
+// Du, Vance Faber and Max Gunzburger (1999)
+//
+// The triangulation is kept between iterations. Cells are read from it and
+// integrated in parallel without being stored, then each site is moved with
+// Triangulation::move. Once the steps are small most sites stay inside their
+// star and only need a few flips, instead of a rebuild per iteration.
+
+struct LloydIteration {
+  // Integral over every cell of the squared distance to its site, before the
+  // move. Decreases with every iteration
+  double energy = 0;
+  // Largest distance a site moved
+  double shift = 0;
+  double seconds = 0;
+};
+
+// One iteration, O(N) once the sites barely move
+LloydIteration LloydStep(Triangulation &triangulation, const Vec2 &topleft,
+                         const Vec2 &bottomright);
+
+// Iterates until no site moves more than `tolerance` or `maxIterations` are
+// done, one entry per iteration
+std::vector<LloydIteration> LloydRelax(Triangulation &triangulation,
+                                       const Vec2 &topleft,
+                                       const Vec2 &bottomright,
+                                       double tolerance, size_t maxIterations);
+
+#endif // VORONOI_LLOYD_HPP
@@ -0,0 +1,66 @@
+#ifndef VORONOI_LOCATOR_HPP
+#define VORONOI_LOCATOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Geometry.hpp"
+
+// Point location on a Delaunay triangulation: the triangle holding a point,
+// and its nearest site, the one whose Voronoi cell holds it
+//
+// "Fast randomized point location without preprocessing in two- and
+//  three-dimensional Delaunay triangulations" by Ernst P. Mücke, Isaac
+//  Saias and Binhai Zhu (1999)
+//
+// Jump and walk: a uniform grid over the sites keeps one seed triangle per
+// bucket, about four sites each. A query jumps to the seed of its bucket
+// and walks to the point, then follows Delaunay edges while a neighbour is
+// nearer, which always ends on the nearest site. Expected O(1) steps for
+// evenly spread sites. Queries only read, any number of threads can run
+// them at once.
+//
+// On a weighted triangulation the nearest site is the one of least power,
+// whose power cell holds the point.
+//
+// A snapshot: edits to the triangulation need a new Locator.
+class Locator {
+public:
+  using Index = Triangulation::Index;
+
+  static constexpr Index NONE = Triangulation::NONE;
+
+  // O(N)
+  explicit Locator(const Triangulation &triangulation);
+
+  // Triangle holding p, a ghost outside the hull. NONE while the sites are
+  // on a line
+  Index triangle(const Vec2 &p) const;
+  // Nearest site, NONE without sites. From `hint` instead of the grid when
+  // given, for queries that come close to each other
+  Index nearest(const Vec2 &p, Index hint = NONE) const;
+  // nearest of every point, in parallel
+  std::vector<Index> nearest(const std::vector<Vec2> &points) const;
+
+private:
+  Index walk(Index t, const Vec2 &p) const;
+  Index descend(Index v, const Vec2 &p) const;
+
+  const Triangulation &m_triangulation;
+
+  // Seed triangles, row by row
+  std::vector<Index> m_seeds;
+  uint32_t m_columns = 0;
+  uint32_t m_rows = 0;
+  Vec2 m_origin;
+  float m_bucketWidth = 1;
+  float m_bucketHeight = 1;
+
+  // Without triangles, the sites along the line and their offsets on it
+  std::vector<Index> m_line;
+  std::vector<double> m_along;
+  Vec2 m_lineDirection;
+};
+
+#endif // VORONOI_LOCATOR_HPP
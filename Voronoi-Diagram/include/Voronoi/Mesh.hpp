@@ -0,0 +1,106 @@
+#ifndef VORONOI_MESH_HPP
+#define VORONOI_MESH_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Geometry.hpp"
+
+// Half-edge mesh (doubly connected edge list) in flat arrays with 32-bit
+// indices, the one output of both the Delaunay triangulation and the
+// Voronoi diagram
+//
+// "Computational Geometry: Algorithms and Applications" Chapter 2.2
+//
+// Every edge is a pair of half-edges, one per side, pointing at each other
+// with twin. The half-edges of a face are stored together and go around it
+// counter-clockwise with next. Outside the mesh is face NONE, its half-edges
+// go around the boundary clockwise. Every query is one read.
+//
+// Half-edges no edge uses are holes: their own twin and next, with no origin
+// and no face. Walks never reach them.
+struct HalfEdgeMesh {
+  using Index = uint32_t;
+
+  static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+  struct HalfEdge {
+    Index origin;
+    Index twin;
+    Index next;
+    // NONE outside the mesh
+    Index face;
+  };
+
+  std::vector<Vec2> vertices;
+  std::vector<HalfEdge> edges;
+  // First half-edge of every face, NONE for empty faces
+  std::vector<Index> faces;
+
+  Index origin(Index e) const { return edges[e].origin; }
+  Index target(Index e) const { return edges[edges[e].next].origin; }
+  Index twin(Index e) const { return edges[e].twin; }
+  Index next(Index e) const { return edges[e].next; }
+  Index face(Index e) const { return edges[e].face; }
+  // The face across e, NONE on the boundary
+  Index neighbour(Index e) const { return edges[edges[e].twin].face; }
+  bool hole(Index e) const { return edges[e].twin == e; }
+};
+
+// Vertices are the sites, face t is triangle t and its half-edges are 3t to
+// 3t + 2, so an edit rewrites them in place. The hull edge of a ghost is the
+// half-edge outside, its other two and those of freed triangles are holes,
+// as are faces. Still on a line, a path of edges with no faces. O(N)
+HalfEdgeMesh DelaunayMesh(const Triangulation &triangulation);
+
+// Face v is the cell of site v clipped to the box, its power cell once
+// weighted, empty for duplicated, removed and hidden sites. Cells are
+// clipped in parallel and welded through their twins, cocircular sites keep
+// their zero length edges. O(N)
+HalfEdgeMesh VoronoiMesh(const Triangulation &triangulation,
+                         const Vec2 &topleft, const Vec2 &bottomright);
+
+// Entries of the arrays a patch wrote, in no order and possibly repeated, so
+// only those have to be uploaded again
+struct MeshChanges {
+  std::vector<HalfEdgeMesh::Index> vertices;
+  std::vector<HalfEdgeMesh::Index> edges;
+  std::vector<HalfEdgeMesh::Index> faces;
+};
+
+// Brings a DelaunayMesh up to date with the last insert, remove or move:
+// the triangles freed by it and those around the changed sites are written
+// again, with their neighbours for the twins. The triangulation must have
+// had triangles before the edit and still have some. O(degree)
+void PatchDelaunayMesh(HalfEdgeMesh &mesh, const Triangulation &triangulation,
+                       MeshChanges &changes);
+
+// Brings a VoronoiMesh up to date with the last edit: the cells of the
+// changed sites are clipped again and appended, their old half-edges left as
+// holes. Edges and vertices shared with the cells that did not change are
+// taken from them, and the boundary is spliced around the new cells. The
+// arrays only grow, a rebuild compacts them. Same conditions as
+// PatchDelaunayMesh. O(degree) per changed site
+void PatchVoronoiMesh(HalfEdgeMesh &mesh, const Triangulation &triangulation,
+                      const Vec2 &topleft, const Vec2 &bottomright,
+                      MeshChanges &changes);
+
+// The same triangles as DelaunayMesh, but read off the lower hull of the
+// sites lifted onto z = x² + y² (LiftedHull in the engine), a second
+// O(N log(N)) path to check the triangulation against. Cocircular sites may
+// be split the other way, duplicates are left out. No faces while every site
+// is on one line or one circle
+HalfEdgeMesh LiftedDelaunayMesh(const std::vector<Vec2> &sites);
+
+// Cell of every vertex of a Delaunay mesh, as Triangulation::voronoi: the
+// circumcenters of the faces around it, or the box clipped by the bisectors
+// of its neighbours when it is on the boundary. Without faces the sites are
+// on one line or one circle, and each is clipped by the bisectors of the
+// sites next to it there, a single site keeping the whole box. O(N), or
+// O(N log(N)) without faces
+std::vector<Cell> MeshVoronoi(const HalfEdgeMesh &delaunay,
+                              const Vec2 &topleft, const Vec2 &bottomright);
+
+#endif // VORONOI_MESH_HPP
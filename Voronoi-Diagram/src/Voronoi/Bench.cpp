@@ -0,0 +1,348 @@
+#include "Voronoi/Bench.hpp"
+
+#include "Math/Predicates.hpp"
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Fortune.hpp"
+#include "Voronoi/Geometry.hpp"
+#include "Voronoi/HalfPlane.hpp"
+#include "Voronoi/JumpFlood.hpp"
+#include "Voronoi/Lloyd.hpp"
+#include "Voronoi/Locator.hpp"
+#include "Voronoi/Mesh.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+
+namespace {
+
+const size_t ORACLE_LIMIT = 10000;
+const float BOX_SIZE = 1000;
+// Relative area difference above which a cell counts as wrong
+const float AREA_TOLERANCE = 1e-3f;
+// Side of the jump flooded image
+const uint32_t RASTER_SIZE = 1024;
+// Nearest site queries per size, the first ones checked by brute force
+const size_t QUERY_COUNT = 1 << 20;
+const size_t CHECKED_QUERIES = 100;
+// Fine lattices far from the origin, where rounding loses cells
+const size_t LATTICE_SIDE = 5;
+const float LATTICE_SPACING = 0.001f;
+const float LATTICE_BASES[] = {1, 100, 900};
+// Relative difference of the area all cells cover together
+const double COVERAGE_TOLERANCE = 1e-6;
+
+using Clock = std::chrono::high_resolution_clock;
+using Method = std::function<std::vector<Cell>(std::vector<Vec2> &,
+                                               const Vec2 &, const Vec2 &,
+                                               uint32_t &)>;
+
+struct Run {
+  std::vector<Cell> cells;
+  double seconds;
+  uint32_t m;
+  // Share of the predicates that needed exact arithmetic
+  double exactRate;
+};
+
+Run Measure(const Method &method, std::vector<Vec2> &sites) {
+  Run run;
+  Engine::Math::PredicateStats before = Engine::Math::predicateStats();
+  auto start = Clock::now();
+  run.cells = method(sites, {0, 0}, {BOX_SIZE, BOX_SIZE}, run.m);
+  run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  Engine::Math::PredicateStats after = Engine::Math::predicateStats();
+  run.exactRate = Engine::Math::PredicateStats{after.calls - before.calls,
+                                               after.exact - before.exact}
+                      .fallbackRate();
+  return run;
+}
+
+double Coverage(const std::vector<Cell> &cells) {
+  double area = 0;
+  for (const Cell &cell : cells) {
+    area += std::fabs(CellArea(cell));
+  }
+  return area;
+}
+
+} // namespace
+
+int RunBenchmark(const std::string &path, const std::vector<size_t> &sizes) {
+  std::ofstream csv(path);
+  if (!csv) {
+    std::cerr << "Could not open " << path << '\n';
+    return 1;
+  }
+
+  std::vector<std::pair<std::string, Method>> methods = {
+      {"fortune",
+       [](std::vector<Vec2> &sites, const Vec2 &tl, const Vec2 &br,
+          uint32_t &m) { return ComputeFortune(sites, tl, br, m); }},
+      {"grid",
+       [](std::vector<Vec2> &sites, const Vec2 &tl, const Vec2 &br,
+          uint32_t &m) { return ComputeVoronoiGrid(sites, tl, br, m); }},
+      {"delaunay",
+       [](std::vector<Vec2> &sites, const Vec2 &tl, const Vec2 &br,
+          uint32_t &m) {
+         Triangulation triangulation(sites);
+         m = triangulation.triangleCount();
+         return triangulation.voronoi(tl, br);
+       }},
+      {"lifting",
+       [](std::vector<Vec2> &sites, const Vec2 &tl, const Vec2 &br,
+          uint32_t &m) {
+         HalfEdgeMesh delaunay = LiftedDelaunayMesh(sites);
+         m = delaunay.faces.size();
+         return MeshVoronoi(delaunay, tl, br);
+       }},
+  };
+
+  csv << "method,sites,seconds,m,mismatches,maxAreaError,exactRate\n";
+  int failures = 0;
+
+  // Cells there are thinner than float vertices can show, only the area they
+  // cover together is compared
+  for (float base : LATTICE_BASES) {
+    std::vector<Vec2> sites;
+    for (size_t i = 0; i < LATTICE_SIDE; i++) {
+      for (size_t j = 0; j < LATTICE_SIDE; j++) {
+        sites.push_back(
+            {base + i * LATTICE_SPACING, base + j * LATTICE_SPACING});
+      }
+    }
+    CleanSites(sites);
+
+    double expected = Coverage(Measure(ComputeVoronoi, sites).cells);
+    for (auto &[name, method] : methods) {
+      Run run = Measure(method, sites);
+      double error = std::fabs(Coverage(run.cells) - expected) / expected;
+      bool wrong = error > COVERAGE_TOLERANCE;
+
+      csv << name << "Lattice" << base << ',' << sites.size() << ','
+          << run.seconds << ',' << run.m << ',' << wrong << ',' << error << ','
+          << run.exactRate << '\n';
+      std::cout << name << " lattice at " << base << ": " << error
+                << " of the area " << (wrong ? "lost" : "kept") << '\n';
+      failures += wrong;
+    }
+  }
+
+  for (size_t n : sizes) {
+    std::mt19937 gen(n);
+    std::uniform_real_distribution<float> distrib(0, BOX_SIZE);
+
+    std::vector<Vec2> sites(n);
+    for (auto &site : sites) {
+      site = {distrib(gen), distrib(gen)};
+    }
+    CleanSites(sites);
+
+    std::optional<Run> oracle;
+    if (sites.size() <= ORACLE_LIMIT) {
+      oracle = Measure(ComputeVoronoi, sites);
+      csv << "halfplane," << sites.size() << ',' << oracle->seconds << ','
+          << oracle->m << ",0,0," << oracle->exactRate << '\n';
+    }
+
+    // Past the oracle the lifted diagram is checked against the planar one
+    std::optional<Run> planar;
+    for (auto &[name, method] : methods) {
+      Run run = Measure(method, sites);
+
+      const Run *reference = oracle ? &*oracle : nullptr;
+      if (!reference && name == "lifting" && planar)
+        reference = &*planar;
+      size_t mismatches = 0;
+      float maxError = 0;
+      if (reference) {
+        for (size_t i = 0; i < sites.size(); i++) {
+          float expected = std::fabs(CellArea(reference->cells[i]));
+          float actual = std::fabs(CellArea(run.cells[i]));
+          float error = std::fabs(actual - expected) / std::max(expected, 1.f);
+
+          maxError = std::max(maxError, error);
+          if (error > AREA_TOLERANCE)
+            mismatches++;
+        }
+      }
+
+      csv << name << ',' << sites.size() << ',' << run.seconds << ',' << run.m
+          << ',' << mismatches << ',' << maxError << ',' << run.exactRate
+          << '\n';
+      std::cout << name << " " << sites.size() << " sites: " << run.seconds
+                << "s";
+      if (reference)
+        std::cout << ", " << mismatches << " cells differ";
+      std::cout << '\n';
+
+      failures += mismatches > 0;
+      if (name == "delaunay")
+        planar = std::move(run);
+    }
+
+    // Radii up to the spacing of the sites, so that some cells vanish
+    std::uniform_real_distribution<float> radius(
+        0, BOX_SIZE / std::sqrt((float)sites.size()));
+    std::vector<float> weights(sites.size());
+    for (float &weight : weights) {
+      float r = radius(gen);
+      weight = r * r;
+    }
+
+    std::optional<Run> powerOracle;
+    if (sites.size() <= ORACLE_LIMIT) {
+      powerOracle = Measure(
+          [&](std::vector<Vec2> &points, const Vec2 &tl, const Vec2 &br,
+              uint32_t &m) {
+            return ComputePowerDiagram(points, weights, tl, br, m);
+          },
+          sites);
+      csv << "powerhalfplane," << sites.size() << ',' << powerOracle->seconds
+          << ',' << powerOracle->m << ",0,0," << powerOracle->exactRate
+          << '\n';
+    }
+
+    Run power = Measure(
+        [&](std::vector<Vec2> &points, const Vec2 &tl, const Vec2 &br,
+            uint32_t &m) {
+          Triangulation triangulation(points, weights);
+          m = triangulation.triangleCount();
+          return triangulation.voronoi(tl, br);
+        },
+        sites);
+
+    size_t empty = 0, powerMismatches = 0;
+    float powerError = 0;
+    for (size_t i = 0; i < sites.size(); i++) {
+      float actual = std::fabs(CellArea(power.cells[i]));
+      empty += actual == 0;
+      if (!powerOracle)
+        continue;
+
+      float expected = std::fabs(CellArea(powerOracle->cells[i]));
+      float error = std::fabs(actual - expected) / std::max(expected, 1.f);
+      powerError = std::max(powerError, error);
+      if (error > AREA_TOLERANCE)
+        powerMismatches++;
+    }
+
+    csv << "power," << sites.size() << ',' << power.seconds << ',' << power.m
+        << ',' << powerMismatches << ',' << powerError << ','
+        << power.exactRate << '\n';
+    std::cout << "power " << sites.size() << " sites: " << power.seconds
+              << "s, " << empty << " empty cells";
+    if (powerOracle)
+      std::cout << ", " << powerMismatches << " cells differ";
+    std::cout << '\n';
+    failures += powerMismatches > 0;
+
+    // Approximate by design, wrong pixels are reported but never fail
+    auto start = Clock::now();
+    LabelImage image = JumpFlood(sites, {0, 0}, {BOX_SIZE, BOX_SIZE},
+                                 RASTER_SIZE, RASTER_SIZE);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t wrong =
+        JumpFloodErrors(image, sites, {0, 0}, {BOX_SIZE, BOX_SIZE});
+
+    csv << "jumpflood," << sites.size() << ',' << seconds << ','
+        << image.labels.size() << ',' << wrong << ",0,0\n";
+    std::cout << "jumpflood " << sites.size() << " sites: " << seconds
+              << "s, " << wrong << " of " << image.labels.size()
+              << " pixels not nearest\n";
+
+    std::vector<Vec2> queries(QUERY_COUNT);
+    for (auto &query : queries) {
+      query = {distrib(gen), distrib(gen)};
+    }
+    start = Clock::now();
+    Triangulation triangulation(sites);
+    Locator locator(triangulation);
+    double buildSeconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    start = Clock::now();
+    std::vector<Locator::Index> nearest = locator.nearest(queries);
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    auto distance = [&](size_t site, const Vec2 &p) {
+      return std::hypot((double)sites[site][0] - p[0],
+                        (double)sites[site][1] - p[1]);
+    };
+    size_t misses = 0;
+    for (size_t i = 0; i < CHECKED_QUERIES; i++) {
+      double best = std::numeric_limits<double>::max();
+      for (size_t site = 0; site < sites.size(); site++) {
+        best = std::min(best, distance(site, queries[i]));
+      }
+      misses += distance(nearest[i], queries[i]) > best;
+    }
+
+    csv << "locate," << sites.size() << ',' << seconds << ','
+        << queries.size() << ',' << misses << ",0,0\n";
+    std::cout << "locate " << sites.size() << " sites: " << queries.size()
+              << " queries in " << seconds << "s after " << buildSeconds
+              << "s of triangulation, " << misses << " of " << CHECKED_QUERIES
+              << " not nearest\n";
+    failures += misses > 0;
+  }
+
+  return failures > 0;
+}
+
+int RunLloydBenchmark(const std::string &path, size_t sites,
+                      size_t iterations) {
+  std::ofstream csv(path);
+  if (!csv) {
+    std::cerr << "Could not open " << path << '\n';
+    return 1;
+  }
+
+  std::mt19937 gen(sites);
+  std::uniform_real_distribution<float> distrib(0, BOX_SIZE);
+  std::vector<Vec2> input(sites);
+  for (auto &site : input) {
+    site = {distrib(gen), distrib(gen)};
+  }
+  CleanSites(input);
+
+  Triangulation triangulation(input);
+  csv << "iteration,sites,energy,shift,seconds,rebuildSeconds\n";
+  int failures = 0;
+  double energy = std::numeric_limits<double>::infinity();
+
+  for (size_t i = 0; i < iterations; i++) {
+    LloydIteration iteration =
+        LloydStep(triangulation, {0, 0}, {BOX_SIZE, BOX_SIZE});
+
+    // What the same iteration costs without the warm start
+    std::vector<Vec2> moved;
+    moved.reserve(triangulation.size());
+    for (Triangulation::Index v = 0; v < triangulation.size(); v++) {
+      if (triangulation.contains(v))
+        moved.push_back(triangulation.site(v));
+    }
+    auto start = Clock::now();
+    Triangulation rebuilt(moved);
+    rebuilt.voronoi({0, 0}, {BOX_SIZE, BOX_SIZE});
+    double rebuild = std::chrono::duration<double>(Clock::now() - start).count();
+
+    csv << i << ',' << moved.size() << ',' << iteration.energy << ','
+        << iteration.shift << ',' << iteration.seconds << ',' << rebuild
+        << '\n';
+    std::cout << "lloyd " << i << ": energy " << iteration.energy << ", shift "
+              << iteration.shift << ", " << iteration.seconds << "s ("
+              << rebuild << "s rebuilt)\n";
+
+    // Lloyd never increases the energy, up to rounding
+    failures += iteration.energy > energy * (1 + 1e-9);
+    energy = iteration.energy;
+  }
+
+  return failures > 0;
+}
@@ -0,0 +1,235 @@
+#include "Voronoi/Coloring.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+
+using Index = Triangulation::Index;
+
+// Levels per channel of the RGB grid the palette is picked from
+const int GRID_LEVELS = 16;
+
+float LabDistance(const Line &a, const Line &b) {
+  float dl = a[0] - b[0], da = a[1] - b[1], db = a[2] - b[2];
+  return sqrtf(dl * dl + da * da + db * db);
+}
+
+// Neighbours of every site in one array
+struct Adjacency {
+  std::vector<uint32_t> offsets;
+  std::vector<Index> neighbours;
+
+  explicit Adjacency(const Triangulation &triangulation)
+      : offsets(triangulation.size() + 1, 0) {
+    const auto &triangles = triangulation.triangles();
+    auto edges = [&](auto &&visit) {
+      for (Index t = 0; t < triangles.size(); t++) {
+        if (!triangulation.alive(t))
+          continue;
+        for (int i = 0; i < 3; i++) {
+          Index a = triangles[t].vertices[(i + 1) % 3];
+          Index b = triangles[t].vertices[(i + 2) % 3];
+          if (a != Triangulation::INFINITE && b != Triangulation::INFINITE)
+            visit(a, b);
+        }
+      }
+    };
+
+    // Every edge is in two triangles, once each way. In memory order instead
+    // of walking each star, which jumps around the triangles
+    size_t total = 0;
+    edges([&](Index a, Index) {
+      offsets[a + 1]++;
+      total++;
+    });
+    if (total == 0) {
+      // Still on a line, no triangles
+      for (Index v = 0; v < triangulation.size(); v++) {
+        std::vector<Index> around = triangulation.neighbours(v);
+        neighbours.insert(neighbours.end(), around.begin(), around.end());
+        offsets[v + 1] = neighbours.size();
+      }
+      return;
+    }
+
+    for (size_t v = 0; v < triangulation.size(); v++) {
+      offsets[v + 1] += offsets[v];
+    }
+    neighbours.resize(offsets.back());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    edges([&](Index a, Index b) { neighbours[next[a]++] = b; });
+  }
+};
+
+// The least used color among those no neighbour of v has, by `rank` on
+// ties. NO_COLOR when every color is taken
+uint8_t FreeColor(const Index *begin, const Index *end,
+                  const std::vector<uint8_t> &colors,
+                  const std::vector<size_t> &used,
+                  const std::vector<uint32_t> &rank) {
+  bool taken[NO_COLOR] = {};
+  for (const Index *u = begin; u != end; u++) {
+    if (colors[*u] != NO_COLOR)
+      taken[colors[*u]] = true;
+  }
+
+  uint8_t best = NO_COLOR;
+  for (uint8_t c = 0; c < used.size(); c++) {
+    if (!taken[c] &&
+        (best == NO_COLOR || used[c] < used[best] ||
+         (used[c] == used[best] && rank[c] < rank[best])))
+      best = c;
+  }
+  return best;
+}
+
+} // namespace
+
+std::vector<Line> LabPalette(size_t count, uint32_t seed,
+                             const std::vector<Line> &avoid) {
+  std::vector<Line> rgb, lab;
+  for (int r = 0; r < GRID_LEVELS; r++) {
+    for (int g = 0; g < GRID_LEVELS; g++) {
+      for (int b = 0; b < GRID_LEVELS; b++) {
+        Line color = {(float)r / (GRID_LEVELS - 1),
+                      (float)g / (GRID_LEVELS - 1),
+                      (float)b / (GRID_LEVELS - 1)};
+        rgb.push_back(color);
+        lab.push_back(XyzToLab(RgbToXyz(color)));
+      }
+    }
+  }
+
+  // Distance of every candidate to the nearest color picked or avoided
+  std::vector<float> nearest(rgb.size(), std::numeric_limits<float>::max());
+  for (const Line &color : avoid) {
+    Line avoided = XyzToLab(RgbToXyz(color));
+    for (size_t i = 0; i < lab.size(); i++) {
+      nearest[i] = std::min(nearest[i], LabDistance(lab[i], avoided));
+    }
+  }
+
+  std::vector<Line> palette;
+  std::mt19937 gen(seed);
+  size_t pick = avoid.empty() ? gen() % rgb.size()
+                              : std::max_element(nearest.begin(), nearest.end()) -
+                                    nearest.begin();
+  while (palette.size() < count) {
+    palette.push_back(rgb[pick]);
+    for (size_t i = 0; i < lab.size(); i++) {
+      nearest[i] = std::min(nearest[i], LabDistance(lab[i], lab[pick]));
+    }
+    pick = std::max_element(nearest.begin(), nearest.end()) - nearest.begin();
+  }
+
+  return palette;
+}
+
+std::vector<uint8_t> ColorSites(const Triangulation &triangulation,
+                                size_t paletteSize, uint32_t seed) {
+  size_t n = triangulation.size();
+  Adjacency adjacency(triangulation);
+
+  // Smallest-last order with a bucket queue of remaining degrees. Buckets
+  // keep stale entries, skipped when popped, so every edge pushes at most
+  // once. O(N + E)
+  std::vector<uint32_t> degree(n);
+  std::vector<std::vector<Index>> buckets;
+  size_t count = 0;
+  for (Index v = 0; v < n; v++) {
+    if (!triangulation.contains(v))
+      continue;
+    degree[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    if (degree[v] >= buckets.size())
+      buckets.resize(degree[v] + 1);
+    buckets[degree[v]].push_back(v);
+    count++;
+  }
+
+  std::vector<bool> removed(n, false);
+  std::vector<Index> order;
+  order.reserve(count);
+  size_t low = 0;
+  while (order.size() < count) {
+    while (buckets[low].empty())
+      low++;
+
+    Index v = buckets[low].back();
+    buckets[low].pop_back();
+    if (removed[v] || degree[v] != low)
+      continue;
+
+    removed[v] = true;
+    order.push_back(v);
+    for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1];
+         i++) {
+      Index u = adjacency.neighbours[i];
+      if (!removed[u]) {
+        degree[u]--;
+        buckets[degree[u]].push_back(u);
+        low = std::min<size_t>(low, degree[u]);
+      }
+    }
+  }
+
+  std::vector<uint32_t> rank(paletteSize);
+  std::iota(rank.begin(), rank.end(), 0);
+  std::shuffle(rank.begin(), rank.end(), std::mt19937(seed));
+
+  // Reversed, each site sees at most five colored neighbours
+  std::vector<uint8_t> colors(n, NO_COLOR);
+  std::vector<size_t> used(paletteSize, 0);
+  for (auto it = order.rbegin(); it != order.rend(); it++) {
+    Index v = *it;
+    const Index *begin = adjacency.neighbours.data() + adjacency.offsets[v];
+    const Index *end = adjacency.neighbours.data() + adjacency.offsets[v + 1];
+    uint8_t color = FreeColor(begin, end, colors, used, rank);
+    if (color == NO_COLOR)
+      color = std::min_element(used.begin(), used.end()) - used.begin();
+
+    colors[v] = color;
+    used[color]++;
+  }
+
+  return colors;
+}
+
+void RepairColors(const Triangulation &triangulation,
+                  std::vector<uint8_t> &colors,
+                  const std::vector<Triangulation::Index> &sites,
+                  size_t paletteSize) {
+  colors.resize(triangulation.size(), NO_COLOR);
+  std::vector<size_t> used(paletteSize, 0);
+  std::vector<uint32_t> rank(paletteSize);
+  std::iota(rank.begin(), rank.end(), 0);
+
+  for (Index v : sites) {
+    if (!triangulation.contains(v)) {
+      colors[v] = NO_COLOR;
+      continue;
+    }
+
+    std::vector<Index> around = triangulation.neighbours(v);
+    bool clash = colors[v] == NO_COLOR;
+    for (Index u : around) {
+      clash |= colors[u] == colors[v];
+    }
+    if (!clash)
+      continue;
+
+    // Counts around v decide, so the rarest neighbour color is the fallback
+    std::fill(used.begin(), used.end(), 0);
+    for (Index u : around) {
+      if (colors[u] != NO_COLOR)
+        used[colors[u]]++;
+    }
+    uint8_t color = FreeColor(around.data(), around.data() + around.size(),
+                              colors, used, rank);
+    if (color == NO_COLOR)
+      color = std::min_element(used.begin(), used.end()) - used.begin();
+    colors[v] = color;
+  }
+}
@@ -0,0 +1,921 @@
+#include "Voronoi/Delaunay.hpp"
+
+#include "Math/Predicates.hpp"
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+using Index = Triangulation::Index;
+using Engine::Math::incircle;
+using Engine::Math::orient2d;
+using Engine::Math::powertest;
+
+// Distance along a Hilbert curve over a 2^16 grid, consecutive sites stay
+// close so the walk in locate is short
+uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+  const uint32_t n = 1u << 16;
+  uint32_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+void RequireUnweighted(const Triangulation &triangulation) {
+  if (triangulation.weighted())
+    throw std::runtime_error("Weighted triangulations cannot be edited");
+}
+
+} // namespace
+
+Triangulation::Triangulation(const std::vector<Vec2> &sites)
+    : Triangulation(sites, {}) {}
+
+Triangulation::Triangulation(const std::vector<Vec2> &sites,
+                             const std::vector<float> &weights)
+    : m_sites(sites), m_weights(weights),
+      m_vertexTriangle(sites.size(), NONE) {
+  if (!weights.empty() && weights.size() != sites.size())
+    throw std::runtime_error("One weight per site is needed");
+  if (sites.empty())
+    return;
+
+  float minX = sites[0][0], maxX = minX, minY = sites[0][1], maxY = minY;
+  for (const Vec2 &site : sites) {
+    minX = std::min(minX, site[0]);
+    maxX = std::max(maxX, site[0]);
+    minY = std::min(minY, site[1]);
+    maxY = std::max(maxY, site[1]);
+  }
+  double scale = 65535.0 / std::max({maxX - minX, maxY - minY, EPSILON});
+
+  // O(N log(N))
+  std::vector<std::pair<uint32_t, Index>> order(sites.size());
+  for (Index v = 0; v < sites.size(); v++) {
+    order[v] = {HilbertIndex((uint32_t)((sites[v][0] - minX) * scale),
+                             (uint32_t)((sites[v][1] - minY) * scale)),
+                v};
+  }
+  std::sort(order.begin(), order.end());
+
+  // A triangulation of N sites has about 2N triangles
+  m_triangles.reserve(2 * sites.size() + 8);
+  for (auto [key, v] : order) {
+    add(v);
+  }
+
+  // Never edited, so the hidden sites can leave the line for good
+  if (weighted() && m_last == NONE)
+    m_line = line();
+  m_freed.clear();
+}
+
+Triangulation::Index Triangulation::insert(const Vec2 &site) {
+  RequireUnweighted(*this);
+
+  // O(N), only while every site so far is collinear
+  if (m_last == NONE) {
+    for (Index u : m_line) {
+      if (m_sites[u] == site)
+        return u;
+    }
+  }
+
+  Index v = m_sites.size();
+  m_sites.push_back(site);
+  m_vertexTriangle.push_back(NONE);
+
+  bool flat = m_last == NONE;
+  m_freed.clear();
+  Index u = add(v);
+  m_changed.clear();
+  if (u != v) {
+    m_sites.pop_back();
+    m_vertexTriangle.pop_back();
+    return u;
+  }
+
+  if (flat) {
+    // On the line or leaving it, every cell changes
+    for (Index w = 0; w < m_sites.size(); w++) {
+      if (m_last == NONE || m_vertexTriangle[w] != NONE)
+        m_changed.push_back(w);
+    }
+  } else {
+    m_changed = neighbours(v);
+    m_changed.push_back(v);
+  }
+  return u;
+}
+
+bool Triangulation::remove(Index v) {
+  RequireUnweighted(*this);
+  m_changed.clear();
+  m_freed.clear();
+  if (v >= m_sites.size())
+    return false;
+
+  if (m_last == NONE) {
+    auto it = std::find(m_line.begin(), m_line.end(), v);
+    if (it == m_line.end())
+      return false;
+    m_line.erase(it);
+    m_changed = m_line;
+    m_changed.push_back(v);
+    return true;
+  }
+
+  Index first = m_vertexTriangle[v];
+  if (first == NONE)
+    return false;
+
+  // The ring of neighbours bounds the hole counter-clockwise, each ring edge
+  // remembers the triangle and slot facing into the hole
+  struct Side {
+    Index triangle;
+    int slot;
+  };
+  std::vector<Index> ring, star;
+  std::vector<Side> sides;
+
+  Index t = first;
+  do {
+    const Triangle &triangle = m_triangles[t];
+    int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+    Index out = triangle.neighbours[i];
+    const Triangle &outside = m_triangles[out];
+    int slot = outside.neighbours[0] == t ? 0 : outside.neighbours[1] == t ? 1 : 2;
+
+    ring.push_back(triangle.vertices[(i + 1) % 3]);
+    sides.push_back({out, slot});
+    star.push_back(t);
+    t = triangle.neighbours[(i + 1) % 3];
+  } while (t != first);
+
+  m_vertexTriangle[v] = NONE;
+  m_count--;
+  for (Index u : ring) {
+    if (u != INFINITE)
+      m_changed.push_back(u);
+  }
+
+  // Only collinear sites left, back to a line
+  bool flat = m_count == m_changed.size();
+  for (size_t i = 2; flat && i < m_changed.size(); i++) {
+    flat = orient2d(m_sites[m_changed[0]], m_sites[m_changed[1]],
+                  m_sites[m_changed[i]]) == 0;
+  }
+  if (flat) {
+    rebuild(m_changed);
+    m_changed.push_back(v);
+    return true;
+  }
+
+  for (Index s : star) {
+    freeTriangle(s);
+  }
+
+  auto link = [&](Index t, int slot, const Side &side) {
+    m_triangles[t].neighbours[slot] = side.triangle;
+    m_triangles[side.triangle].neighbours[side.slot] = t;
+  };
+
+  // An ear x, y, z is cut when it turns left and no other ring vertex is in
+  // its circle, which makes it a Delaunay triangle of the ring
+  auto ear = [&](size_t j) {
+    size_t k = ring.size();
+    Index x = ring[(j + k - 1) % k], y = ring[j], z = ring[(j + 1) % k];
+    if (x != INFINITE && y != INFINITE && z != INFINITE &&
+        orient2d(m_sites[x], m_sites[y], m_sites[z]) <= 0)
+      return false;
+
+    for (Index u : ring) {
+      if (u != x && u != y && u != z && u != INFINITE &&
+          encloses(x, y, z, u))
+        return false;
+    }
+    return true;
+  };
+
+  std::vector<Index> created;
+  while (ring.size() > 3) {
+    size_t k = ring.size();
+    size_t j = 0;
+    while (j < k && !ear(j))
+      j++;
+
+    if (j == k) {
+      // Rounding left no valid ear, start over without v
+      std::vector<Index> vertices;
+      for (Index u = 0; u < m_sites.size(); u++) {
+        if (m_vertexTriangle[u] != NONE)
+          vertices.push_back(u);
+      }
+      rebuild(vertices);
+      m_changed = std::move(vertices);
+      m_changed.push_back(v);
+      return true;
+    }
+
+    size_t previous = (j + k - 1) % k;
+    Index cut = newTriangle(ring[previous], ring[j], ring[(j + 1) % k]);
+    link(cut, 2, sides[previous]);
+    link(cut, 0, sides[j]);
+    created.push_back(cut);
+
+    sides[previous] = {cut, 1};
+    ring.erase(ring.begin() + j);
+    sides.erase(sides.begin() + j);
+  }
+
+  Index last = newTriangle(ring[0], ring[1], ring[2]);
+  link(last, 2, sides[0]);
+  link(last, 0, sides[1]);
+  link(last, 1, sides[2]);
+  created.push_back(last);
+
+  for (Index c : created) {
+    for (Index u : m_triangles[c].vertices) {
+      if (u != INFINITE)
+        m_vertexTriangle[u] = c;
+    }
+    if (!ghost(c))
+      m_last = c;
+  }
+  // A hull site with two neighbours leaves only a ghost behind
+  if (!alive(m_last) || ghost(m_last)) {
+    for (const Side &side : sides) {
+      if (!ghost(side.triangle))
+        m_last = side.triangle;
+    }
+  }
+
+  m_changed.push_back(v);
+  return true;
+}
+
+bool Triangulation::move(Index v, const Vec2 &to) {
+  RequireUnweighted(*this);
+  m_changed.clear();
+  m_freed.clear();
+  if (v >= m_sites.size() || !contains(v))
+    return false;
+
+  // v may go anywhere its link still sees counter-clockwise, the hull and
+  // every other triangle stay as they are
+  std::vector<Index> &star = m_cavity;
+  star.clear();
+  bool inside = m_last != NONE;
+  if (inside) {
+    Index first = m_vertexTriangle[v];
+    Index t = first;
+    do {
+      const Triangle &triangle = m_triangles[t];
+      int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+      Index a = triangle.vertices[(i + 1) % 3];
+      Index b = triangle.vertices[(i + 2) % 3];
+      if (a == INFINITE || b == INFINITE ||
+          orient2d(to, m_sites[a], m_sites[b]) <= 0) {
+        inside = false;
+        break;
+      }
+      star.push_back(t);
+      t = triangle.neighbours[(i + 1) % 3];
+    } while (t != first);
+  }
+
+  if (!inside) {
+    remove(v);
+    std::vector<Index> changed = std::move(m_changed);
+
+    // O(N), only while every site left is collinear
+    bool flat = m_last == NONE;
+    if (flat) {
+      for (Index u : m_line) {
+        if (m_sites[u] == to) {
+          m_changed = std::move(changed);
+          return false;
+        }
+      }
+    }
+
+    // The walk starts in the hole v left, next to where it goes
+    m_sites[v] = to;
+    Index u = add(v);
+    m_changed = std::move(changed);
+    if (u != v)
+      return false;
+
+    if (flat) {
+      for (Index w = 0; w < m_sites.size(); w++) {
+        if (contains(w))
+          m_changed.push_back(w);
+      }
+    } else {
+      std::vector<Index> around = neighbours(v);
+      m_changed.insert(m_changed.end(), around.begin(), around.end());
+    }
+  } else {
+    m_sites[v] = to;
+    for (Index t : star) {
+      for (Index u : m_triangles[t].vertices) {
+        m_changed.push_back(u);
+      }
+    }
+
+    // Lawson flips, only edges of triangles around v or of flipped ones can
+    // have lost the empty circle. O(degree) for a small move
+    std::vector<Index> &pending = star;
+    while (!pending.empty()) {
+      Index t = pending.back();
+      pending.pop_back();
+
+      for (int i = 0; i < 3; i++) {
+        const Triangle &triangle = m_triangles[t];
+        Index n = triangle.neighbours[i];
+        if (ghost(n))
+          continue;
+
+        const Triangle &other = m_triangles[n];
+        int j = other.neighbours[0] == t ? 0 : other.neighbours[1] == t ? 1 : 2;
+        Index d = other.vertices[j];
+        if (incircle(m_sites[triangle.vertices[0]],
+                     m_sites[triangle.vertices[1]],
+                     m_sites[triangle.vertices[2]], m_sites[d]) > 0) {
+          m_changed.push_back(d);
+          flip(t, i);
+          pending.push_back(t);
+          pending.push_back(n);
+          break;
+        }
+      }
+    }
+  }
+
+  std::sort(m_changed.begin(), m_changed.end());
+  m_changed.erase(std::unique(m_changed.begin(), m_changed.end()),
+                  m_changed.end());
+  if (std::find(m_changed.begin(), m_changed.end(), v) == m_changed.end())
+    m_changed.push_back(v);
+  return true;
+}
+
+bool Triangulation::contains(Index v) const {
+  if (m_last == NONE)
+    return std::find(m_line.begin(), m_line.end(), v) != m_line.end();
+  return m_vertexTriangle[v] != NONE;
+}
+
+bool Triangulation::ghost(Index t) const {
+  const Triangle &triangle = m_triangles[t];
+  return triangle.vertices[0] == INFINITE ||
+         triangle.vertices[1] == INFINITE || triangle.vertices[2] == INFINITE;
+}
+
+size_t Triangulation::triangleCount() const {
+  size_t count = 0;
+  for (Index t = 0; t < m_triangles.size(); t++) {
+    count += alive(t) && !ghost(t);
+  }
+  return count;
+}
+
+Vec2 Triangulation::center(Index t) const {
+  const Index *vertices = m_triangles[t].vertices;
+  return PowerCenter(m_sites[vertices[0]], weight(vertices[0]),
+                     m_sites[vertices[1]], weight(vertices[1]),
+                     m_sites[vertices[2]], weight(vertices[2]));
+}
+
+Line Triangulation::bisector(Index u, Index v) const {
+  if (!weighted())
+    return TwoPointsBisector(m_sites[u], m_sites[v]);
+  return RadicalAxis(m_sites[u], m_weights[u], m_sites[v], m_weights[v]);
+}
+
+std::vector<Triangulation::Index> Triangulation::neighbours(Index v) const {
+  std::vector<Index> result;
+
+  if (m_last == NONE) {
+    std::vector<Index> sorted = line();
+    auto it = std::find(sorted.begin(), sorted.end(), v);
+    if (it == sorted.end())
+      return result;
+    if (it + 1 != sorted.end())
+      result.push_back(*(it + 1));
+    if (it != sorted.begin())
+      result.push_back(*(it - 1));
+    return result;
+  }
+
+  Index first = m_vertexTriangle[v];
+  if (first == NONE)
+    return result;
+
+  // Across the edge v -> vertices[i + 2] is the next triangle
+  // counter-clockwise around v
+  Index t = first;
+  do {
+    const Triangle &triangle = m_triangles[t];
+    int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+    Index u = triangle.vertices[(i + 1) % 3];
+    if (u != INFINITE)
+      result.push_back(u);
+    t = triangle.neighbours[(i + 1) % 3];
+  } while (t != first);
+
+  return result;
+}
+
+std::vector<DelaunayEdge> Triangulation::edges() const {
+  std::vector<DelaunayEdge> result;
+
+  if (m_last == NONE) {
+    std::vector<Index> sorted = line();
+    for (size_t i = 1; i < sorted.size(); i++) {
+      result.push_back({m_sites[sorted[i - 1]], m_sites[sorted[i]]});
+    }
+    return result;
+  }
+
+  result.reserve(m_sites.size() * 3);
+  for (Index t = 0; t < m_triangles.size(); t++) {
+    if (!alive(t))
+      continue;
+
+    const Triangle &triangle = m_triangles[t];
+    for (int i = 0; i < 3; i++) {
+      Index a = triangle.vertices[(i + 1) % 3];
+      Index b = triangle.vertices[(i + 2) % 3];
+      if (a != INFINITE && b != INFINITE && t < triangle.neighbours[i])
+        result.push_back({m_sites[a], m_sites[b]});
+    }
+  }
+
+  return result;
+}
+
+std::vector<Cell> Triangulation::voronoi(const Vec2 &topleft,
+                                         const Vec2 &bottomright) const {
+  std::vector<Cell> cells(m_sites.size());
+  Cell box = BoxCell(topleft, bottomright);
+
+  if (m_last == NONE) {
+    std::vector<Index> sorted = line();
+    for (size_t i = 0; i < sorted.size(); i++) {
+      Cell result = box;
+      if (i > 0)
+        ClipCell(result, bisector(sorted[i], sorted[i - 1]));
+      if (i + 1 < sorted.size())
+        ClipCell(result, bisector(sorted[i], sorted[i + 1]));
+      cells[sorted[i]] = std::move(result);
+    }
+    return cells;
+  }
+
+  // O(N), the star of every vertex is read independently
+  JobSystem::get().parallelFor(0, m_sites.size(), 256,
+                               [&](size_t begin, size_t end) {
+                                 for (size_t v = begin; v < end; v++) {
+                                   cells[v] = cell(v, topleft, bottomright);
+                                 }
+                               });
+
+  return cells;
+}
+
+Cell Triangulation::cell(Index v, const Vec2 &topleft,
+                         const Vec2 &bottomright) const {
+  Cell result = BoxCell(topleft, bottomright);
+
+  if (m_last == NONE) {
+    std::vector<Index> sorted = line();
+    auto it = std::find(sorted.begin(), sorted.end(), v);
+    if (it == sorted.end())
+      return {};
+    if (it != sorted.begin())
+      ClipCell(result, bisector(v, *(it - 1)));
+    if (it + 1 != sorted.end())
+      ClipCell(result, bisector(v, *(it + 1)));
+    return result;
+  }
+
+  Index first = m_vertexTriangle[v];
+  if (first == NONE)
+    return {}; // duplicate or removed
+
+  // Every Voronoi vertex is the center of a triangle around v
+  Cell ring;
+  bool hull = false;
+  Index t = first;
+  do {
+    const Triangle &triangle = m_triangles[t];
+    int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+    if (ghost(t)) {
+      hull = true;
+      break;
+    }
+    ring.push_back(center(t));
+    t = triangle.neighbours[(i + 1) % 3];
+  } while (t != first);
+
+  if (hull) {
+    // Unbounded, only the Delaunay neighbours can bound it
+    for (Index u : neighbours(v)) {
+      ClipCell(result, bisector(v, u));
+    }
+    return result;
+  }
+
+  const Line sides[4] = {{-1, 0, topleft[0]},
+                         {1, 0, -bottomright[0]},
+                         {0, -1, topleft[1]},
+                         {0, 1, -bottomright[1]}};
+  for (const Line &side : sides) {
+    ClipCell(ring, side);
+  }
+
+  // Cocircular sites share a center
+  RemoveNearDuplicates(ring);
+  return ring;
+}
+
+Triangulation::Index Triangulation::add(Index v) {
+  if (m_last == NONE)
+    return addToLine(v);
+
+  const Vec2 &p = m_sites[v];
+  Index t = locate(p);
+  for (Index u : m_triangles[t].vertices) {
+    if (u != INFINITE && m_sites[u] == p)
+      return u;
+  }
+
+  // Above the lifted hull, hidden for good
+  if (weighted() && !conflict(t, v))
+    return v;
+
+  carve(v, t);
+  return v;
+}
+
+Triangulation::Index Triangulation::addToLine(Index v) {
+  // Duplicates on the line are dropped by line()
+  if (m_line.size() < 2 || m_sites[m_line[0]] == m_sites[m_line[1]] ||
+      orient2d(m_sites[m_line[0]], m_sites[m_line[1]], m_sites[v]) == 0) {
+    m_line.push_back(v);
+    // The first two sites define the line, keep them apart
+    if (m_line.size() > 2 && m_sites[m_line[0]] == m_sites[m_line[1]])
+      std::swap(m_line[1], m_line.back());
+    return v;
+  }
+
+  std::vector<Index> sorted = line();
+  m_line.clear();
+
+  start(sorted[0], sorted[1], v);
+  for (size_t i = 2; i < sorted.size(); i++) {
+    add(sorted[i]);
+  }
+  return v;
+}
+
+void Triangulation::start(Index a, Index b, Index c) {
+  if (orient2d(m_sites[a], m_sites[b], m_sites[c]) < 0)
+    std::swap(a, b);
+
+  Index created[4] = {newTriangle(a, b, c), newTriangle(c, b, INFINITE),
+                      newTriangle(a, c, INFINITE),
+                      newTriangle(b, a, INFINITE)};
+
+  // O(1), every edge is matched with its reverse
+  for (Index t : created) {
+    Triangle &triangle = m_triangles[t];
+    for (int i = 0; i < 3; i++) {
+      Index from = triangle.vertices[(i + 1) % 3];
+      Index to = triangle.vertices[(i + 2) % 3];
+      for (Index s : created) {
+        const Triangle &other = m_triangles[s];
+        for (int j = 0; j < 3; j++) {
+          if (other.vertices[(j + 1) % 3] == to &&
+              other.vertices[(j + 2) % 3] == from)
+            triangle.neighbours[i] = s;
+        }
+      }
+    }
+  }
+
+  m_vertexTriangle[a] = m_vertexTriangle[b] = m_vertexTriangle[c] =
+      created[0];
+  m_last = created[0];
+  m_count = 3;
+}
+
+std::vector<Triangulation::Index> Triangulation::line() const {
+  std::vector<Index> sorted = m_line;
+  if (sorted.empty())
+    return sorted;
+
+  const Vec2 &origin = m_sites[sorted[0]];
+  auto distinct = std::find_if(sorted.begin(), sorted.end(), [&](Index u) {
+    return !(m_sites[u] == origin);
+  });
+  if (distinct == sorted.end())
+    return {sorted[0]};
+
+  double dx = (double)m_sites[*distinct][0] - origin[0];
+  double dy = (double)m_sites[*distinct][1] - origin[1];
+  auto along = [&](Index u) {
+    return (m_sites[u][0] - origin[0]) * dx + (m_sites[u][1] - origin[1]) * dy;
+  };
+
+  // O(N log(N))
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [&](Index a, Index b) { return along(a) < along(b); });
+  sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                           [&](Index a, Index b) {
+                             return m_sites[a] == m_sites[b];
+                           }),
+               sorted.end());
+  if (!weighted())
+    return sorted;
+
+  // Lower hull of the sites lifted along the line, O(N)
+  double length = std::sqrt(dx * dx + dy * dy);
+  auto lift = [&](Index u) {
+    double x = along(u) / length;
+    return std::pair{x, x * x - m_weights[u]};
+  };
+  std::vector<Index> hull;
+  for (Index u : sorted) {
+    auto [x, y] = lift(u);
+    while (hull.size() > 1) {
+      auto [ax, ay] = lift(hull[hull.size() - 2]);
+      auto [bx, by] = lift(hull.back());
+      if ((bx - ax) * (y - ay) - (by - ay) * (x - ax) > 0)
+        break;
+      hull.pop_back();
+    }
+    hull.push_back(u);
+  }
+  return hull;
+}
+
+Triangulation::Index Triangulation::locate(const Vec2 &p) const {
+  Index t = m_last;
+
+  // Visibility walk, O(sqrt(N)) steps from a random start and close to O(1)
+  // in Hilbert order. Starting at a random edge keeps it from cycling
+  while (!ghost(t)) {
+    const Triangle &triangle = m_triangles[t];
+    m_seed = m_seed * 1664525u + 1013904223u;
+    int first = (m_seed >> 16) % 3;
+
+    Index next = NONE;
+    for (int k = 0; k < 3; k++) {
+      int i = (first + k) % 3;
+      if (orient2d(m_sites[triangle.vertices[(i + 1) % 3]],
+                 m_sites[triangle.vertices[(i + 2) % 3]], p) < 0) {
+        next = triangle.neighbours[i];
+        break;
+      }
+    }
+
+    if (next == NONE)
+      return t;
+    t = next;
+  }
+
+  return t;
+}
+
+void Triangulation::flip(Index t, int i) {
+  Triangle &triangle = m_triangles[t];
+  Index n = triangle.neighbours[i];
+  Triangle &other = m_triangles[n];
+  int j = other.neighbours[0] == t ? 0 : other.neighbours[1] == t ? 1 : 2;
+
+  // t = a, b, c and n = d, c, b become a, b, d and a, d, c
+  Index a = triangle.vertices[i];
+  Index b = triangle.vertices[(i + 1) % 3];
+  Index c = triangle.vertices[(i + 2) % 3];
+  Index d = other.vertices[j];
+  Index ab = triangle.neighbours[(i + 2) % 3];
+  Index ca = triangle.neighbours[(i + 1) % 3];
+  Index bd = other.neighbours[(j + 1) % 3];
+  Index dc = other.neighbours[(j + 2) % 3];
+
+  triangle = {{a, b, d}, {bd, n, ab}};
+  other = {{a, d, c}, {dc, ca, t}};
+
+  for (Index &s : m_triangles[bd].neighbours) {
+    if (s == n) {
+      s = t;
+      break;
+    }
+  }
+  for (Index &s : m_triangles[ca].neighbours) {
+    if (s == t) {
+      s = n;
+      break;
+    }
+  }
+
+  m_vertexTriangle[a] = m_vertexTriangle[b] = m_vertexTriangle[d] = t;
+  m_vertexTriangle[c] = n;
+}
+
+bool Triangulation::conflict(Index t, Index v) const {
+  const Triangle &triangle = m_triangles[t];
+  return encloses(triangle.vertices[0], triangle.vertices[1],
+                  triangle.vertices[2], v);
+}
+
+bool Triangulation::encloses(Index a, Index b, Index c, Index d) const {
+  const Vec2 &p = m_sites[d];
+  if (a != INFINITE && b != INFINITE && c != INFINITE) {
+    if (weighted())
+      return powertest(m_sites[a], m_weights[a], m_sites[b], m_weights[b],
+                       m_sites[c], m_weights[c], p, m_weights[d]) > 0;
+    return incircle(m_sites[a], m_sites[b], m_sites[c], p) > 0;
+  }
+
+  // A ghost's circle is the half plane outside its hull edge, plus the open
+  // edge itself
+  while (c != INFINITE) {
+    Index rotated = a;
+    a = b;
+    b = c;
+    c = rotated;
+  }
+  const Vec2 &from = m_sites[a];
+  const Vec2 &to = m_sites[b];
+  double side = orient2d(from, to, p);
+  if (side != 0)
+    return side > 0;
+
+  double along = ((double)p[0] - from[0]) * ((double)to[0] - from[0]) +
+                 ((double)p[1] - from[1]) * ((double)to[1] - from[1]);
+  double length = ((double)to[0] - from[0]) * ((double)to[0] - from[0]) +
+                  ((double)to[1] - from[1]) * ((double)to[1] - from[1]);
+  if (!weighted())
+    return along > 0 && along < length;
+
+  // On the edge's line, below the line through the lifted ends, lifted
+  // around from
+  double t = along / length;
+  double lifted = along * t - ((double)m_weights[d] - m_weights[a]);
+  double chord = along - t * ((double)m_weights[b] - m_weights[a]);
+  return lifted < chord;
+}
+
+void Triangulation::carve(Index v, Index first) {
+  m_count++;
+  m_epoch++;
+  const uint32_t inside = 2 * m_epoch, outside = inside + 1;
+
+  // The cavity is every triangle whose circle holds v, connected and star
+  // shaped around it
+  m_cavity.clear();
+  m_cavity.push_back(first);
+  m_marks[first] = inside;
+  for (size_t i = 0; i < m_cavity.size(); i++) {
+    for (Index n : m_triangles[m_cavity[i]].neighbours) {
+      if (m_marks[n] >= inside)
+        continue;
+      bool in = conflict(n, v);
+      m_marks[n] = in ? inside : outside;
+      if (in)
+        m_cavity.push_back(n);
+    }
+  }
+
+  // Boundary edges from -> to, each becomes a triangle with v
+  struct Edge {
+    Index from, to, out, old, triangle;
+  };
+  std::vector<Edge> boundary;
+  for (Index t : m_cavity) {
+    const Triangle &triangle = m_triangles[t];
+    for (int i = 0; i < 3; i++) {
+      Index n = triangle.neighbours[i];
+      if (m_marks[n] != inside) {
+        boundary.push_back({triangle.vertices[(i + 1) % 3],
+                            triangle.vertices[(i + 2) % 3], n, t, NONE});
+      }
+    }
+  }
+
+  // Allocated before the cavity is freed, so an old index never names a new
+  // triangle while the outside is relinked
+  for (Edge &edge : boundary) {
+    edge.triangle = newTriangle(edge.from, edge.to, v);
+    m_triangles[edge.triangle].neighbours[2] = edge.out;
+    for (Index &n : m_triangles[edge.out].neighbours) {
+      if (n == edge.old) {
+        n = edge.triangle;
+        break;
+      }
+    }
+  }
+
+  // Once weighted, vertices inside the cavity end up above the lifted hull
+  std::vector<Index> buried;
+  if (weighted()) {
+    for (Index t : m_cavity) {
+      for (Index u : m_triangles[t].vertices) {
+        if (u != INFINITE)
+          buried.push_back(u);
+      }
+    }
+  }
+  for (Index t : m_cavity) {
+    freeTriangle(t);
+  }
+
+  // The boundary is a cycle around p, consecutive edges share a vertex
+  std::sort(boundary.begin(), boundary.end(),
+            [](const Edge &a, const Edge &b) { return a.from < b.from; });
+  auto startingAt = [&](Index from) {
+    return std::lower_bound(boundary.begin(), boundary.end(), from,
+                            [](const Edge &e, Index u) { return e.from < u; })
+        ->triangle;
+  };
+
+  for (Edge &edge : boundary) {
+    Triangle &triangle = m_triangles[edge.triangle];
+    triangle.neighbours[0] = startingAt(edge.to);
+    m_triangles[triangle.neighbours[0]].neighbours[1] = edge.triangle;
+
+    if (edge.from != INFINITE)
+      m_vertexTriangle[edge.from] = edge.triangle;
+    if (edge.from != INFINITE && edge.to != INFINITE) {
+      m_vertexTriangle[v] = edge.triangle;
+      m_last = edge.triangle;
+    }
+  }
+
+  // Those on the boundary point at a new triangle now
+  for (Index u : buried) {
+    Index t = m_vertexTriangle[u];
+    if (t != NONE && m_marks[t] == inside) {
+      m_vertexTriangle[u] = NONE;
+      m_count--;
+    }
+  }
+}
+
+void Triangulation::rebuild(const std::vector<Index> &vertices) {
+  for (Index t = 0; t < m_triangles.size(); t++) {
+    if (alive(t))
+      m_freed.push_back(t);
+  }
+  m_triangles.clear();
+  m_free.clear();
+  m_marks.clear();
+  m_line.clear();
+  m_last = NONE;
+  m_count = 0;
+
+  for (Index u : vertices) {
+    m_vertexTriangle[u] = NONE;
+  }
+  for (Index u : vertices) {
+    add(u);
+  }
+}
+
+Triangulation::Index Triangulation::newTriangle(Index a, Index b, Index c) {
+  Index t;
+  if (!m_free.empty()) {
+    t = m_free.back();
+    m_free.pop_back();
+  } else {
+    t = m_triangles.size();
+    m_triangles.emplace_back();
+    m_marks.push_back(0);
+  }
+
+  m_triangles[t] = {{a, b, c}, {NONE, NONE, NONE}};
+  return t;
+}
+
+void Triangulation::freeTriangle(Index t) {
+  m_triangles[t].vertices[0] = NONE;
+  m_free.push_back(t);
+  m_freed.push_back(t);
+}
@@ -0,0 +1,555 @@
+#include "Voronoi/Fortune.hpp"
+
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+
+const double INF = std::numeric_limits<double>::infinity();
+const uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+struct Point {
+  double x = 0;
+  double y = 0;
+};
+
+struct Box {
+  double min[2];
+  double max[2];
+};
+
+// Direction a breakpoint between the arcs of `left` and `right` follows
+// along their bisector while the sweep moves up
+Point Direction(const Point &left, const Point &right) {
+  return {-(right.y - left.y), right.x - left.x};
+}
+
+// Liang-Barsky, clips origin + t * dir with t in [t0, t1] to the box
+bool ClipLine(const Box &box, const Point &origin, const Point &dir,
+              double &t0, double &t1) {
+  double o[2] = {origin.x, origin.y};
+  double d[2] = {dir.x, dir.y};
+
+  for (int axis = 0; axis < 2; axis++) {
+    if (d[axis] == 0) {
+      if (o[axis] < box.min[axis] || o[axis] > box.max[axis])
+        return false;
+      continue;
+    }
+
+    double a = (box.min[axis] - o[axis]) / d[axis];
+    double b = (box.max[axis] - o[axis]) / d[axis];
+    if (a > b)
+      std::swap(a, b);
+
+    t0 = std::max(t0, a);
+    t1 = std::min(t1, b);
+  }
+
+  return t0 <= t1;
+}
+
+// Monotonic in the angle of (x, y) on [0, 4), cheaper than atan2 for sorting
+float PseudoAngle(float x, float y) {
+  float p = x / (std::fabs(x) + std::fabs(y));
+  return y < 0 ? 3 + p : 1 - p;
+}
+
+// x where the arc of `left` meets the arc of `right` with the sweep at `l`
+double Breakpoint(const Point &left, const Point &right, double l) {
+  if (left.y == right.y)
+    return (left.x + right.x) / 2;
+
+  // A site on the sweep line is still a vertical ray
+  if (left.y == l)
+    return left.x;
+  if (right.y == l)
+    return right.x;
+
+  // Relative to the left site, like the circle events: absolute squares
+  // would cancel down to the rounding of coordinates far from the origin
+  double rx = right.x - left.x, ry = right.y - left.y;
+  double sweep = l - left.y;
+  double dl = -2 * sweep;
+  double dr = 2 * (ry - sweep);
+
+  double a = 1 / dl - 1 / dr;
+  double b = 2 * rx / dr;
+  double c = -sweep * sweep / dl - (rx * rx + ry * ry - sweep * sweep) / dr;
+
+  // The left arc is on top before this root, written to avoid cancellation
+  double root = std::sqrt(std::max(0.0, b * b - 4 * a * c));
+  if (b < 0)
+    return left.x + 2 * c / (root - b);
+
+  return left.x + (-b - root) / (2 * a);
+}
+
+class Sweep {
+public:
+  Sweep(const std::vector<Vec2> &sites, const Box &box, std::vector<Cell> &cells)
+      : m_box(box), m_cells(cells) {
+    m_sites.reserve(sites.size());
+    for (auto &site : sites) {
+      m_sites.push_back({site[0], site[1]});
+    }
+  }
+
+  uint32_t run() {
+    std::vector<uint32_t> order(m_sites.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+      const Point &p = m_sites[a];
+      const Point &q = m_sites[b];
+      return p.y < q.y || (p.y == q.y && p.x < q.x);
+    });
+
+    uint32_t events = 0;
+    size_t next = 0;
+    while (next < order.size() || !m_circles.empty()) {
+      if (!m_circles.empty()) {
+        Circle circle = m_circles.top();
+        if (circle.arc->stamp != circle.stamp) {
+          m_circles.pop();
+          continue;
+        }
+
+        // Vertices go first when they tie with a site
+        if (next == order.size() || circle.y <= m_sites[order[next]].y) {
+          m_circles.pop();
+          m_sweep = circle.y;
+          removeArc(circle);
+          events++;
+          continue;
+        }
+      }
+
+      m_sweep = m_sites[order[next]].y;
+      addSite(order[next++]);
+      events++;
+    }
+
+    finish();
+    return events;
+  }
+
+private:
+  struct Arc {
+    uint32_t site;
+
+    // Beach line order
+    Arc *prev;
+    Arc *next;
+
+    // Treap
+    Arc *parent;
+    Arc *left;
+    Arc *right;
+    uint32_t priority;
+
+    // Bumped whenever a queued circle event of this arc becomes stale
+    uint32_t stamp = 0;
+
+    // Segments traced by the breakpoints on each side
+    uint32_t leftEdge;
+    uint32_t rightEdge;
+  };
+
+  struct Segment {
+    uint32_t left;
+    uint32_t right;
+    Point origin;
+    Point end;
+    // Sites of the first row have no start vertex
+    bool open;
+  };
+
+  struct Circle {
+    double y;
+    double x;
+    Point center;
+    Arc *arc;
+    uint32_t stamp;
+
+    bool operator>(const Circle &other) const {
+      return y > other.y || (y == other.y && x > other.x);
+    }
+  };
+
+  void addSite(uint32_t site) {
+    const Point &p = m_sites[site];
+    if (!m_root) {
+      m_root = newArc(site);
+      return;
+    }
+
+    Arc *arc = find(p.x);
+    const Point &a = m_sites[arc->site];
+
+    // Still on the first row, every arc is a vertical ray and p is the
+    // rightmost one
+    if (a.y == p.y) {
+      Arc *added = newArc(site);
+      insertAfter(arc, added);
+
+      uint32_t edge = openSegment(arc->site, site, {(a.x + p.x) / 2, p.y});
+      m_segments[edge].open = true;
+      arc->rightEdge = added->leftEdge = edge;
+      return;
+    }
+
+    // Split the arc above p in two with p's arc in the middle
+    arc->stamp++;
+    Arc *middle = newArc(site);
+    Arc *split = newArc(arc->site);
+    split->rightEdge = arc->rightEdge;
+    insertAfter(arc, middle);
+    insertAfter(middle, split);
+
+    // On the arc above p, a.y² - p.y² factored so that nothing cancels
+    double dx = p.x - a.x, dy = a.y - p.y;
+    Point start = {p.x, p.y + (dx * dx + dy * dy) / (2 * dy)};
+    arc->rightEdge = middle->leftEdge = openSegment(arc->site, site, start);
+    middle->rightEdge = split->leftEdge = openSegment(site, arc->site, start);
+
+    checkCircle(arc);
+    checkCircle(split);
+  }
+
+  void removeArc(const Circle &circle) {
+    Arc *arc = circle.arc;
+    Arc *prev = arc->prev;
+    Arc *next = arc->next;
+
+    closeSegment(arc->leftEdge, circle.center);
+    closeSegment(arc->rightEdge, circle.center);
+
+    prev->stamp++;
+    next->stamp++;
+    uint32_t edge = openSegment(prev->site, next->site, circle.center);
+    prev->rightEdge = next->leftEdge = edge;
+
+    erase(arc);
+    checkCircle(prev);
+    checkCircle(next);
+  }
+
+  void checkCircle(Arc *arc) {
+    Arc *prev = arc->prev;
+    Arc *next = arc->next;
+    if (!prev || !next || prev->site == next->site)
+      return;
+
+    const Point &a = m_sites[prev->site];
+    const Point &b = m_sites[arc->site];
+    const Point &c = m_sites[next->site];
+
+    double bx = b.x - a.x, by = b.y - a.y;
+    double cx = c.x - a.x, cy = c.y - a.y;
+
+    // Only converging breakpoints meet
+    double d = 2 * (bx * cy - by * cx);
+    if (d <= 0)
+      return;
+
+    double b2 = bx * bx + by * by;
+    double c2 = cx * cx + cy * cy;
+    Point center = {a.x + (cy * b2 - by * c2) / d,
+                    a.y + (bx * c2 - cx * b2) / d};
+
+    double dx = center.x - a.x, dy = center.y - a.y;
+    double radius = std::sqrt(dx * dx + dy * dy);
+    double y = std::max(center.y + radius, m_sweep);
+    m_circles.push({y, center.x, center, arc, arc->stamp});
+  }
+
+  void finish() {
+    Arc *arc = m_root;
+    while (arc && arc->left)
+      arc = arc->left;
+
+    for (; arc && arc->next; arc = arc->next) {
+      emit(m_segments[arc->rightEdge], false);
+    }
+  }
+
+  uint32_t openSegment(uint32_t left, uint32_t right, Point origin) {
+    uint32_t id;
+    if (m_freeSegments.empty()) {
+      id = m_segments.size();
+      m_segments.emplace_back();
+    } else {
+      id = m_freeSegments.back();
+      m_freeSegments.pop_back();
+    }
+
+    m_segments[id] = {left, right, origin, origin, false};
+    return id;
+  }
+
+  void closeSegment(uint32_t id, Point end) {
+    Segment &segment = m_segments[id];
+    segment.end = end;
+    emit(segment, true);
+    m_freeSegments.push_back(id);
+  }
+
+  // Adds the part of the segment inside the box to both cells it separates
+  void emit(const Segment &segment, bool closed) {
+    Point dir = Direction(m_sites[segment.left], m_sites[segment.right]);
+
+    double start = segment.open ? -INF : 0;
+    double end = INF;
+    if (closed) {
+      end = ((segment.end.x - segment.origin.x) * dir.x +
+             (segment.end.y - segment.origin.y) * dir.y) /
+            (dir.x * dir.x + dir.y * dir.y);
+    }
+
+    double t0 = start, t1 = end;
+    if (!ClipLine(m_box, segment.origin, dir, t0, t1))
+      return;
+
+    // Reuse the exact vertices when they are inside, neighbouring cells then
+    // share them bit for bit
+    Point p = segment.origin;
+    if (t0 != start)
+      p = {segment.origin.x + t0 * dir.x, segment.origin.y + t0 * dir.y};
+
+    Point q = segment.end;
+    if (t1 != end)
+      q = {segment.origin.x + t1 * dir.x, segment.origin.y + t1 * dir.y};
+
+    for (uint32_t site : {segment.left, segment.right}) {
+      m_cells[site].push_back({(float)p.x, (float)p.y});
+      m_cells[site].push_back({(float)q.x, (float)q.y});
+    }
+  }
+
+  // Last arc whose left breakpoint is not past x
+  Arc *find(double x) {
+    Arc *found = nullptr;
+    for (Arc *arc = m_root; arc;) {
+      if (!arc->prev || Breakpoint(m_sites[arc->prev->site],
+                                   m_sites[arc->site], m_sweep) <= x) {
+        found = arc;
+        arc = arc->right;
+      } else {
+        arc = arc->left;
+      }
+    }
+
+    return found;
+  }
+
+  Arc *newArc(uint32_t site) {
+    Arc *arc;
+    if (m_freeArcs.empty()) {
+      arc = &m_arcs.emplace_back();
+    } else {
+      arc = m_freeArcs.back();
+      m_freeArcs.pop_back();
+    }
+
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    arc->site = site;
+    arc->prev = arc->next = nullptr;
+    arc->parent = arc->left = arc->right = nullptr;
+    arc->priority = m_seed;
+    arc->stamp++;
+    arc->leftEdge = arc->rightEdge = NO_EDGE;
+    return arc;
+  }
+
+  // Moves `arc` above its parent keeping the in-order sequence
+  void rotateUp(Arc *arc) {
+    Arc *parent = arc->parent;
+    Arc *grand = parent->parent;
+
+    if (parent->left == arc) {
+      parent->left = arc->right;
+      if (arc->right)
+        arc->right->parent = parent;
+      arc->right = parent;
+    } else {
+      parent->right = arc->left;
+      if (arc->left)
+        arc->left->parent = parent;
+      arc->left = parent;
+    }
+
+    parent->parent = arc;
+    arc->parent = grand;
+
+    if (!grand)
+      m_root = arc;
+    else if (grand->left == parent)
+      grand->left = arc;
+    else
+      grand->right = arc;
+  }
+
+  void insertAfter(Arc *pos, Arc *arc) {
+    arc->prev = pos;
+    arc->next = pos->next;
+    if (pos->next)
+      pos->next->prev = arc;
+    pos->next = arc;
+
+    // In-order successor slot
+    if (!pos->right) {
+      pos->right = arc;
+      arc->parent = pos;
+    } else {
+      Arc *node = pos->right;
+      while (node->left)
+        node = node->left;
+      node->left = arc;
+      arc->parent = node;
+    }
+
+    while (arc->parent && arc->parent->priority < arc->priority)
+      rotateUp(arc);
+  }
+
+  void erase(Arc *arc) {
+    while (arc->left && arc->right) {
+      rotateUp(arc->left->priority > arc->right->priority ? arc->left
+                                                          : arc->right);
+    }
+
+    Arc *child = arc->left ? arc->left : arc->right;
+    if (child)
+      child->parent = arc->parent;
+
+    if (!arc->parent)
+      m_root = child;
+    else if (arc->parent->left == arc)
+      arc->parent->left = child;
+    else
+      arc->parent->right = child;
+
+    if (arc->prev)
+      arc->prev->next = arc->next;
+    if (arc->next)
+      arc->next->prev = arc->prev;
+
+    arc->stamp++;
+    m_freeArcs.push_back(arc);
+  }
+
+  std::vector<Point> m_sites;
+  Box m_box;
+  std::vector<Cell> &m_cells;
+  double m_sweep = 0;
+
+  Arc *m_root = nullptr;
+  std::deque<Arc> m_arcs;
+  std::vector<Arc *> m_freeArcs;
+  uint32_t m_seed = 0x9E3779B9;
+
+  std::vector<Segment> m_segments;
+  std::vector<uint32_t> m_freeSegments;
+
+  std::priority_queue<Circle, std::vector<Circle>, std::greater<Circle>>
+      m_circles;
+};
+
+} // namespace
+
+std::vector<Cell> ComputeFortune(const std::vector<Vec2> &sites,
+                                 const Vec2 &topleft, const Vec2 &bottomright,
+                                 uint32_t &m) {
+  Box box = {{std::min(topleft[0], bottomright[0]),
+              std::min(topleft[1], bottomright[1])},
+             {std::max(topleft[0], bottomright[0]),
+              std::max(topleft[1], bottomright[1])}};
+
+  std::vector<Cell> cells(sites.size());
+  if (sites.empty()) {
+    m = 0;
+    return cells;
+  }
+
+  // Every vertex arrives twice, once per edge, and cells average six of them
+  for (auto &cell : cells) {
+    cell.reserve(16);
+  }
+
+  Sweep sweep(sites, box, cells);
+  m = sweep.run();
+
+  // Box corners belong to the nearest site. O(N)
+  for (int corner = 0; corner < 4; corner++) {
+    Vec2 c = {(float)box.min[0], (float)box.min[1]};
+    if (corner == 1 || corner == 2)
+      c[0] = box.max[0];
+    if (corner >= 2)
+      c[1] = box.max[1];
+
+    size_t nearest = 0;
+    float best = INF;
+    for (size_t i = 0; i < sites.size(); i++) {
+      float dx = sites[i][0] - c[0];
+      float dy = sites[i][1] - c[1];
+      if (dx * dx + dy * dy < best) {
+        best = dx * dx + dy * dy;
+        nearest = i;
+      }
+    }
+
+    cells[nearest].push_back(c);
+  }
+
+  // Every collected point lies on the boundary of a convex cell, sorting
+  // them around their centroid gives the polygon
+  // A vertex reached from two triples of sites rounds a few float ulps apart,
+  // closer sites than that cannot be told apart either
+  double extent = std::max({std::fabs(box.min[0]), std::fabs(box.min[1]),
+                            std::fabs(box.max[0]), std::fabs(box.max[1])});
+  float eps = 4 * std::numeric_limits<float>::epsilon() * extent;
+  JobSystem::get().parallelFor(0, cells.size(), 256, [&](size_t begin,
+                                                         size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      Cell &cell = cells[i];
+      if (cell.size() < 3) {
+        cell.clear();
+        continue;
+      }
+
+      Vec2 center = {0, 0};
+      for (auto &p : cell) {
+        center += p;
+      }
+      center *= 1.f / cell.size();
+
+      std::sort(cell.begin(), cell.end(), [&](const Vec2 &a, const Vec2 &b) {
+        return PseudoAngle(a[0] - center[0], a[1] - center[1]) <
+               PseudoAngle(b[0] - center[0], b[1] - center[1]);
+      });
+
+      auto close = [eps](const Vec2 &a, const Vec2 &b) {
+        return std::fabs(a[0] - b[0]) <= eps && std::fabs(a[1] - b[1]) <= eps;
+      };
+      cell.erase(std::unique(cell.begin(), cell.end(), close), cell.end());
+      while (cell.size() > 1 && close(cell.front(), cell.back()))
+        cell.pop_back();
+
+      if (cell.size() < 3)
+        cell.clear();
+    }
+  });
+
+  return cells;
+}
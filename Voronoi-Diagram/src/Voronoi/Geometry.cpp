@@ -0,0 +1,62 @@
+#include "Voronoi/Geometry.hpp"
+
+Cell BoxCell(const Vec2 &topleft, const Vec2 &bottomright) {
+  return {{topleft[0], topleft[1]},
+          {bottomright[0], topleft[1]},
+          {bottomright[0], bottomright[1]},
+          {topleft[0], bottomright[1]}};
+}
+
+void ClipCell(Cell &cell, const Line &line) {
+  Cell clipped;
+  clipped.reserve(cell.size() + 1);
+
+  for (size_t k = 0; k < cell.size(); ++k) {
+    size_t nk = (k + 1) % cell.size();
+    const Vec2 &p = cell[k];
+    const Vec2 &q = cell[nk];
+
+    bool ppos = IsOnPositiveSide(line, p);
+    bool qpos = IsOnPositiveSide(line, q);
+
+    if (ppos)
+      clipped.push_back(p);
+    if (ppos != qpos) {
+      clipped.push_back(Intersect(line, p, q));
+    }
+  }
+
+  cell.swap(clipped);
+}
+
+void RemoveNearDuplicates(std::vector<Vec2> &poly, float eps) {
+  if (poly.size() < 2)
+    return;
+  std::vector<Vec2> cleaned;
+  cleaned.push_back(poly[0]);
+  for (size_t i = 1; i < poly.size(); ++i) {
+    if (!IsClose(poly[i], cleaned.back(), eps)) {
+      cleaned.push_back(poly[i]);
+    }
+  }
+  // Check first and last
+  if (cleaned.size() > 1 && IsClose(cleaned.front(), cleaned.back(), eps)) {
+    cleaned.pop_back();
+  }
+  poly = std::move(cleaned);
+}
+
+void CleanSites(std::vector<Vec2> &sites) {
+  // O(N log(N))
+  std::sort(sites.begin(), sites.end(), [](const Vec2 &a, const Vec2 &b) {
+    return (a[0] < b[0]) || (a[0] == b[0] && a[1] < b[1]);
+  });
+
+  // O(N)
+  auto last =
+      std::unique(sites.begin(), sites.end(),
+                  [](const Vec2 &a, const Vec2 &b) { return IsClose(a, b); });
+
+  // O(1) erasure from the back is just size -= amount;
+  sites.erase(last, sites.end());
+}
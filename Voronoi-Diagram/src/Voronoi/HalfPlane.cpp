@@ -0,0 +1,210 @@
+#include "Voronoi/HalfPlane.hpp"
+
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+std::vector<std::vector<Vec2>> ComputeVoronoi(std::vector<Vec2> &input_sites,
+                                              const Vec2 &topleft,
+                                              const Vec2 &bottomright,
+                                              uint32_t &m) {
+  return ComputePowerDiagram(input_sites, {}, topleft, bottomright, m);
+}
+
+std::vector<Cell> ComputePowerDiagram(const std::vector<Vec2> &sites,
+                                      const std::vector<float> &weights,
+                                      const Vec2 &topleft,
+                                      const Vec2 &bottomright, uint32_t &m) {
+  Cell box = BoxCell(topleft, bottomright);
+
+  std::vector<std::vector<Vec2>> cells(sites.size());
+  std::atomic<uint32_t> total = 0;
+
+  // O(N), every cell only reads the sites so they are clipped in parallel
+  JobSystem::get().parallelFor(0, sites.size(), 8, [&](size_t begin,
+                                                       size_t end) {
+    uint32_t m = 0;
+    for (size_t i = begin; i < end; ++i) {
+      std::vector<Vec2> cell = box;
+
+      // O(N - 1)
+      for (size_t j = 0; j < sites.size(); ++j) {
+        // -1 from O(N - 1)
+        if (i == j)
+          continue;
+
+        Line bisector =
+            weights.empty()
+                ? TwoPointsBisector(sites[i], sites[j])
+                : RadicalAxis(sites[i], weights[i], sites[j], weights[j]);
+        if (std::isnan(bisector[2]))
+          continue; // skip degenerate
+
+        // O(M) where M = vertices in polygon can be at worst N - 1
+        // so O(N - 1)
+        m += cell.size();
+        ClipCell(cell, bisector);
+
+        // Not a polygon
+        if (cell.size() < 3)
+          break;
+      }
+
+      cells[i] = std::move(cell); // may be empty
+    }
+
+    total += m;
+  });
+
+  m = total;
+  return cells;
+}
+
+namespace {
+
+// Sites bucketed by cell, the buckets of each row stored back to back
+struct Grid {
+  float x, y, size;
+  int32_t width, height;
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> sites;
+
+  int32_t column(float px) const {
+    return std::clamp((int32_t)((px - x) / size), 0, width - 1);
+  }
+  int32_t row(float py) const {
+    return std::clamp((int32_t)((py - y) / size), 0, height - 1);
+  }
+};
+
+// About two sites per bucket. O(N)
+Grid BuildGrid(const std::vector<Vec2> &sites) {
+  float minX = sites[0][0], maxX = minX, minY = sites[0][1], maxY = minY;
+  for (const Vec2 &site : sites) {
+    minX = std::min(minX, site[0]);
+    maxX = std::max(maxX, site[0]);
+    minY = std::min(minY, site[1]);
+    maxY = std::max(maxY, site[1]);
+  }
+
+  Grid grid;
+  grid.x = minX;
+  grid.y = minY;
+  float w = maxX - minX, h = maxY - minY;
+  grid.size = std::max(std::sqrt(std::max(w * h, 0.f) * 2 / sites.size()),
+                       std::max(w, h) / 4096);
+  grid.size = std::max(grid.size, 1e-6f);
+  grid.width = (int32_t)(w / grid.size) + 1;
+  grid.height = (int32_t)(h / grid.size) + 1;
+
+  // Counting sort of the sites by bucket
+  std::vector<uint32_t> bucket(sites.size());
+  grid.offsets.assign((size_t)grid.width * grid.height + 1, 0);
+  for (size_t i = 0; i < sites.size(); i++) {
+    bucket[i] = grid.row(sites[i][1]) * grid.width + grid.column(sites[i][0]);
+    grid.offsets[bucket[i] + 1]++;
+  }
+  for (size_t b = 1; b < grid.offsets.size(); b++) {
+    grid.offsets[b] += grid.offsets[b - 1];
+  }
+
+  grid.sites.resize(sites.size());
+  std::vector<uint32_t> next(grid.offsets.begin(), grid.offsets.end() - 1);
+  for (size_t i = 0; i < sites.size(); i++) {
+    grid.sites[next[bucket[i]]++] = i;
+  }
+
+  return grid;
+}
+
+} // namespace
+
+void ClipVoronoiCells(const std::vector<Vec2> &sites, const Vec2 &topleft,
+                      const Vec2 &bottomright,
+                      const std::function<void(size_t, Cell &)> &emit,
+                      uint32_t &m) {
+  m = 0;
+  if (sites.empty())
+    return;
+
+  Grid grid = BuildGrid(sites);
+  Cell box = BoxCell(topleft, bottomright);
+  std::atomic<uint32_t> total = 0;
+
+  // Walking the sites bucket by bucket keeps neighbouring cells, and the
+  // buckets they read, on the same thread
+  JobSystem::get().parallelFor(0, sites.size(), 64, [&](size_t begin,
+                                                        size_t end) {
+    uint32_t m = 0;
+    for (size_t k = begin; k < end; ++k) {
+      uint32_t i = grid.sites[k];
+      const Vec2 &site = sites[i];
+      int32_t cx = grid.column(site[0]), cy = grid.row(site[1]);
+      Cell cell = box;
+
+      auto clip = [&](int32_t bx, int32_t by) {
+        if (bx < 0 || by < 0 || bx >= grid.width || by >= grid.height)
+          return;
+        uint32_t b = by * grid.width + bx;
+        for (uint32_t s = grid.offsets[b]; s < grid.offsets[b + 1]; s++) {
+          uint32_t j = grid.sites[s];
+          if (i == j || cell.size() < 3)
+            continue;
+
+          Line bisector = TwoPointsBisector(site, sites[j]);
+          if (std::isnan(bisector[2]))
+            continue; // skip degenerate
+
+          m += cell.size();
+          ClipCell(cell, bisector);
+        }
+      };
+
+      // Sites outside ring r are at least r buckets away
+      int32_t rings = std::max(grid.width, grid.height);
+      for (int32_t r = 0; r <= rings && cell.size() >= 3; r++) {
+        if (r == 0) {
+          clip(cx, cy);
+        } else {
+          for (int32_t d = -r; d <= r; d++) {
+            clip(cx + d, cy - r);
+            clip(cx + d, cy + r);
+          }
+          for (int32_t d = -r + 1; d <= r - 1; d++) {
+            clip(cx - r, cy + d);
+            clip(cx + r, cy + d);
+          }
+        }
+
+        float farthest = 0;
+        for (const Vec2 &vertex : cell) {
+          float dx = vertex[0] - site[0], dy = vertex[1] - site[1];
+          farthest = std::max(farthest, dx * dx + dy * dy);
+        }
+        float covered = r * grid.size;
+        if (4 * farthest <= covered * covered)
+          break;
+      }
+
+      if (cell.size() < 3)
+        cell.clear(); // not a polygon
+      emit(i, cell);
+    }
+
+    total += m;
+  });
+
+  m = total;
+}
+
+std::vector<Cell> ComputeVoronoiGrid(const std::vector<Vec2> &sites,
+                                     const Vec2 &topleft,
+                                     const Vec2 &bottomright, uint32_t &m) {
+  std::vector<Cell> cells(sites.size());
+  ClipVoronoiCells(
+      sites, topleft, bottomright,
+      [&](size_t i, Cell &cell) { cells[i] = std::move(cell); }, m);
+  return cells;
+}
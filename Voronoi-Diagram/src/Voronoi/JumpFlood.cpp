@@ -0,0 +1,322 @@
+#include "Voronoi/JumpFlood.hpp"
+
+#include "Utils/JobSystem.hpp"
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Locator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define JUMPFLOOD_AVX2
+#endif
+
+namespace {
+
+// Label of pixels no site reached yet, its position loses against any site
+// while the squared distance stays finite
+const float FAR_AWAY = 1e18f;
+
+struct Pass {
+  const uint32_t *from;
+  uint32_t *to;
+  // Site positions, with FAR_AWAY one past the last
+  const float *x;
+  const float *y;
+  uint32_t width;
+  uint32_t height;
+  uint32_t step;
+  float left, bottom;
+  float pixelWidth, pixelHeight;
+};
+
+// Pixels [begin, end) of row y against the candidate rows. Own pixel first,
+// then row by row and left to right, a candidate only wins when strictly
+// closer so both kernels pick the same site
+void RowScalar(const Pass &pass, uint32_t y, const uint32_t *rows,
+               int rowCount, uint32_t begin, uint32_t end) {
+  float py = pass.bottom + ((float)y + 0.5f) * pass.pixelHeight;
+  auto distance = [&](uint32_t label, float px) {
+    float dx = pass.x[label] - px, dy = pass.y[label] - py;
+    return dx * dx + dy * dy;
+  };
+
+  for (uint32_t x = begin; x < end; x++) {
+    float px = pass.left + ((float)x + 0.5f) * pass.pixelWidth;
+    uint32_t best = pass.from[y * pass.width + x];
+    float bestDistance = distance(best, px);
+
+    for (int r = 0; r < rowCount; r++) {
+      for (int64_t xx : {(int64_t)x - pass.step, (int64_t)x,
+                         (int64_t)x + pass.step}) {
+        if (xx < 0 || xx >= pass.width || (rows[r] == y && xx == x))
+          continue;
+
+        uint32_t label = pass.from[rows[r] * pass.width + xx];
+        float d = distance(label, px);
+        if (d < bestDistance) {
+          bestDistance = d;
+          best = label;
+        }
+      }
+    }
+
+    pass.to[y * pass.width + x] = best;
+  }
+}
+
+#ifdef JUMPFLOOD_AVX2
+__attribute__((target("avx2"))) inline __m256
+Distance8(const Pass &pass, __m256i labels, __m256 px, __m256 py) {
+  __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(pass.x, labels, 4), px);
+  __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(pass.y, labels, 4), py);
+  return _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+}
+
+// Eight pixels at a time from begin while all their candidates are inside
+// the row, returns where it stopped
+__attribute__((target("avx2"))) uint32_t
+RowAVX2(const Pass &pass, uint32_t y, const uint32_t *rows, int rowCount,
+        uint32_t begin, uint32_t end) {
+  const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256 py =
+      _mm256_set1_ps(pass.bottom + ((float)y + 0.5f) * pass.pixelHeight);
+
+  uint32_t x = begin;
+  for (; x + 8 <= end; x += 8) {
+    __m256 column = _mm256_add_ps(_mm256_set1_ps((float)x), lanes);
+    __m256 px = _mm256_add_ps(
+        _mm256_set1_ps(pass.left),
+        _mm256_mul_ps(_mm256_add_ps(column, _mm256_set1_ps(0.5f)),
+                      _mm256_set1_ps(pass.pixelWidth)));
+
+    __m256i best = _mm256_loadu_si256(
+        (const __m256i *)(pass.from + y * pass.width + x));
+    __m256 bestDistance = Distance8(pass, best, px, py);
+
+    for (int r = 0; r < rowCount; r++) {
+      for (uint32_t xx : {x - pass.step, x, x + pass.step}) {
+        if (rows[r] == y && xx == x)
+          continue;
+
+        __m256i labels = _mm256_loadu_si256(
+            (const __m256i *)(pass.from + rows[r] * pass.width + xx));
+        __m256 d = Distance8(pass, labels, px, py);
+        __m256 closer = _mm256_cmp_ps(d, bestDistance, _CMP_LT_OQ);
+        bestDistance = _mm256_blendv_ps(bestDistance, d, closer);
+        best = _mm256_castps_si256(_mm256_blendv_ps(
+            _mm256_castsi256_ps(best), _mm256_castsi256_ps(labels), closer));
+      }
+    }
+
+    _mm256_storeu_si256((__m256i *)(pass.to + y * pass.width + x), best);
+  }
+
+  return x;
+}
+#endif
+
+bool HasAVX2() {
+#ifdef JUMPFLOOD_AVX2
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+void Row(const Pass &pass, uint32_t y) {
+  uint32_t rows[3];
+  int rowCount = 0;
+  if (y >= pass.step)
+    rows[rowCount++] = y - pass.step;
+  rows[rowCount++] = y;
+  if (y + pass.step < pass.height)
+    rows[rowCount++] = y + pass.step;
+
+  uint32_t x = 0;
+#ifdef JUMPFLOOD_AVX2
+  // The borders, where a step leaves the row, stay scalar
+  if (HasAVX2() && pass.width > 2 * pass.step) {
+    RowScalar(pass, y, rows, rowCount, 0, pass.step);
+    x = RowAVX2(pass, y, rows, rowCount, pass.step, pass.width - pass.step);
+  }
+#endif
+  RowScalar(pass, y, rows, rowCount, x, pass.width);
+}
+
+} // namespace
+
+LabelImage JumpFlood(const std::vector<Vec2> &sites, const Vec2 &topleft,
+                     const Vec2 &bottomright, uint32_t width,
+                     uint32_t height) {
+  LabelImage image;
+  image.width = width;
+  image.height = height;
+  image.labels.assign((size_t)width * height, LabelImage::NO_SITE);
+  if (sites.empty() || image.labels.empty())
+    return image;
+
+  uint32_t n = sites.size();
+  std::vector<float> x(n + 1, FAR_AWAY), y(n + 1, FAR_AWAY);
+  for (uint32_t i = 0; i < n; i++) {
+    x[i] = sites[i][0];
+    y[i] = sites[i][1];
+  }
+
+  Pass pass;
+  pass.x = x.data();
+  pass.y = y.data();
+  pass.width = width;
+  pass.height = height;
+  pass.left = topleft[0];
+  pass.bottom = topleft[1];
+  pass.pixelWidth = (bottomright[0] - topleft[0]) / width;
+  pass.pixelHeight = (bottomright[1] - topleft[1]) / height;
+
+  // O(N), the site nearest to the centre keeps a pixel several fall in.
+  // Sites outside the box seed the closest border pixel
+  std::vector<uint32_t> from((size_t)width * height, n);
+  std::vector<uint32_t> pixels(n);
+  for (uint32_t i = 0; i < n; i++) {
+    int64_t column = std::floor((x[i] - pass.left) / pass.pixelWidth);
+    int64_t row = std::floor((y[i] - pass.bottom) / pass.pixelHeight);
+    column = std::clamp<int64_t>(column, 0, width - 1);
+    row = std::clamp<int64_t>(row, 0, height - 1);
+    pixels[i] = row * width + column;
+
+    float px = pass.left + ((float)column + 0.5f) * pass.pixelWidth;
+    float py = pass.bottom + ((float)row + 0.5f) * pass.pixelHeight;
+    auto distance = [&](uint32_t label) {
+      float dx = x[label] - px, dy = y[label] - py;
+      return dx * dx + dy * dy;
+    };
+
+    uint32_t &seed = from[pixels[i]];
+    if (distance(i) < distance(seed))
+      seed = i;
+  }
+
+  std::vector<uint32_t> lost;
+  for (uint32_t i = 0; i < n; i++) {
+    if (from[pixels[i]] != i)
+      lost.push_back(i);
+  }
+
+  // Steps N/2 down to 1 reach every pixel, the extra step of 1 fixes most of
+  // what the coarse steps got wrong
+  uint32_t size = 1;
+  while (size < std::max(width, height))
+    size *= 2;
+  std::vector<uint32_t> steps;
+  for (uint32_t step = size / 2; step > 0; step /= 2) {
+    steps.push_back(step);
+  }
+  steps.push_back(1);
+
+  std::vector<uint32_t> to(from.size());
+  for (uint32_t step : steps) {
+    pass.from = from.data();
+    pass.to = to.data();
+    pass.step = step;
+
+    JobSystem::get().parallelFor(0, height, 8, [&](size_t begin, size_t end) {
+      for (size_t row = begin; row < end; row++) {
+        Row(pass, row);
+      }
+    });
+    from.swap(to);
+  }
+
+  // Sites that lost their pixel to a nearer one never flooded, their cells
+  // are grown one by one from around that pixel. O(pixels they take)
+  std::vector<uint32_t> marks(from.size(), 0), queue;
+  for (uint32_t i : lost) {
+    uint32_t column = pixels[i] % width, row = pixels[i] / width;
+    auto take = [&](uint32_t c, uint32_t r) {
+      uint32_t p = r * width + c;
+      if (marks[p] == i + 1)
+        return;
+      marks[p] = i + 1;
+
+      float px = pass.left + ((float)c + 0.5f) * pass.pixelWidth;
+      float py = pass.bottom + ((float)r + 0.5f) * pass.pixelHeight;
+      float dx = x[i] - px, dy = y[i] - py;
+      float ox = x[from[p]] - px, oy = y[from[p]] - py;
+      if (dx * dx + dy * dy < ox * ox + oy * oy) {
+        from[p] = i;
+        queue.push_back(p);
+      }
+    };
+    auto around = [&](uint32_t c, uint32_t r) {
+      for (uint32_t rr = r ? r - 1 : 0; rr <= std::min(r + 1, height - 1);
+           rr++) {
+        for (uint32_t cc = c ? c - 1 : 0; cc <= std::min(c + 1, width - 1);
+             cc++) {
+          take(cc, rr);
+        }
+      }
+    };
+
+    queue.clear();
+    around(column, row);
+    while (!queue.empty()) {
+      uint32_t p = queue.back();
+      queue.pop_back();
+      around(p % width, p / width);
+    }
+  }
+
+  image.labels = std::move(from);
+  return image;
+}
+
+size_t JumpFloodErrors(const LabelImage &image, const std::vector<Vec2> &sites,
+                       const Vec2 &topleft, const Vec2 &bottomright) {
+  if (sites.empty() || image.labels.empty())
+    return 0;
+
+  Triangulation triangulation(sites);
+  Locator locator(triangulation);
+  using Index = Triangulation::Index;
+
+  double pixelWidth = ((double)bottomright[0] - topleft[0]) / image.width;
+  double pixelHeight = ((double)bottomright[1] - topleft[1]) / image.height;
+  // Sites equally near up to float rounding are both right
+  double slack = EPSILON * std::max({std::fabs(topleft[0]),
+                                     std::fabs(topleft[1]),
+                                     std::fabs(bottomright[0]),
+                                     std::fabs(bottomright[1]), 1.f});
+
+  std::atomic<size_t> errors = 0;
+  JobSystem::get().parallelFor(
+      0, image.height, 8, [&](size_t begin, size_t end) {
+        size_t wrong = 0;
+
+        for (size_t row = begin; row < end; row++) {
+          double py = topleft[1] + (row + 0.5) * pixelHeight;
+          Index nearest = Triangulation::NONE;
+          for (size_t column = 0; column < image.width; column++) {
+            double px = topleft[0] + (column + 0.5) * pixelWidth;
+            auto distance = [&](Index v) {
+              return std::hypot(sites[v][0] - px, sites[v][1] - py);
+            };
+
+            // From the last pixel's site, a step or two away
+            nearest = locator.nearest({(float)px, (float)py}, nearest);
+            double best = distance(nearest);
+
+            uint32_t label = image.labels[row * image.width + column];
+            if (label >= sites.size() || distance(label) > best + slack)
+              wrong++;
+          }
+        }
+
+        errors += wrong;
+      });
+
+  return errors;
+}
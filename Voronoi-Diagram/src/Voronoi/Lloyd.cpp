@@ -0,0 +1,99 @@
+#include "Voronoi/Lloyd.hpp"
+
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+using Index = Triangulation::Index;
+
+struct Moments {
+  double area = 0;
+  // Centroid relative to the site
+  double x = 0, y = 0;
+  // Integral of the squared distance to the site
+  double energy = 0;
+};
+
+// Fan of triangles from the site, in double and relative to it so small
+// cells keep their precision
+Moments Integrate(const Cell &cell, const Vec2 &site) {
+  Moments moments;
+  for (size_t i = 0; i < cell.size(); i++) {
+    const Vec2 &p = cell[i];
+    const Vec2 &q = cell[(i + 1) % cell.size()];
+    double px = (double)p[0] - site[0], py = (double)p[1] - site[1];
+    double qx = (double)q[0] - site[0], qy = (double)q[1] - site[1];
+    double cross = px * qy - qx * py;
+
+    moments.area += cross / 2;
+    moments.x += (px + qx) * cross / 6;
+    moments.y += (py + qy) * cross / 6;
+    moments.energy +=
+        cross / 12 * (px * px + py * py + px * qx + py * qy + qx * qx + qy * qy);
+  }
+
+  if (moments.area > 0) {
+    moments.x /= moments.area;
+    moments.y /= moments.area;
+  }
+  return moments;
+}
+
+} // namespace
+
+LloydIteration LloydStep(Triangulation &triangulation, const Vec2 &topleft,
+                         const Vec2 &bottomright) {
+  Clock::time_point start = Clock::now();
+  size_t n = triangulation.size();
+  std::vector<Moments> moments(n);
+
+  // O(N), every cell is built and integrated on its own
+  JobSystem::get().parallelFor(0, n, 256, [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; v++) {
+      Cell cell = triangulation.cell(v, topleft, bottomright);
+      moments[v] = Integrate(cell, triangulation.site(v));
+    }
+  });
+
+  // Every centroid comes from the old diagram, the moves only change the
+  // triangulation
+  LloydIteration iteration;
+  for (Index v = 0; v < n; v++) {
+    if (moments[v].area <= 0)
+      continue; // removed, duplicated or outside the box
+
+    const Vec2 &site = triangulation.site(v);
+    Vec2 centroid = {(float)(site[0] + moments[v].x),
+                     (float)(site[1] + moments[v].y)};
+    iteration.energy += moments[v].energy;
+    iteration.shift =
+        std::max(iteration.shift, std::hypot(moments[v].x, moments[v].y));
+
+    if (!(centroid == site))
+      triangulation.move(v, centroid);
+  }
+
+  iteration.seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return iteration;
+}
+
+std::vector<LloydIteration> LloydRelax(Triangulation &triangulation,
+                                       const Vec2 &topleft,
+                                       const Vec2 &bottomright,
+                                       double tolerance,
+                                       size_t maxIterations) {
+  std::vector<LloydIteration> iterations;
+  while (iterations.size() < maxIterations) {
+    iterations.push_back(LloydStep(triangulation, topleft, bottomright));
+    if (iterations.back().shift <= tolerance)
+      break;
+  }
+  return iterations;
+}
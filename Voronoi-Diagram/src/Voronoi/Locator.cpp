@@ -0,0 +1,215 @@
+#include "Voronoi/Locator.hpp"
+
+#include "Math/Predicates.hpp"
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Index = Locator::Index;
+using Engine::Math::orient2d;
+
+// Squared distance, less the weight once weighted
+double Power(const Triangulation &triangulation, Index v, const Vec2 &p) {
+  const Vec2 &a = triangulation.site(v);
+  double dx = (double)a[0] - p[0], dy = (double)a[1] - p[1];
+  return dx * dx + dy * dy - triangulation.weight(v);
+}
+
+// The triangle itself, or the one inside the hull next to a ghost
+Index Inside(const Triangulation &triangulation, Index t) {
+  const Triangulation::Triangle &triangle = triangulation.triangles()[t];
+  for (int k = 0; k < 3; k++) {
+    if (triangle.vertices[k] == Triangulation::INFINITE)
+      return triangle.neighbours[k];
+  }
+  return t;
+}
+
+} // namespace
+
+Locator::Locator(const Triangulation &triangulation)
+    : m_triangulation(triangulation) {
+  if (triangulation.triangleCount() == 0) {
+    m_line = triangulation.line();
+    if (m_line.empty())
+      return;
+
+    m_origin = triangulation.site(m_line[0]);
+    m_lineDirection = {0, 0};
+    if (m_line.size() > 1)
+      m_lineDirection = {triangulation.site(m_line[1])[0] - m_origin[0],
+                         triangulation.site(m_line[1])[1] - m_origin[1]};
+    // line() is sorted along the same direction
+    for (Index v : m_line) {
+      const Vec2 &p = triangulation.site(v);
+      m_along.push_back(((double)p[0] - m_origin[0]) * m_lineDirection[0] +
+                        ((double)p[1] - m_origin[1]) * m_lineDirection[1]);
+    }
+    return;
+  }
+
+  Index start = NONE;
+  size_t count = 0;
+  float minX = 0, maxX = 0, minY = 0, maxY = 0;
+  for (Index v = 0; v < triangulation.size(); v++) {
+    if (!triangulation.contains(v))
+      continue;
+    const Vec2 &p = triangulation.site(v);
+    if (count++ == 0) {
+      start = v;
+      minX = maxX = p[0];
+      minY = maxY = p[1];
+    }
+    minX = std::min(minX, p[0]), maxX = std::max(maxX, p[0]);
+    minY = std::min(minY, p[1]), maxY = std::max(maxY, p[1]);
+  }
+
+  // Square buckets of about four sites
+  float width = std::max(maxX - minX, EPSILON);
+  float height = std::max(maxY - minY, EPSILON);
+  double side = std::sqrt((double)width * height * 4 / count);
+  m_columns = std::clamp<double>(std::ceil(width / side), 1, count);
+  m_rows = std::clamp<double>(std::ceil(height / side), 1,
+                              std::max<size_t>(count / m_columns, 1));
+  m_origin = {minX, minY};
+  m_bucketWidth = width / m_columns;
+  m_bucketHeight = height / m_rows;
+
+  // Back and forth along the rows, every walk starts from the seed next to
+  // it. O(N) in total
+  m_seeds.resize((size_t)m_columns * m_rows);
+  Index t = Inside(triangulation, triangulation.triangleAround(start));
+  for (uint32_t row = 0; row < m_rows; row++) {
+    for (uint32_t i = 0; i < m_columns; i++) {
+      uint32_t column = row % 2 ? m_columns - 1 - i : i;
+      Vec2 center = {minX + (column + 0.5f) * m_bucketWidth,
+                     minY + (row + 0.5f) * m_bucketHeight};
+      t = Inside(triangulation, walk(t, center));
+      m_seeds[(size_t)row * m_columns + column] = t;
+    }
+  }
+}
+
+Locator::Index Locator::triangle(const Vec2 &p) const {
+  if (m_seeds.empty())
+    return NONE;
+
+  auto bucket = [](float offset, float size, uint32_t count) {
+    return (uint32_t)std::clamp<float>(std::floor(offset / size), 0,
+                                       count - 1);
+  };
+  uint32_t column = bucket(p[0] - m_origin[0], m_bucketWidth, m_columns);
+  uint32_t row = bucket(p[1] - m_origin[1], m_bucketHeight, m_rows);
+  return walk(m_seeds[(size_t)row * m_columns + column], p);
+}
+
+Locator::Index Locator::nearest(const Vec2 &p, Index hint) const {
+  if (!m_line.empty()) {
+    // O(log(N)), the nearest is next to p's offset. Weights can move it a few
+    // sites further, the power only goes down towards it
+    double along = ((double)p[0] - m_origin[0]) * m_lineDirection[0] +
+                   ((double)p[1] - m_origin[1]) * m_lineDirection[1];
+    size_t i = std::lower_bound(m_along.begin(), m_along.end(), along) -
+               m_along.begin();
+    i = std::min(i, m_line.size() - 1);
+    auto power = [&](size_t k) { return Power(m_triangulation, m_line[k], p); };
+    while (i > 0 && power(i - 1) <= power(i))
+      i--;
+    while (i + 1 < m_line.size() && power(i + 1) < power(i))
+      i++;
+    return m_line[i];
+  }
+
+  if (m_seeds.empty())
+    return NONE;
+
+  if (hint != NONE && hint < m_triangulation.size() &&
+      m_triangulation.contains(hint))
+    return descend(hint, p);
+
+  // The nearest corner of the triangle is close already
+  const Triangulation::Triangle &around =
+      m_triangulation.triangles()[triangle(p)];
+  Index best = NONE;
+  for (Index v : around.vertices) {
+    if (v != Triangulation::INFINITE &&
+        (best == NONE || Power(m_triangulation, v, p) <
+                             Power(m_triangulation, best, p)))
+      best = v;
+  }
+  return descend(best, p);
+}
+
+std::vector<Locator::Index>
+Locator::nearest(const std::vector<Vec2> &points) const {
+  std::vector<Index> result(points.size());
+  JobSystem::get().parallelFor(0, points.size(), 1024,
+                               [&](size_t begin, size_t end) {
+                                 for (size_t i = begin; i < end; i++) {
+                                   result[i] = nearest(points[i]);
+                                 }
+                               });
+  return result;
+}
+
+Locator::Index Locator::walk(Index t, const Vec2 &p) const {
+  const auto &triangles = m_triangulation.triangles();
+
+  // Triangulation::locate without its shared seed, a random first edge per
+  // step keeps the walk from cycling
+  uint32_t seed = 0x9E3779B9;
+  while (!m_triangulation.ghost(t)) {
+    const Triangulation::Triangle &triangle = triangles[t];
+    seed = seed * 1664525u + 1013904223u;
+    int first = (seed >> 16) % 3;
+
+    Index next = NONE;
+    for (int k = 0; k < 3; k++) {
+      int i = (first + k) % 3;
+      if (orient2d(m_triangulation.site(triangle.vertices[(i + 1) % 3]),
+                   m_triangulation.site(triangle.vertices[(i + 2) % 3]),
+                   p) < 0) {
+        next = triangle.neighbours[i];
+        break;
+      }
+    }
+
+    if (next == NONE)
+      return t;
+    t = next;
+  }
+
+  return t;
+}
+
+Locator::Index Locator::descend(Index v, const Vec2 &p) const {
+  const auto &triangles = m_triangulation.triangles();
+
+  // Unless v is the nearest site, one of its Delaunay neighbours is nearer
+  double best = Power(m_triangulation, v, p);
+  for (Index current = NONE; current != v;) {
+    current = v;
+    Index first = m_triangulation.triangleAround(current);
+    Index t = first;
+    do {
+      const Triangulation::Triangle &triangle = triangles[t];
+      int i = triangle.vertices[0] == current   ? 0
+              : triangle.vertices[1] == current ? 1
+                                                : 2;
+      Index u = triangle.vertices[(i + 1) % 3];
+      if (u != Triangulation::INFINITE) {
+        double power = Power(m_triangulation, u, p);
+        if (power < best) {
+          best = power;
+          v = u;
+        }
+      }
+      t = triangle.neighbours[(i + 1) % 3];
+    } while (t != first);
+  }
+
+  return v;
+}
@@ -0,0 +1,919 @@
+#include "Voronoi/Mesh.hpp"
+
+#include "Math/Hull3D.hpp"
+#include "Math/Predicates.hpp"
+#include "Utils/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+using Index = HalfEdgeMesh::Index;
+
+const Index NONE = HalfEdgeMesh::NONE;
+// Label of cell edges on the box, or far outside it, which have no twin
+const Index BOUNDARY = Triangulation::INFINITE;
+
+// A cell vertex and the label of the edge to the next one: the neighbour
+// across it or BOUNDARY. Centers keep the index of their triangle as
+// vertex, the cells around it share it, NONE for the others
+struct Corner {
+  Vec2 p;
+  Index label;
+  Index vertex;
+};
+using Ring = std::vector<Corner>;
+
+// The same bits whichever way the edge is walked, so the cells on both
+// sides of it keep or drop the same pieces
+Vec2 Crossing(const Line &line, const Vec2 &p, const Vec2 &q) {
+  bool swap = q[0] < p[0] || (q[0] == p[0] && q[1] < p[1]);
+  return swap ? Intersect(line, q, p) : Intersect(line, p, q);
+}
+
+// ClipCell keeping the labels, the new edge along the line gets `label`
+void ClipRing(Ring &ring, const Line &line, Index label) {
+  Ring clipped;
+  clipped.reserve(ring.size() + 1);
+
+  for (size_t k = 0; k < ring.size(); ++k) {
+    const Corner &p = ring[k];
+    const Corner &q = ring[(k + 1) % ring.size()];
+
+    bool ppos = IsOnPositiveSide(line, p.p);
+    bool qpos = IsOnPositiveSide(line, q.p);
+
+    if (ppos)
+      clipped.push_back(p);
+    if (ppos != qpos)
+      clipped.push_back(
+          {Crossing(line, p.p, q.p), ppos ? label : p.label, NONE});
+  }
+
+  ring.swap(clipped);
+}
+
+Vec2 Normalize(double x, double y) {
+  double length = std::sqrt(x * x + y * y);
+  return {(float)(x / length), (float)(y / length)};
+}
+
+// Outward unit normal of the hull edge of a ghost triangle, whose finite
+// vertices come after the INFINITE one
+Vec2 GhostNormal(const Triangulation &triangulation, Index t, int &k) {
+  const Triangulation::Triangle &ghost = triangulation.triangles()[t];
+  k = ghost.vertices[0] == Triangulation::INFINITE   ? 0
+      : ghost.vertices[1] == Triangulation::INFINITE ? 1
+                                                     : 2;
+  const Vec2 &x = triangulation.site(ghost.vertices[(k + 1) % 3]);
+  const Vec2 &y = triangulation.site(ghost.vertices[(k + 2) % 3]);
+
+  // The ghost, and infinity, are left of x -> y
+  return Normalize(-((double)y[1] - x[1]), (double)y[0] - x[0]);
+}
+
+// Stands for the center of a ghost triangle: on the bisector of its hull
+// edge, `reach` past the center of the triangle inside, so the ray between
+// them crosses the whole box
+Vec2 FarPoint(const Triangulation &triangulation, Index t, float reach) {
+  int k;
+  Vec2 normal = GhostNormal(triangulation, t, k);
+  const Triangulation::Triangle &ghost = triangulation.triangles()[t];
+  Index a = ghost.vertices[(k + 1) % 3], b = ghost.vertices[(k + 2) % 3];
+  const Vec2 &x = triangulation.site(a);
+  const Vec2 &y = triangulation.site(b);
+  // Where the bisector crosses the edge, off the middle towards the lighter
+  double dx = (double)y[0] - x[0], dy = (double)y[1] - x[1];
+  double shift = ((double)triangulation.weight(a) - triangulation.weight(b)) /
+                 (2 * (dx * dx + dy * dy));
+  Vec2 mid = {(float)(0.5 * ((double)x[0] + y[0]) + shift * dx),
+              (float)(0.5 * ((double)x[1] + y[1]) + shift * dy)};
+
+  Vec2 center = triangulation.center(ghost.neighbours[k]);
+  float ahead =
+      (center[0] - mid[0]) * normal[0] + (center[1] - mid[1]) * normal[1];
+  float distance = std::max(ahead, 0.f) + reach;
+
+  return {mid[0] + normal[0] * distance, mid[1] + normal[1] * distance};
+}
+
+// Calls `visit(t)` for every triangle around v, ghosts included
+template <typename Visit>
+void AroundSite(const Triangulation &triangulation, Index v,
+                const Visit &visit) {
+  Index first = triangulation.triangleAround(v);
+  if (first == NONE)
+    return;
+
+  Index t = first;
+  do {
+    visit(t);
+    const Triangulation::Triangle &triangle = triangulation.triangles()[t];
+    int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+    t = triangle.neighbours[(i + 1) % 3];
+  } while (t != first);
+}
+
+// Every site and the box fit in a square of its side
+struct Bounds {
+  float minX, maxX, minY, maxY;
+
+  Bounds(const Vec2 &topleft, const Vec2 &bottomright)
+      : minX(std::min(topleft[0], bottomright[0])), maxX(minX),
+        minY(std::min(topleft[1], bottomright[1])), maxY(minY) {
+    add(topleft);
+    add(bottomright);
+  }
+
+  void add(const Vec2 &p) {
+    minX = std::min(minX, p[0]), maxX = std::max(maxX, p[0]);
+    minY = std::min(minY, p[1]), maxY = std::max(maxY, p[1]);
+  }
+
+  // Far enough for FarPoint and StarRing
+  float reach() const { return 4 * std::max({maxX - minX, maxY - minY, 1.f}); }
+};
+
+struct Box {
+  Line sides[4];
+
+  Box(const Vec2 &topleft, const Vec2 &bottomright)
+      : sides{{-1, 0, topleft[0]},
+              {1, 0, -bottomright[0]},
+              {0, -1, topleft[1]},
+              {0, 1, -bottomright[1]}} {}
+
+  void clip(Ring &ring) const {
+    // Most cells are inside already
+    bool inside =
+        std::all_of(ring.begin(), ring.end(), [&](const Corner &corner) {
+          return std::all_of(std::begin(sides), std::end(sides),
+                             [&](const Line &side) {
+                               return IsOnPositiveSide(side, corner.p);
+                             });
+        });
+    if (inside)
+      return;
+    for (const Line &side : sides) {
+      ClipRing(ring, side, BOUNDARY);
+    }
+  }
+};
+
+// Unclipped cell of a site, the centers of the triangles around it.
+// Around a hull site the two ghosts stand in with far points, with one more
+// between them so that the edge joining them never crosses the box.
+// `center(t)` is the center of a finite triangle or the far point of a ghost
+template <typename Center>
+Ring StarRing(const Triangulation &triangulation, const Center &center,
+              Index v, float reach) {
+  Ring ring;
+  Index first = triangulation.triangleAround(v);
+  if (first == NONE)
+    return ring; // duplicate or removed
+
+  const auto &triangles = triangulation.triangles();
+  Index t = first;
+  do {
+    const Triangulation::Triangle &triangle = triangles[t];
+    int i = triangle.vertices[0] == v ? 0 : triangle.vertices[1] == v ? 1 : 2;
+    // Shared with the next triangle, INFINITE between the two ghosts
+    Index w = triangle.vertices[(i + 2) % 3];
+    Index next = triangle.neighbours[(i + 1) % 3];
+
+    if (w != Triangulation::INFINITE) {
+      ring.push_back({center(t), w, t});
+    } else {
+      Vec2 far = center(t);
+      ring.push_back({far, BOUNDARY, t});
+
+      int k;
+      Vec2 a = GhostNormal(triangulation, t, k);
+      Vec2 b = GhostNormal(triangulation, next, k);
+      double x = (double)a[0] + b[0], y = (double)a[1] + b[1];
+      // Normals almost opposite on a sliver hull, a turns left to reach b
+      Vec2 out = x * x + y * y > 1e-6 ? Normalize(x, y) : Vec2{-a[1], a[0]};
+      const Vec2 &site = triangulation.site(v);
+      float distance =
+          2 * reach + std::fabs(far[0] - site[0]) + std::fabs(far[1] - site[1]);
+      ring.push_back(
+          {{site[0] + out[0] * distance, site[1] + out[1] * distance},
+           BOUNDARY,
+           NONE});
+    }
+    t = next;
+  } while (t != first);
+
+  return ring;
+}
+
+Index Find(std::vector<Index> &parent, Index v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+// Where cells were clipped they have their own copy of the vertex. Twins see
+// the same vertex from both sides, so their ends are merged, then copies and
+// vertices no edge starts from are dropped
+void Weld(HalfEdgeMesh &mesh) {
+  std::vector<Index> parent(mesh.vertices.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  for (Index e = 0; e < mesh.edges.size(); e++) {
+    Index t = mesh.edges[e].twin;
+    if (t == NONE || t < e)
+      continue;
+
+    Index a = Find(parent, mesh.origin(e)), b = Find(parent, mesh.target(t));
+    parent[std::max(a, b)] = std::min(a, b);
+    a = Find(parent, mesh.origin(t)), b = Find(parent, mesh.target(e));
+    parent[std::max(a, b)] = std::min(a, b);
+  }
+
+  std::vector<Index> remap(parent.size(), NONE);
+  std::vector<Vec2> vertices;
+  for (HalfEdgeMesh::HalfEdge &edge : mesh.edges) {
+    Index root = Find(parent, edge.origin);
+    if (remap[root] == NONE) {
+      remap[root] = vertices.size();
+      vertices.push_back(mesh.vertices[root]);
+    }
+    edge.origin = remap[root];
+  }
+  mesh.vertices.swap(vertices);
+}
+
+// Pairs every half-edge without a twin with one outside the mesh and links
+// those around the boundary
+void CloseBoundary(HalfEdgeMesh &mesh) {
+  size_t inner = mesh.edges.size();
+  std::vector<Index> prev(inner);
+  for (Index e = 0; e < inner; e++) {
+    prev[mesh.edges[e].next] = e;
+  }
+
+  for (Index e = 0; e < inner; e++) {
+    if (mesh.edges[e].twin != NONE)
+      continue;
+    Index outside = mesh.edges.size();
+    mesh.edges.push_back({mesh.target(e), e, NONE, NONE});
+    mesh.edges[e].twin = outside;
+  }
+
+  // Around the origin of its twin, the next half-edge outside. Clockwise
+  // through the faces there until one has no neighbour
+  for (Index o = inner; o < mesh.edges.size(); o++) {
+    Index h = prev[mesh.edges[o].twin];
+    while (mesh.edges[h].twin < inner) {
+      h = prev[mesh.edges[h].twin];
+    }
+    mesh.edges[o].next = mesh.edges[h].twin;
+  }
+}
+
+// Cells of sites no face joins, all on one line or one circle. Each is the
+// box clipped by the bisectors of the sites before and after it, along the
+// line or around the center. The first copy of a site gets its cell, the
+// others none. O(N log(N))
+std::vector<Cell> FlatCells(const std::vector<Vec2> &sites,
+                            const Vec2 &topleft, const Vec2 &bottomright) {
+  std::vector<Cell> cells(sites.size());
+  std::vector<Index> order(sites.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  auto less = [&](Index a, Index b) {
+    return sites[a][0] < sites[b][0] ||
+           (sites[a][0] == sites[b][0] && sites[a][1] < sites[b][1]);
+  };
+  std::stable_sort(order.begin(), order.end(), less);
+  order.erase(std::unique(order.begin(), order.end(),
+                          [&](Index a, Index b) {
+                            return sites[a] == sites[b];
+                          }),
+              order.end());
+  if (order.empty())
+    return cells;
+
+  // Off the line through the extremes, every site is on one circle
+  const Vec2 &first = sites[order.front()];
+  const Vec2 &last = sites[order.back()];
+  auto off = std::find_if(order.begin(), order.end(), [&](Index u) {
+    return Engine::Math::orient2d(first, last, sites[u]) != 0;
+  });
+  bool around = off != order.end();
+
+  // Lexicographic is the order along a line
+  if (around) {
+    Vec2 center = Circumcenter(first, last, sites[*off]);
+    auto angle = [&](Index u) {
+      return std::atan2((double)sites[u][1] - center[1],
+                        (double)sites[u][0] - center[0]);
+    };
+    std::sort(order.begin(), order.end(),
+              [&](Index a, Index b) { return angle(a) < angle(b); });
+  }
+
+  size_t n = order.size();
+  for (size_t i = 0; i < n; i++) {
+    Cell cell = BoxCell(topleft, bottomright);
+    const Vec2 &site = sites[order[i]];
+    if (around || i > 0)
+      ClipCell(cell, TwoPointsBisector(site, sites[order[(i + n - 1) % n]]));
+    if (around || i + 1 < n)
+      ClipCell(cell, TwoPointsBisector(site, sites[order[(i + 1) % n]]));
+    cells[order[i]] = std::move(cell);
+  }
+
+  return cells;
+}
+
+// Half-edges 3t to 3t + 2 and face t of DelaunayMesh, from triangle t
+void WriteTriangle(HalfEdgeMesh &mesh, const Triangulation &triangulation,
+                   Index t) {
+  HalfEdgeMesh::HalfEdge *edges = &mesh.edges[3 * t];
+  for (Index k = 0; k < 3; k++) {
+    edges[k] = {NONE, 3 * t + k, 3 * t + k, NONE};
+  }
+  mesh.faces[t] = NONE;
+  if (!triangulation.alive(t))
+    return;
+
+  // The same edge in the neighbour across, it leaves w
+  const auto &triangles = triangulation.triangles();
+  auto twin = [&](Index n, Index w) {
+    const Triangulation::Triangle &other = triangles[n];
+    Index j = other.vertices[0] == w ? 0 : other.vertices[1] == w ? 1 : 2;
+    return 3 * n + j;
+  };
+
+  // Half-edge k leaves vertices[k], across it is neighbours[k + 2]
+  const Triangulation::Triangle &triangle = triangles[t];
+  if (!triangulation.ghost(t)) {
+    mesh.faces[t] = 3 * t;
+    for (Index k = 0; k < 3; k++) {
+      edges[k] = {triangle.vertices[k],
+                  twin(triangle.neighbours[(k + 2) % 3],
+                       triangle.vertices[(k + 1) % 3]),
+                  3 * t + (k + 1) % 3, t};
+    }
+    return;
+  }
+
+  // The hull edge, after the INFINITE vertex. The next one outside is on
+  // the ghost across its target and INFINITE, and leaves that target
+  Index k = triangle.vertices[0] == Triangulation::INFINITE   ? 1
+            : triangle.vertices[1] == Triangulation::INFINITE ? 2
+                                                              : 0;
+  Index target = triangle.vertices[(k + 1) % 3];
+  edges[k] = {triangle.vertices[k],
+              twin(triangle.neighbours[(k + 2) % 3], target),
+              twin(triangle.neighbours[k], target), NONE};
+}
+
+} // namespace
+
+HalfEdgeMesh DelaunayMesh(const Triangulation &triangulation) {
+  HalfEdgeMesh mesh;
+  mesh.vertices.resize(triangulation.size());
+  for (Index v = 0; v < triangulation.size(); v++) {
+    mesh.vertices[v] = triangulation.site(v);
+  }
+
+  const auto &triangles = triangulation.triangles();
+  if (triangles.empty() || triangulation.triangleCount() == 0) {
+    // Still on a line, a path of edges with nothing inside
+    std::vector<Index> sorted = triangulation.line();
+    for (size_t i = 0; i + 1 < sorted.size(); i++) {
+      Index forward = 2 * i, backward = 2 * i + 1;
+      bool last = i + 2 == sorted.size();
+      mesh.edges.push_back(
+          {sorted[i], backward, last ? backward : forward + 2, NONE});
+      mesh.edges.push_back(
+          {sorted[i + 1], forward, i == 0 ? forward : backward - 2, NONE});
+    }
+    return mesh;
+  }
+
+  mesh.faces.resize(triangles.size());
+  mesh.edges.resize(3 * triangles.size());
+  JobSystem::get().parallelFor(
+      0, triangles.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+          WriteTriangle(mesh, triangulation, t);
+        }
+      });
+  return mesh;
+}
+
+void PatchDelaunayMesh(HalfEdgeMesh &mesh, const Triangulation &triangulation,
+                       MeshChanges &changes) {
+  const auto &triangles = triangulation.triangles();
+  const std::vector<Index> &changed = triangulation.changed();
+
+  // Inserts append a site, even one already there
+  Index sites = mesh.vertices.size();
+  mesh.vertices.resize(triangulation.size());
+  for (Index v = sites; v < mesh.vertices.size(); v++) {
+    mesh.vertices[v] = triangulation.site(v);
+    changes.vertices.push_back(v);
+  }
+  for (Index v : changed) {
+    mesh.vertices[v] = triangulation.site(v);
+    changes.vertices.push_back(v);
+  }
+
+  // Every triangle the edit freed, made or reused, then their neighbours
+  // whose twins point into them
+  std::vector<Index> touched = triangulation.freed();
+  for (Index t = mesh.faces.size(); t < triangles.size(); t++) {
+    touched.push_back(t);
+  }
+  for (Index v : changed) {
+    AroundSite(triangulation, v, [&](Index t) { touched.push_back(t); });
+  }
+  for (size_t k = 0, count = touched.size(); k < count; k++) {
+    Index t = touched[k];
+    if (t >= triangles.size() || !triangulation.alive(t))
+      continue;
+    for (Index n : triangles[t].neighbours) {
+      touched.push_back(n);
+    }
+  }
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+  mesh.faces.resize(triangles.size());
+  mesh.edges.resize(3 * triangles.size());
+  for (Index t : touched) {
+    if (t >= triangles.size())
+      break;
+    WriteTriangle(mesh, triangulation, t);
+    changes.faces.push_back(t);
+    for (Index k = 0; k < 3; k++) {
+      changes.edges.push_back(3 * t + k);
+    }
+  }
+}
+
+HalfEdgeMesh VoronoiMesh(const Triangulation &triangulation,
+                         const Vec2 &topleft, const Vec2 &bottomright) {
+  size_t n = triangulation.size();
+  std::vector<Ring> rings(n);
+  std::vector<Vec2> centers;
+
+  std::vector<Index> sorted = triangulation.line();
+  if (triangulation.triangleCount() == 0) {
+    Cell box = BoxCell(topleft, bottomright);
+    for (size_t i = 0; i < sorted.size(); i++) {
+      Index v = sorted[i];
+      Ring &ring = rings[v];
+      for (const Vec2 &corner : box) {
+        ring.push_back({corner, BOUNDARY, NONE});
+      }
+      if (i > 0)
+        ClipRing(ring, triangulation.bisector(v, sorted[i - 1]), sorted[i - 1]);
+      if (i + 1 < sorted.size())
+        ClipRing(ring, triangulation.bisector(v, sorted[i + 1]), sorted[i + 1]);
+    }
+  } else {
+    Bounds bounds(topleft, bottomright);
+    for (Index v = 0; v < n; v++) {
+      bounds.add(triangulation.site(v));
+    }
+    float reach = bounds.reach();
+
+    // Once per triangle instead of once per cell around it
+    const auto &triangles = triangulation.triangles();
+    centers.resize(triangles.size());
+    JobSystem::get().parallelFor(
+        0, triangles.size(), 1024, [&](size_t begin, size_t end) {
+          for (size_t t = begin; t < end; t++) {
+            if (!triangulation.alive(t))
+              continue;
+            centers[t] = triangulation.ghost(t)
+                             ? FarPoint(triangulation, t, reach)
+                             : triangulation.center(t);
+          }
+        });
+
+    Box box(topleft, bottomright);
+    auto center = [&](Index t) { return centers[t]; };
+    JobSystem::get().parallelFor(0, n, 256, [&](size_t begin, size_t end) {
+      for (size_t v = begin; v < end; v++) {
+        rings[v] = StarRing(triangulation, center, v, reach);
+        box.clip(rings[v]);
+      }
+    });
+  }
+
+  HalfEdgeMesh mesh;
+  mesh.faces.assign(n, NONE);
+  mesh.vertices = std::move(centers);
+  size_t total = 0;
+  for (const Ring &ring : rings) {
+    total += ring.size();
+  }
+  mesh.edges.reserve(2 * total);
+  std::vector<Index> labels;
+  labels.reserve(total);
+
+  for (Index v = 0; v < n; v++) {
+    const Ring &ring = rings[v];
+    if (ring.size() < 3)
+      continue; // removed, or outside the box
+
+    Index start = mesh.edges.size();
+    mesh.faces[v] = start;
+    for (size_t k = 0; k < ring.size(); k++) {
+      Index vertex = ring[k].vertex;
+      if (vertex == NONE) {
+        vertex = mesh.vertices.size();
+        mesh.vertices.push_back(ring[k].p);
+      }
+      Index next = start + (k + 1) % ring.size();
+      mesh.edges.push_back({vertex, NONE, next, v});
+      labels.push_back(ring[k].label);
+    }
+  }
+
+  // The twin of an edge to u is u's edge back, O(degree) per edge
+  JobSystem::get().parallelFor(0, n, 256, [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; v++) {
+      if (mesh.faces[v] == NONE)
+        continue;
+      Index e = mesh.faces[v];
+      do {
+        Index u = labels[e];
+        if (u != BOUNDARY && mesh.faces[u] != NONE) {
+          Index h = mesh.faces[u];
+          do {
+            if (labels[h] == v) {
+              mesh.edges[e].twin = h;
+              break;
+            }
+            h = mesh.edges[h].next;
+          } while (h != mesh.faces[u]);
+        }
+        e = mesh.edges[e].next;
+      } while (e != mesh.faces[v]);
+    }
+  });
+
+  Weld(mesh);
+  CloseBoundary(mesh);
+  return mesh;
+}
+
+void PatchVoronoiMesh(HalfEdgeMesh &mesh, const Triangulation &triangulation,
+                      const Vec2 &topleft, const Vec2 &bottomright,
+                      MeshChanges &changes) {
+  const auto &triangles = triangulation.triangles();
+  std::vector<Index> dirty = triangulation.changed();
+  std::sort(dirty.begin(), dirty.end());
+  dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+  // Position of a changed site in dirty, NONE for the others
+  auto slot = [&](Index v) {
+    auto it = std::lower_bound(dirty.begin(), dirty.end(), v);
+    return it != dirty.end() && *it == v ? (Index)(it - dirty.begin()) : NONE;
+  };
+
+  Index cells = mesh.faces.size();
+  mesh.faces.resize(triangulation.size(), NONE);
+  for (Index v = cells; v < mesh.faces.size(); v++) {
+    changes.faces.push_back(v);
+  }
+
+  // Only the far points around the changed cells have to clear the box
+  Bounds bounds(topleft, bottomright);
+  for (Index v : dirty) {
+    AroundSite(triangulation, v, [&](Index t) {
+      for (Index w : triangles[t].vertices) {
+        if (w != Triangulation::INFINITE)
+          bounds.add(triangulation.site(w));
+      }
+    });
+  }
+  float reach = bounds.reach();
+  auto center = [&](Index t) {
+    return triangulation.ghost(t) ? FarPoint(triangulation, t, reach)
+                                  : triangulation.center(t);
+  };
+
+  Box box(topleft, bottomright);
+  std::vector<Ring> rings(dirty.size());
+  for (size_t i = 0; i < dirty.size(); i++) {
+    rings[i] = StarRing(triangulation, center, dirty[i], reach);
+    box.clip(rings[i]);
+    if (rings[i].size() < 3)
+      rings[i].clear(); // removed, or outside the box
+  }
+
+  // An unchanged cell keeps its edge to a changed one, found while the old
+  // cell is still there to be told apart
+  std::vector<std::vector<Index>> kept(dirty.size());
+  for (size_t i = 0; i < dirty.size(); i++) {
+    kept[i].assign(rings[i].size(), NONE);
+    for (size_t k = 0; k < rings[i].size(); k++) {
+      Index u = rings[i][k].label;
+      if (u == BOUNDARY || u >= cells || slot(u) != NONE ||
+          mesh.faces[u] == NONE)
+        continue;
+      Index h = mesh.faces[u];
+      do {
+        if (mesh.neighbour(h) == dirty[i]) {
+          kept[i][k] = h;
+          break;
+        }
+        h = mesh.next(h);
+      } while (h != mesh.faces[u]);
+    }
+  }
+
+  // The old changed cells and the half-edges outside them become holes.
+  // Unchanged half-edges left without twin get one again below
+  auto hole = [&](Index e) {
+    mesh.edges[e] = {NONE, e, e, NONE};
+    changes.edges.push_back(e);
+  };
+  std::vector<Index> orphans, old;
+  for (Index v : dirty) {
+    changes.faces.push_back(v);
+    if (v >= cells || mesh.faces[v] == NONE)
+      continue;
+    old.clear();
+    Index e = mesh.faces[v];
+    do {
+      old.push_back(e);
+      e = mesh.next(e);
+    } while (e != mesh.faces[v]);
+
+    for (Index e : old) {
+      Index t = mesh.twin(e);
+      if (mesh.face(t) == NONE)
+        hole(t);
+      else if (slot(mesh.face(t)) == NONE)
+        orphans.push_back(t);
+      hole(e);
+    }
+    mesh.faces[v] = NONE;
+  }
+
+  // New vertices from `base` on, those of one triangle shared between the
+  // cells around it. Twins join the rest, towards the older index
+  Index base = mesh.vertices.size();
+  std::vector<Index> parent;
+  std::unordered_map<Index, Index> centerVertex;
+  auto find = [&](Index x) {
+    while (x >= base && parent[x - base] != x) {
+      x = parent[x - base];
+    }
+    return x;
+  };
+  auto join = [&](Index a, Index b) {
+    a = find(a), b = find(b);
+    if (a != b && std::max(a, b) >= base)
+      parent[std::max(a, b) - base] = std::min(a, b);
+  };
+
+  Index first = mesh.edges.size();
+  std::vector<Index> starts(dirty.size(), NONE);
+  for (size_t i = 0; i < dirty.size(); i++) {
+    const Ring &ring = rings[i];
+    if (ring.empty())
+      continue;
+
+    starts[i] = mesh.edges.size();
+    mesh.faces[dirty[i]] = starts[i];
+    for (size_t k = 0; k < ring.size(); k++) {
+      Index t = ring[k].vertex;
+      auto it = centerVertex.find(t);
+      Index vertex = it == centerVertex.end() ? NONE : it->second;
+      if (vertex == NONE) {
+        vertex = mesh.vertices.size();
+        mesh.vertices.push_back(ring[k].p);
+        parent.push_back(vertex);
+        if (t != NONE)
+          centerVertex[t] = vertex;
+      }
+      Index next = starts[i] + (k + 1) % ring.size();
+      mesh.edges.push_back({vertex, NONE, next, dirty[i]});
+    }
+  }
+
+  for (size_t i = 0; i < dirty.size(); i++) {
+    for (size_t k = 0; k < rings[i].size(); k++) {
+      Index e = starts[i] + k;
+      Index h = kept[i][k];
+      Index u = rings[i][k].label;
+      Index j = u == BOUNDARY ? NONE : slot(u);
+      if (h == NONE && j != NONE && starts[j] != NONE &&
+          mesh.twin(e) == NONE) {
+        // Or the edge back from a changed neighbour
+        for (size_t l = 0; l < rings[j].size(); l++) {
+          if (rings[j][l].label == dirty[i])
+            h = starts[j] + l;
+        }
+      }
+      if (h == NONE)
+        continue;
+
+      mesh.edges[e].twin = h;
+      mesh.edges[h].twin = e;
+      changes.edges.push_back(h);
+      join(mesh.origin(e), mesh.target(h));
+      join(mesh.target(e), mesh.origin(h));
+    }
+  }
+
+  // Only the roots of the new vertices stay
+  Index count = base;
+  std::vector<Index> remap(parent.size());
+  for (Index x = base; x < base + parent.size(); x++) {
+    Index root = find(x);
+    if (root == x) {
+      mesh.vertices[count] = mesh.vertices[x];
+      changes.vertices.push_back(count);
+      remap[x - base] = count++;
+    } else {
+      remap[x - base] = root < base ? root : remap[root - base];
+    }
+  }
+  mesh.vertices.resize(count);
+  for (Index e = first; e < mesh.edges.size(); e++) {
+    Index &origin = mesh.edges[e].origin;
+    if (origin >= base)
+      origin = remap[origin - base];
+  }
+
+  // Outside the new edges on the box, and the unchanged ones left alone
+  Index inner = mesh.edges.size();
+  for (Index e = first; e < inner; e++) {
+    if (mesh.twin(e) != NONE)
+      continue;
+    mesh.edges[e].twin = mesh.edges.size();
+    mesh.edges.push_back({mesh.target(e), e, NONE, NONE});
+  }
+  for (Index h : orphans) {
+    if (mesh.twin(mesh.twin(h)) == h)
+      continue;
+    mesh.edges[h].twin = mesh.edges.size();
+    mesh.edges.push_back({mesh.target(h), h, NONE, NONE});
+    changes.edges.push_back(h);
+  }
+
+  // Spliced into the boundary as CloseBoundary does, and the half-edge
+  // outside before each one, new or not, now leads to it
+  auto prev = [&](Index e) {
+    Index p = e;
+    while (mesh.next(p) != e) {
+      p = mesh.next(p);
+    }
+    return p;
+  };
+  for (Index o = inner; o < mesh.edges.size(); o++) {
+    Index h = prev(mesh.twin(o));
+    while (mesh.neighbour(h) != NONE) {
+      h = prev(mesh.twin(h));
+    }
+    mesh.edges[o].next = mesh.twin(h);
+
+    Index j = mesh.next(mesh.twin(o));
+    while (mesh.neighbour(j) != NONE) {
+      j = mesh.next(mesh.twin(j));
+    }
+    mesh.edges[mesh.twin(j)].next = o;
+    changes.edges.push_back(mesh.twin(j));
+  }
+
+  for (Index e = first; e < mesh.edges.size(); e++) {
+    changes.edges.push_back(e);
+  }
+}
+
+HalfEdgeMesh LiftedDelaunayMesh(const std::vector<Vec2> &sites) {
+  HalfEdgeMesh mesh;
+  mesh.vertices = sites;
+
+  Engine::Math::Hull3D hull = Engine::Math::LiftedHull(sites);
+  if (hull.edges.empty())
+    return mesh;
+
+  // Seen from below the lower faces turn counter-clockwise, so their sites
+  // turn clockwise. The vertical ones over collinear hull sites are neither
+  std::vector<Index> faceOf(hull.faces(), NONE);
+  for (Index f = 0; f < hull.faces(); f++) {
+    const Vec2 &a = sites[hull.origin(3 * f)];
+    const Vec2 &b = sites[hull.origin(3 * f + 1)];
+    const Vec2 &c = sites[hull.origin(3 * f + 2)];
+    if (Engine::Math::orient2d(a, b, c) < 0) {
+      faceOf[f] = mesh.faces.size();
+      mesh.faces.push_back(3 * faceOf[f]);
+    }
+  }
+
+  // Turned around: half-edge k of a face is the hull one 2 - k the other way
+  // and its twin the twin of that one, turned around too
+  mesh.edges.resize(3 * mesh.faces.size());
+  for (Index f = 0; f < hull.faces(); f++) {
+    Index face = faceOf[f];
+    if (face == NONE)
+      continue;
+
+    for (Index k = 0; k < 3; k++) {
+      HalfEdgeMesh::HalfEdge &edge = mesh.edges[3 * face + k];
+      Index reversed = 3 * f + 2 - k;
+      edge.origin = hull.target(reversed);
+      edge.next = 3 * face + (k + 1) % 3;
+      edge.face = face;
+
+      Index t = hull.twin(reversed);
+      Index other = faceOf[Engine::Math::Hull3D::face(t)];
+      edge.twin = other == NONE ? NONE : 3 * other + 2 - t % 3;
+    }
+  }
+
+  CloseBoundary(mesh);
+  return mesh;
+}
+
+std::vector<Cell> MeshVoronoi(const HalfEdgeMesh &delaunay,
+                              const Vec2 &topleft, const Vec2 &bottomright) {
+  if (delaunay.faces.empty())
+    return FlatCells(delaunay.vertices, topleft, bottomright);
+
+  std::vector<Cell> cells(delaunay.vertices.size());
+
+  // One half-edge leaving each vertex, NONE for those left out
+  std::vector<Index> leaving(delaunay.vertices.size(), NONE);
+  for (Index e = 0; e < delaunay.edges.size(); e++) {
+    if (!delaunay.hole(e))
+      leaving[delaunay.origin(e)] = e;
+  }
+
+  std::vector<Vec2> centers(delaunay.faces.size());
+  JobSystem::get().parallelFor(
+      0, centers.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; f++) {
+          Index e = delaunay.faces[f];
+          if (e == NONE)
+            continue;
+          const std::vector<Vec2> &sites = delaunay.vertices;
+          centers[f] = Circumcenter(sites[delaunay.origin(e)],
+                                    sites[delaunay.target(e)],
+                                    sites[delaunay.target(delaunay.next(e))]);
+        }
+      });
+
+  const Line sides[4] = {{-1, 0, topleft[0]},
+                         {1, 0, -bottomright[0]},
+                         {0, -1, topleft[1]},
+                         {0, 1, -bottomright[1]}};
+
+  JobSystem::get().parallelFor(
+      0, cells.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+          if (leaving[v] == NONE)
+            continue;
+
+          // Clockwise around v through every half-edge leaving it
+          Cell ring;
+          bool boundary = false;
+          Index e = leaving[v];
+          do {
+            if (delaunay.face(e) == NONE)
+              boundary = true;
+            else
+              ring.push_back(centers[delaunay.face(e)]);
+            e = delaunay.next(delaunay.twin(e));
+          } while (e != leaving[v]);
+
+          if (boundary) {
+            // Unbounded, only the Delaunay neighbours can bound it
+            Cell cell = BoxCell(topleft, bottomright);
+            const Vec2 &site = delaunay.vertices[v];
+            do {
+              const Vec2 &neighbour = delaunay.vertices[delaunay.target(e)];
+              ClipCell(cell, TwoPointsBisector(site, neighbour));
+              e = delaunay.next(delaunay.twin(e));
+            } while (e != leaving[v]);
+            cells[v] = std::move(cell);
+            continue;
+          }
+
+          std::reverse(ring.begin(), ring.end());
+          for (const Line &side : sides) {
+            ClipCell(ring, side);
+          }
+          // Cocircular sites share a center
+          RemoveNearDuplicates(ring);
+          cells[v] = std::move(ring);
+        }
+      });
+
+  return cells;
+}
@@ -1,414 +1,427 @@
 #include "GLFW/glfw3.h"
-#include "Wrappers/Line.hpp"
+#include "Math/Predicates.hpp"
+#include "Voronoi/Bench.hpp"
+#include "Voronoi/Coloring.hpp"
+#include "Voronoi/Delaunay.hpp"
+#include "Voronoi/Geometry.hpp"
+#include "Voronoi/JumpFlood.hpp"
+#include "Voronoi/Lloyd.hpp"
+#include "Voronoi/Locator.hpp"
+#include "Voronoi/Mesh.hpp"
+#include "Utils/Pipeline.hpp"
 #include "Wrappers/Point.hpp"
-#include "Wrappers/Poly.hpp"
 #include "engine.hpp"
 #include "window.hpp"
 #include <algorithm>
-#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
-#include <map>
-#include <random>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
-using Vec2 = Engine::Math::Vector<2>;
-using Line = Engine::Math::Vector<3>;
-using Cell = std::vector<Vec2>;
-
-const float EPSILON = 1e-18f;
-
-struct DelaunayEdge {
-  Vec2 p1;
-  Vec2 p2;
-};
+struct MyWindow : public Engine::Window {
+  MyWindow() {
+    // Away from the lines, the points and the black background
+    m_palette = LabPalette(PALETTE_SIZE, m_colorSeed,
+                           {DELAUNAY_COLOR, VORONOI_COLOR, POINT_COLOR,
+                            {0, 0, 0}});
 
-struct PairHasher {
-  template <class T1, class T2>
-  std::size_t operator()(const std::pair<T1, T2> &p) const {
-    auto h1 = std::hash<T1>{}(p.first);
-    auto h2 = std::hash<T2>{}(p.second);
+    m_state.addHeader("pointsAmount");
+    m_state.addHeader("voronoiTime");
+    m_state.addHeader("delaunayTime");
+    m_state.addHeader("M");
+    m_state.addHeader("exactRate");
+    m_state.addHeader("energy");
+    m_state.addHeader("shift");
+    m_state.addHeader("latency");
 
-    return h1 ^ (h2 << 1);
+    m_state.get("pointsAmount") = 0u;
+    m_state.get("M") = 0u;
+    m_state.get("voronoiTime") = (double)0;
+    m_state.get("delaunayTime") = (double)0;
+    m_state.get("exactRate") = (double)0;
+    m_state.get("energy") = (double)0;
+    m_state.get("shift") = (double)0;
+    m_state.get("latency") = (double)0;
+
+    addSite({200, 200});
+    addSite({800, 800});
+    addSite({500, 920});
   }
-};
 
-inline Line RgbToXyz(const Line &rgb) {
-  auto linearize = [](float value) {
-    if (value > 0.04045f) {
-      return powf((value + 0.055f) / 1.055f, 2.4f);
-    }
-    return value / 12.92f;
+  // Render objects of one site, the cells and edges are in the meshes
+  struct Site {
+    std::optional<Engine::Point> point;
   };
 
-  float r = linearize(rgb[0]);
-  float g = linearize(rgb[1]);
-  float b = linearize(rgb[2]);
-
-  float x = r * 0.4124f + g * 0.3576f + b * 0.1805f;
-  float y = r * 0.2126f + g * 0.7152f + b * 0.0722f;
-  float z = r * 0.0193f + g * 0.1192f + b * 0.9505f;
+  // Built in the background from a copy of the triangulation, the partial
+  // result only has the Delaunay mesh
+  struct Meshes {
+    HalfEdgeMesh delaunay;
+    HalfEdgeMesh voronoi;
+    double voronoiSeconds = 0;
+  };
 
-  return {x, y, z};
-}
+  const float POINT_RADIUS = 12;
+  const float LINE_STOKE = 2;
 
-inline Line XyzToLab(const Line &xyz) {
-  const float ref_x = 0.95047f;
-  const float ref_y = 1.00000f;
-  const float ref_z = 1.08883f;
+  const Line DELAUNAY_COLOR = {0, 0, 1};
+  const Line VORONOI_COLOR = {1, 1, 1};
+  const Line POINT_COLOR = {1, 0, 0};
 
-  float x = xyz[0] / ref_x;
-  float y = xyz[1] / ref_y;
-  float z = xyz[2] / ref_z;
+  // Six colors always suffice for the planar Delaunay graph, the spare ones
+  // leave room when edits recolor a site among many neighbours
+  const size_t PALETTE_SIZE = 12;
+
+  // Lloyd iterations stop once no site moves further, in pixels
+  const double RELAX_TOLERANCE = 0.05;
+
+  // Edits changing more cells than this share of the sites are rebuilt
+  // instead of patched
+  const double PATCH_SHARE = 0.25;
+
+  Triangulation m_triangulation;
+  // Finds the site under a right click. Dropped by every edit, built again
+  // by the next click
+  std::optional<Locator> m_locator;
+  // Indexed by triangulation vertex, removed sites keep their slot
+  std::vector<Site> m_sites;
+  std::vector<Line> m_palette;
+  // Palette index per site, distinct between Delaunay neighbours
+  std::vector<uint8_t> m_colors;
+  uint32_t m_colorSeed = 1;
+  std::unordered_map<Engine::Objects::ObjectUUID::UUID, Triangulation::Index>
+      m_pointSites;
+  std::vector<Triangulation::Index> m_dirty;
+  HalfEdgeMesh m_voronoi;
+  HalfEdgeMesh m_delaunay;
+  // Fill of every Voronoi face, the color of its site
+  std::vector<Line> m_faceColors;
+  uint32_t m_voronoiMesh = 0;
+  uint32_t m_delaunayMesh = 0;
+  // Set once the meshes miss an edit that could not be patched in, the
+  // next update rebuilds them in the background
+  bool m_stale = true;
+  // Entries written by the patches since the last upload, unless the next
+  // one is of whole meshes
+  MeshChanges m_delaunayChanges;
+  MeshChanges m_voronoiChanges;
+  bool m_uploadAll = false;
+  // Half-edges of the last rebuilt Voronoi mesh, patches leave holes
+  size_t m_builtEdges = 0;
+  double m_meshTime = 0;
+  size_t m_siteCount = 0;
+  double m_editTime = 0;
+  bool m_relaxing = false;
+  // Cells as a jump flooded background image instead of polygons
+  bool m_raster = false;
+  bool m_rasterDirty = false;
+  Engine::Math::PredicateStats m_predicates;
+  Pipeline<Meshes> m_pipeline;
 
-  auto f = [](float t) {
-    if (t > 0.008856f) { // (6/29)^3
-      return cbrtf(t);
+  void update(double dt) override {
+    m_state.get("delaunayTime") = (double)0;
+    m_state.get("energy") = (double)0;
+    m_state.get("shift") = (double)0;
+
+    if (m_relaxing)
+      relax();
+
+    // Only the edited sites and their neighbours can clash
+    std::sort(m_dirty.begin(), m_dirty.end());
+    m_dirty.erase(std::unique(m_dirty.begin(), m_dirty.end()), m_dirty.end());
+    RepairColors(m_triangulation, m_colors, m_dirty, m_palette.size());
+
+    double rasterTime = 0;
+    if (m_raster && (m_rasterDirty || !m_dirty.empty()))
+      rasterTime = rasterize();
+    m_rasterDirty = false;
+    m_state.get("voronoiTime") = rasterTime;
+
+    // Patched edits are already in the meshes. Others cancel the meshes
+    // being built, relaxing waits for them instead so that every iteration
+    // is not cancelled by the next
+    if (!m_dirty.empty() && (!m_relaxing || !m_pipeline.busy())) {
+      std::get<2>(m_state.get("pointsAmount")) = m_siteCount;
+      m_state.get("M") = (uint32_t)m_dirty.size();
+      m_state.get("delaunayTime") = m_editTime;
+
+      if (m_stale)
+        submitMeshes();
+
+      m_dirty.clear();
+      m_editTime = 0;
     }
-    return (7.787f * t) + (16.0f / 116.0f);
-  };
-
-  float fx = f(x);
-  float fy = f(y);
-  float fz = f(z);
 
-  float l = (116.0f * fy) - 16.0f;
-  float a = 500.0f * (fx - fy);
-  float b = 200.0f * (fy - fz);
+    receiveMeshes();
+    m_state.get("voronoiTime") = rasterTime + m_meshTime;
+    m_meshTime = 0;
+    upload();
+  }
 
-  return {l, a, b};
-}
+private:
+  // The Delaunay mesh is shown as soon as it is ready, the cells replace the
+  // old ones once all are clipped
+  void submitMeshes() {
+    Vec2 size = {(float)m_engine->winSize()[0], (float)m_engine->winSize()[1]};
+    m_pipeline.submit([triangulation = m_triangulation,
+                       size](Pipeline<Meshes>::Task &task) {
+      Meshes meshes;
+      meshes.delaunay = DelaunayMesh(triangulation);
+      task.publish(meshes);
+      task.checkpoint();
 
-inline float CalculateColorDifference(const Line &rgb1, const Line &rgb2) {
-  Line lab1 = XyzToLab(RgbToXyz(rgb1));
-  Line lab2 = XyzToLab(RgbToXyz(rgb2));
+      Clock::time_point start = Clock::now();
+      meshes.voronoi = VoronoiMesh(triangulation, {0, 0}, size);
+      meshes.voronoiSeconds =
+          std::chrono::duration<double>(Clock::now() - start).count();
+      return meshes;
+    });
+    m_stale = false;
+  }
 
-  float deltaL = lab1[0] - lab2[0];
-  float deltaA = lab1[1] - lab2[1];
-  float deltaB = lab1[2] - lab2[2];
+  void receiveMeshes() {
+    std::optional<Pipeline<Meshes>::Output> output = m_pipeline.poll();
+    if (!output)
+      return;
+
+    m_delaunay = std::move(output->result.delaunay);
+    m_uploadAll = true;
+    if (output->complete) {
+      m_voronoi = std::move(output->result.voronoi);
+      m_builtEdges = m_voronoi.edges.size();
+      m_meshTime += output->result.voronoiSeconds;
+      m_state.get("latency") = output->latency;
+
+      // Share of the predicates since the last meshes that needed exact
+      // arithmetic
+      Engine::Math::PredicateStats predicates = Engine::Math::predicateStats();
+      Engine::Math::PredicateStats delta = {
+          predicates.calls - m_predicates.calls,
+          predicates.exact - m_predicates.exact};
+      m_state.get("exactRate") = delta.fallbackRate();
+      m_predicates = predicates;
+    }
+  }
 
-  return sqrtf(deltaL * deltaL + deltaA * deltaA + deltaB * deltaB);
-}
+  // Brings both meshes up to date with the edit just made, only the cells
+  // and triangles it changed. Left to a rebuild while one is running, when
+  // a rebuild is due anyway or when the edit changed too many cells
+  void patchMeshes() {
+    // Asked first: once idle, a finished rebuild is there to be polled
+    bool idle = !m_pipeline.busy();
+    receiveMeshes();
+    size_t changed = m_triangulation.changed().size();
+    if (m_stale || !idle || m_relaxing || m_delaunay.faces.empty() ||
+        m_triangulation.triangleCount() == 0 ||
+        changed > PATCH_SHARE * m_siteCount) {
+      m_stale = true;
+      return;
+    }
 
-inline Line RandomColor(Line avoid, float diff) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  static std::uniform_real_distribution<float> distrib(0.0f, 1.0f);
+    Vec2 size = {(float)m_engine->winSize()[0], (float)m_engine->winSize()[1]};
+    Clock::time_point start = Clock::now();
+    PatchDelaunayMesh(m_delaunay, m_triangulation, m_delaunayChanges);
+    PatchVoronoiMesh(m_voronoi, m_triangulation, {0, 0}, size,
+                     m_voronoiChanges);
+    m_meshTime += std::chrono::duration<double>(Clock::now() - start).count();
 
-  Line color = {distrib(gen), distrib(gen), distrib(gen)};
-  do {
-    color = {distrib(gen), distrib(gen), distrib(gen)};
-  } while (CalculateColorDifference(color, avoid) < diff);
+    // A rebuild drops the holes once they are half the mesh
+    if (m_voronoi.edges.size() > 2 * m_builtEdges)
+      m_stale = true;
+  }
 
-  return color;
-}
+  void addSite(const Vec2 &pos) {
+    Clock::time_point start = Clock::now();
+    Triangulation::Index v = m_triangulation.insert(pos);
+    m_editTime += std::chrono::duration<double>(Clock::now() - start).count();
 
-inline bool IsClose(Vec2 a, Vec2 b, float eps = EPSILON) {
-  return std::fabs(a[0] - b[0]) <= eps * std::max(1.f, std::fabs(a[0])) &&
-         std::fabs(a[1] - b[1]) <= eps * std::max(1.f, std::fabs(a[1]));
-}
+    if (v < m_sites.size())
+      return; // already a site there
+    m_locator.reset();
 
-inline Line TwoPointsBisector(Vec2 a, Vec2 b) {
-  Vec2 n{b[0] - a[0], b[1] - a[1]};
-  float c = 0.5f * (n[0] * (b[0] + a[0]) + n[1] * (b[1] + a[1]));
+    Site &site = m_sites.emplace_back();
+    site.point.emplace(m_engine->createPoint(pos, POINT_COLOR, POINT_RADIUS));
+    m_pointSites[site.point->getID()] = v;
+    m_siteCount++;
 
-  // line: n.x*x + n.y*y = c  →  n.x*x + n.y*y - c = 0
-  return {n[0], n[1], -c}; // store Ax + By + C = 0
-}
+    const auto &changed = m_triangulation.changed();
+    m_dirty.insert(m_dirty.end(), changed.begin(), changed.end());
+    patchMeshes();
+  }
 
-inline bool Intersects(const Line &line, const Vec2 &p, const Vec2 &q,
-                       float eps = 1e-8f) {
-  float lp = line[0] * p[0] + line[1] * p[1] + line[2];
-  float lq = line[0] * q[0] + line[1] * q[1] + line[2];
-  return (lp < -eps && lq > eps) || (lp > eps && lq < -eps);
-}
+  void removeSite(Triangulation::Index v) {
+    Clock::time_point start = Clock::now();
+    bool removed = m_triangulation.remove(v);
+    m_editTime += std::chrono::duration<double>(Clock::now() - start).count();
 
-inline Vec2 Intersect(const Line &line, const Vec2 &p, const Vec2 &q) {
-  // solve parametric intersection of segment pq with line
-  float dp = line[0] * p[0] + line[1] * p[1] + line[2];
-  float dq = line[0] * q[0] + line[1] * q[1] + line[2];
-  float t = dp / (dp - dq);
-  return {p[0] + t * (q[0] - p[0]), p[1] + t * (q[1] - p[1])};
-}
+    if (!removed)
+      return;
+    m_locator.reset();
 
-inline bool IsOnPositiveSide(const Line &line, const Vec2 &p) {
-  return (line[0] * p[0] + line[1] * p[1] + line[2]) <= 0.f;
-}
+    Site &site = m_sites[v];
+    m_pointSites.erase(site.point->getID());
+    m_engine->remove(site.point->getID());
+    site.point.reset();
+    m_siteCount--;
 
-void RemoveNearDuplicates(std::vector<Vec2> &poly, float eps = EPSILON) {
-  if (poly.size() < 2)
-    return;
-  std::vector<Vec2> cleaned;
-  cleaned.push_back(poly[0]);
-  for (size_t i = 1; i < poly.size(); ++i) {
-    if (!IsClose(poly[i], cleaned.back(), eps)) {
-      cleaned.push_back(poly[i]);
-    }
-  }
-  // Check first and last
-  if (cleaned.size() > 1 && IsClose(cleaned.front(), cleaned.back(), eps)) {
-    cleaned.pop_back();
+    const auto &changed = m_triangulation.changed();
+    m_dirty.insert(m_dirty.end(), changed.begin(), changed.end());
+    patchMeshes();
   }
-  poly = std::move(cleaned);
-}
 
-// Sorts and Removes Duplicates
-// O(N log(N) + N)
-void CleanSites(std::vector<Vec2> &sites) {
-  // O(N log(N))
-  std::sort(sites.begin(), sites.end(), [](const Vec2 &a, const Vec2 &b) {
-    return (a[0] < b[0]) || (a[0] == b[0] && a[1] < b[1]);
-  });
-
-  // O(N)
-  auto last =
-      std::unique(sites.begin(), sites.end(),
-                  [](const Vec2 &a, const Vec2 &b) { return IsClose(a, b); });
-
-  // O(1) erasure from the back is just size -= amount;
-  sites.erase(last, sites.end());
-}
-
-// Brute-Force Intersection of Half-Planes
-//
-// "Computational Geometry: Algorithms and Applications" Chapter 7 by
-//  Prof. Dr. Mark de Berg, Dr. Otfried Cheong, Dr. Marc van Kreveld, Prof. Dr.
-//  Mark Overmars
-//
-// O(N * (N - 1) * (N - 1)) -> O(N³)
-std::vector<std::vector<Vec2>> ComputeVoronoi(std::vector<Vec2> &input_sites,
-                                              const Vec2 &topleft,
-                                              const Vec2 &bottomright,
-                                              uint32_t &m) {
-  std::vector<Vec2> &sites = input_sites;
-  std::vector<Vec2> box = {{topleft[0], topleft[1]},
-                           {bottomright[0], topleft[1]},
-                           {bottomright[0], bottomright[1]},
-                           {topleft[0], bottomright[1]}};
-
-  std::vector<std::vector<Vec2>> cells;
-  cells.reserve(sites.size());
-
-  m = 0;
-  // O(N)
-  for (size_t i = 0; i < sites.size(); ++i) {
-    std::vector<Vec2> cell = box;
-
-    // O(N - 1)
-    for (size_t j = 0; j < sites.size(); ++j) {
-      // -1 from O(N - 1)
-      if (i == j)
+  // One Lloyd iteration per frame, every site moves
+  void relax() {
+    Vec2 size = {(float)m_engine->winSize()[0], (float)m_engine->winSize()[1]};
+    LloydIteration iteration = LloydStep(m_triangulation, {0, 0}, size);
+    m_locator.reset();
+    m_editTime += iteration.seconds;
+    m_state.get("energy") = iteration.energy;
+    m_state.get("shift") = iteration.shift;
+
+    for (Triangulation::Index v = 0; v < m_sites.size(); v++) {
+      Site &site = m_sites[v];
+      if (!site.point)
         continue;
 
-      Line bisector = TwoPointsBisector(sites[i], sites[j]);
-      if (std::isnan(bisector[2]))
-        continue; // skip degenerate
-
-      std::vector<Vec2> new_cell;
-      new_cell.reserve(cell.size());
-
-      // O(M) where M = vertices in polygon can be at worst N - 1
-      // so O(N - 1)
-      m += cell.size();
-      for (size_t k = 0; k < cell.size(); ++k) {
-        size_t nk = (k + 1) % cell.size();
-        const Vec2 &p = cell[k];
-        const Vec2 &q = cell[nk];
-
-        bool ppos = IsOnPositiveSide(bisector, p);
-        bool qpos = IsOnPositiveSide(bisector, q);
-
-        if (ppos)
-          new_cell.push_back(p);
-        if (ppos != qpos) {
-          new_cell.push_back(Intersect(bisector, p, q));
-        }
+      if (m_triangulation.contains(v)) {
+        site.point->setPos(m_triangulation.site(v));
+      } else {
+        // Landed on another site
+        m_pointSites.erase(site.point->getID());
+        m_engine->remove(site.point->getID());
+        site.point.reset();
+        m_siteCount--;
       }
-
-      cell.swap(new_cell);
-
-      // Not a polygon
-      if (cell.size() < 3)
-        break;
+      m_dirty.push_back(v);
     }
+    m_stale = true;
 
-    cells.push_back(std::move(cell)); // may be empty
+    if (iteration.shift <= RELAX_TOLERANCE)
+      m_relaxing = false;
   }
 
-  return cells;
-}
-
-// "Computational Geometry: Algorithms and Applications" Chapter 9 by
-//  Prof. Dr. Mark de Berg, Dr. Otfried Cheong, Dr. Marc van Kreveld, Prof. Dr.
-//  Mark Overmars
-//
-// O(N² + N) -> O(N²)
-std::vector<DelaunayEdge>
-ComputeDelaunay(const std::vector<Vec2> &sites,
-                const std::vector<std::vector<Vec2>> &voronoi_cells) {
-
-  std::vector<DelaunayEdge> delaunay_edges;
-
-  std::vector<Vec2> unique_vertices;
-  std::map<std::pair<size_t, size_t>, int> vertex_map;
-
-  // O(N) where N = voronoi vertices
-  for (size_t i = 0; i < voronoi_cells.size(); ++i) {
-    for (size_t j = 0; j < voronoi_cells[i].size(); ++j) {
-      const Vec2 &v = voronoi_cells[i][j];
-      int unified_idx = -1;
-
-      // O(N) Linear search
-      for (size_t k = 0; k < unique_vertices.size(); ++k) {
-        if (IsClose(v, unique_vertices[k], 1e-4f)) { // Use a larger tolerance
-          unified_idx = k;
-          break;
-        }
-      }
-
-      // If no close vertex was found, add this one as a new unique vertex
-      if (unified_idx == -1) {
-        unified_idx = unique_vertices.size();
-        unique_vertices.push_back(v);
+  // Nearest site of every pixel, coloured like its cell. Returns the seconds
+  // the flood took
+  double rasterize() {
+    Engine::Math::Vector<2, uint32_t> size = m_engine->winSize();
+    std::vector<Vec2> sites;
+    std::vector<Triangulation::Index> owners;
+    for (Triangulation::Index v = 0; v < m_sites.size(); v++) {
+      if (m_triangulation.contains(v)) {
+        sites.push_back(m_triangulation.site(v));
+        owners.push_back(v);
       }
-      vertex_map[{i, j}] = unified_idx;
     }
-  }
 
-  // Finding shared edges using integer indices
-  // Key is a pair of unified vertex indices, value is the site index
-  std::unordered_map<std::pair<size_t, size_t>, size_t, PairHasher>
-      edge_to_site_map;
-
-  // O(N) where N = voronoi vertices
-  for (size_t i = 0; i < voronoi_cells.size(); ++i) {
-    const auto &cell = voronoi_cells[i];
-    if (cell.size() < 2)
-      continue;
-    for (size_t j = 0; j < cell.size(); ++j) {
-      int idx1 = vertex_map.at({i, j});
-      int idx2 = vertex_map.at({i, (j + 1) % cell.size()});
-
-      std::pair<int, int> edge_key = {std::min(idx1, idx2),
-                                      std::max(idx1, idx2)};
-
-      if (edge_to_site_map.count(edge_key)) {
-        size_t other_site_idx = edge_to_site_map[edge_key];
-        delaunay_edges.push_back({sites[i], sites[other_site_idx]});
-        edge_to_site_map.erase(edge_key);
-      } else {
-        edge_to_site_map[edge_key] = i;
+    Clock::time_point start = Clock::now();
+    LabelImage image =
+        JumpFlood(sites, {0, 0}, {(float)size[0], (float)size[1]}, size[0],
+                  size[1]);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint8_t> rgba(image.labels.size() * 4, 0);
+    for (size_t p = 0; p < image.labels.size(); p++) {
+      if (image.labels[p] == LabelImage::NO_SITE)
+        continue;
+      const Line &color = m_palette[m_colors[owners[image.labels[p]]]];
+      for (int c = 0; c < 3; c++) {
+        rgba[4 * p + c] = (uint8_t)(color[c] * 255);
       }
+      rgba[4 * p + 3] = 255;
     }
+    m_engine->setBackground(rgba.data(), image.width, image.height);
+    return seconds;
   }
 
-  return delaunay_edges;
-}
-
-struct MyWindow : public Engine::Window {
-  MyWindow()
-      : points({
-            {{200, 200}, DELAUNAY_COLOR},
-            {{800, 800}, DELAUNAY_COLOR},
-            {{500, 920}, DELAUNAY_COLOR},
-        }) {
-    m_state.addHeader("pointsAmount");
-    m_state.addHeader("voronoiTime");
-    m_state.addHeader("delaunayTime");
-    m_state.addHeader("M");
-
-    m_state.get("pointsAmount") = 0u;
-    m_state.get("M") = 0u;
-    m_state.get("voronoiTime") = (double)0;
-    m_state.get("delaunayTime") = (double)0;
+  // Sorted runs of the entries a patch wrote, which it clears
+  static std::vector<Engine::Objects::MeshRange>
+  Runs(std::vector<HalfEdgeMesh::Index> &entries) {
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    std::vector<Engine::Objects::MeshRange> runs;
+    for (HalfEdgeMesh::Index i : entries) {
+      if (!runs.empty() && runs.back().end == i)
+        runs.back().end++;
+      else
+        runs.push_back({i, i + 1});
+    }
+    entries.clear();
+    return runs;
   }
 
-  struct Point {
-    Vec2 pos;
-    Line color;
-
-    Point(Vec2 pos, Line avoid) : pos(pos), color(RandomColor(avoid, 20)) {}
-  };
-
-  const float POINT_RADIUS = 12;
-  const float LINE_STOKE = 2;
-
-  const Line DELAUNAY_COLOR = {0, 0, 1};
-  const Line VORONOI_COLOR = {1, 1, 1};
-  const Line POINT_COLOR = {1, 0, 0};
-
-  std::vector<Engine::Point> m_points;
-  std::vector<Engine::Line> m_lines;
-  std::vector<Engine::Poly> m_polys;
-  std::vector<Point> points;
-  bool refresh = true;
-
-  void update(double dt) override {
-    m_state.get("voronoiTime") = (double)0;
-    m_state.get("delaunayTime") = (double)0;
-
-    if (refresh) {
-      m_engine->clear();
-
-      std::vector<Vec2> sites;
-      sites.reserve(points.size());
-      for (auto &p : points) {
-        m_points.emplace_back(
-            std::move(m_engine->createPoint(p.pos, POINT_COLOR, POINT_RADIUS)));
-        sites.push_back(p.pos);
+  // Both meshes straight from their arrays, two draws each instead of a
+  // polygon and its lines per cell. After patches only the entries they
+  // wrote are uploaded
+  void upload() {
+    static_assert(sizeof(HalfEdgeMesh::HalfEdge) == 4 * sizeof(uint32_t));
+
+    if (!m_uploadAll && m_voronoiChanges.faces.empty() &&
+        m_delaunayChanges.faces.empty())
+      return;
+
+    m_faceColors.resize(m_voronoi.faces.size());
+    auto paint = [&](Triangulation::Index v) {
+      if (m_voronoi.faces[v] != HalfEdgeMesh::NONE)
+        m_faceColors[v] = m_palette[m_colors[v]];
+    };
+    if (m_uploadAll) {
+      for (Triangulation::Index v = 0; v < m_faceColors.size(); v++) {
+        paint(v);
       }
-
-      std::sort(points.begin(), points.end(),
-                [](const Point &a, const Point &b) {
-                  return (a.pos[0] < b.pos[0]) ||
-                         (a.pos[0] == b.pos[0] && a.pos[1] < b.pos[1]);
-                });
-      CleanSites(sites);
-
-      std::get<2>(m_state.get("pointsAmount")) = sites.size();
-      uint32_t m = 0;
-      Clock::time_point start = Clock::now();
-      auto my_diagram = ComputeVoronoi(
-          sites, {0, 0},
-          {(float)m_engine->winSize()[0], (float)m_engine->winSize()[1]}, m);
-
-      Clock::time_point end = Clock::now();
-      m_state.get("M") = m;
-      double dur = std::chrono::duration<double>(end - start).count();
-      m_state.get("voronoiTime") = dur;
-
-      start = Clock::now();
-      auto delaunay = ComputeDelaunay(sites, my_diagram);
-      end = Clock::now();
-      dur = std::chrono::duration<double>(end - start).count();
-      m_state.get("delaunayTime") = dur;
-
-      for (auto &edge : delaunay) {
-        m_lines.emplace_back(std::move(m_engine->createLine(
-            edge.p1, edge.p2, DELAUNAY_COLOR, LINE_STOKE)));
-      }
-
-      for (size_t i = 0; i < my_diagram.size(); i++) {
-        auto &cell = my_diagram[i];
-        auto &p = points[i];
-        for (size_t j = 0; j < cell.size(); j++) {
-          auto &vert = cell[j];
-          size_t nj = (j + 1) % cell.size();
-
-          m_lines.emplace_back(std::move(
-              m_engine->createLine(vert, cell[nj], VORONOI_COLOR, LINE_STOKE)));
-        }
-        m_polys.emplace_back(
-            std::move(m_engine->createPoly(cell, p.color, p.color, 0)));
+    } else {
+      for (Triangulation::Index v : m_voronoiChanges.faces) {
+        paint(v);
       }
+    }
 
-      refresh = false;
+    auto view = [](const HalfEdgeMesh &mesh, const Line &color) {
+      Engine::Objects::MeshView view;
+      view.vertices = mesh.vertices.data();
+      view.vertexCount = mesh.vertices.size();
+      view.halfEdges = reinterpret_cast<const uint32_t *>(mesh.edges.data());
+      view.halfEdgeCount = mesh.edges.size();
+      view.faces = mesh.faces.data();
+      view.faceCount = mesh.faces.size();
+      view.edgeColor = color;
+      return view;
+    };
+
+    Engine::Objects::MeshView voronoi = view(m_voronoi, VORONOI_COLOR);
+    voronoi.stroke = LINE_STOKE;
+    // Filled by the background in raster mode
+    if (!m_raster)
+      voronoi.faceColors = m_faceColors.data();
+    Engine::Objects::MeshView delaunay = view(m_delaunay, DELAUNAY_COLOR);
+    delaunay.stroke = LINE_STOKE;
+
+    auto patch = [](MeshChanges &changes) {
+      Engine::Objects::MeshPatch patch;
+      patch.vertices = Runs(changes.vertices);
+      patch.halfEdges = Runs(changes.edges);
+      patch.faces = Runs(changes.faces);
+      return patch;
+    };
+
+    if (!m_voronoiMesh) {
+      m_voronoiMesh = m_engine->createMesh(voronoi);
+      m_delaunayMesh = m_engine->createMesh(delaunay);
+    } else if (m_uploadAll) {
+      m_engine->updateMesh(m_voronoiMesh, voronoi);
+      m_engine->updateMesh(m_delaunayMesh, delaunay);
+    } else {
+      m_engine->patchMesh(m_voronoiMesh, voronoi, patch(m_voronoiChanges));
+      m_engine->patchMesh(m_delaunayMesh, delaunay, patch(m_delaunayChanges));
     }
+
+    m_uploadAll = false;
+    m_voronoiChanges = {};
+    m_delaunayChanges = {};
   }
 
-private:
   void mouseButtonCallback(int button, int action, int mods) override {
     if (action == GLFW_PRESS) {
       double x, y;
@@ -428,30 +441,62 @@ private:
         if (uid != 0 && m_engine->getType(uid) == 0) {
           return;
         }
-        points.push_back({{glx, gly}, DELAUNAY_COLOR});
-        refresh = true;
+        addSite({glx, gly});
       } else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-        if (uid == 0) {
+        if (uid != 0 && m_engine->getType(uid) == 0) {
+          auto it = m_pointSites.find(uid);
+          if (it != m_pointSites.end())
+            removeSite(it->second);
           return;
         }
 
-        if (m_engine->getType(uid) == 0) {
-          std::erase_if(points, [=, this](Point &point) {
-            Vec2 p = point.pos;
-            float mag =
-                (p[0] - glx) * (p[0] - glx) + (p[1] - gly) * (p[1] - gly);
-            return mag <= POINT_RADIUS;
-          });
-          refresh = true;
-        }
+        // Anywhere else, the site whose cell holds the click
+        if (!m_locator)
+          m_locator.emplace(m_triangulation);
+        Triangulation::Index v = m_locator->nearest(Vec2{glx, gly});
+        if (v != Triangulation::NONE)
+          removeSite(v);
       }
     }
   }
 
-  void keyCallback(int key, int scancode, int action, int mode) override {}
+  void keyCallback(int key, int scancode, int action, int mode) override {
+    // L starts or stops relaxing the sites towards their centroids
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+      m_relaxing = !m_relaxing;
+
+    // C recolors every cell from scratch with the next seed
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+      m_colors = ColorSites(m_triangulation, m_palette.size(), ++m_colorSeed);
+      m_stale = true;
+      for (Triangulation::Index v = 0; v < m_sites.size(); v++) {
+        if (m_triangulation.contains(v))
+          m_dirty.push_back(v);
+      }
+    }
+
+    // J switches the cell fills between polygons and a raster
+    if (key == GLFW_KEY_J && action == GLFW_PRESS) {
+      m_raster = !m_raster;
+      m_rasterDirty = m_raster;
+      if (!m_raster)
+        m_engine->clearBackground();
+      m_stale = true;
+
+      for (Triangulation::Index v = 0; v < m_sites.size(); v++) {
+        if (m_triangulation.contains(v))
+          m_dirty.push_back(v);
+      }
+    }
+  }
 };
 
-int main() {
+int main(int argc, char **argv) {
+  if (argc > 1 && std::string(argv[1]) == "--bench")
+    return RunBenchmark(argc > 2 ? argv[2] : "bench.csv");
+  if (argc > 1 && std::string(argv[1]) == "--lloyd")
+    return RunLloydBenchmark(argc > 2 ? argv[2] : "lloyd.csv");
+
   MyWindow win;
   while (win.isActivate()) {
     win.gameloop();